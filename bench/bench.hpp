@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Minimal benchmark harness: benchmarks register themselves with GEOSON_BENCHMARK, the runner calibrates
+// an iteration count per benchmark (which doubles as warm-up), then times several repetitions of it and
+// reports per-iteration statistics on stdout and, optionally, as JSON. In regression mode (--check) the
+// results are compared against a stored baseline of throughput and peak RSS.
+
+#ifndef GEOSON_VERSION
+#define GEOSON_VERSION "unknown"
+#endif
+
+namespace geoson::bench {
+
+    /// handed to every benchmark: run the body `iterations` times, optionally declaring work per iteration
+    struct State {
+        uint64_t iterations = 1;
+        uint64_t items = 0; // items processed per iteration (features, points, ...)
+        uint64_t bytes = 0; // bytes processed per iteration
+    };
+
+    using Function = std::function<void(State &)>;
+
+    struct Benchmark {
+        std::string name;
+        Function fn;
+    };
+
+    inline std::vector<Benchmark> &registry() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct Registrar {
+        Registrar(std::string name, Function fn) { registry().push_back({std::move(name), std::move(fn)}); }
+    };
+
+    /// keep the optimizer from discarding a result that is otherwise unused
+    template <typename T> inline void doNotOptimize(T const &value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+    struct Result {
+        std::string name;
+        uint64_t iterations = 0;
+        std::vector<double> samples; // ns per iteration, one per repetition
+        double min = 0, median = 0, mean = 0, stddev = 0;
+        double itemsPerSecond = 0, bytesPerSecond = 0;
+        uint64_t peakRss = 0; // bytes the process high-water mark rose above its RSS when the benchmark started
+    };
+
+    struct Options {
+        std::string filter;           // substring a benchmark name must contain
+        size_t repetitions = 10;      // timed repetitions per benchmark
+        double minTime = 0.1;         // seconds each repetition should last at least
+        std::string json;             // path of the JSON report; empty for none
+        bool list = false;
+        std::string check;            // baseline to compare against; non-zero exit on regression
+        std::string writeBaseline;    // record the results as a new baseline
+        std::optional<double> tolerance; // overrides the baseline's tolerances
+    };
+
+    namespace op {
+        /// a "VmRSS"/"VmHWM" field of /proc/self/status in bytes; 0 where unavailable
+        inline uint64_t procStatus(std::string const &field) {
+            std::ifstream status("/proc/self/status");
+            std::string line;
+            while (std::getline(status, line))
+                if (line.rfind(field + ":", 0) == 0)
+                    return std::stoull(line.substr(field.size() + 1)) * 1024;
+            return 0;
+        }
+
+        /// resident-set high-water mark in bytes
+        inline uint64_t peakRss() {
+            if (auto hwm = procStatus("VmHWM"))
+                return hwm;
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+        }
+
+        /// restart the high-water mark from the current RSS (Linux only; elsewhere peaks stay cumulative).
+        /// Freed heap is handed back first, or memory left over by the previous benchmark would hide this one's.
+        inline void resetPeakRss() {
+#if defined(__GLIBC__)
+            malloc_trim(0);
+#endif
+            std::ofstream("/proc/self/clear_refs") << "5";
+        }
+
+        /// the first "model name" of /proc/cpuinfo; empty where unavailable
+        inline std::string cpuModel() {
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line))
+                if (line.rfind("model name", 0) == 0) {
+                    auto start = line.find_first_not_of(" \t", line.find(':') + 1);
+                    return start == std::string::npos ? std::string{} : line.substr(start);
+                }
+            return {};
+        }
+
+        /// what a baseline was recorded on: numbers from another machine are not comparable
+        inline nlohmann::json machine() {
+            char host[256] = {};
+            gethostname(host, sizeof(host) - 1);
+            utsname uts{};
+            uname(&uts);
+            return {{"host", host},
+                    {"cpu", cpuModel()},
+                    {"kernel", std::string(uts.sysname) + " " + uts.release},
+                    {"arch", uts.machine}};
+        }
+
+        inline double run(Function const &fn, State &state) {
+            auto t0 = std::chrono::steady_clock::now();
+            fn(state);
+            auto t1 = std::chrono::steady_clock::now();
+            return std::chrono::duration<double>(t1 - t0).count();
+        }
+
+        inline Result measure(Benchmark const &b, Options const &opts) {
+            // calibration: grow the iteration count until one repetition lasts minTime (warms caches too)
+            resetPeakRss();
+            uint64_t startRss = procStatus("VmRSS");
+            State state;
+            double elapsed = run(b.fn, state);
+            while (elapsed < opts.minTime && state.iterations < (uint64_t(1) << 40)) {
+                double grow = elapsed > 0 ? std::clamp(1.2 * opts.minTime / elapsed, 1.5, 10.0) : 10.0;
+                state.iterations = static_cast<uint64_t>(std::ceil(state.iterations * grow));
+                elapsed = run(b.fn, state);
+            }
+            // One untimed run at the final count: when the first call did one-off setup (generating an
+            // input file) it alone exceeds minTime, and the repetitions would otherwise start cold, right
+            // behind the setup's writeback.
+            run(b.fn, state);
+
+            Result r;
+            r.name = b.name;
+            r.iterations = state.iterations;
+            for (size_t i = 0; i < std::max<size_t>(opts.repetitions, 1); ++i)
+                r.samples.push_back(run(b.fn, state) * 1e9 / static_cast<double>(state.iterations));
+
+            auto sorted = r.samples;
+            std::sort(sorted.begin(), sorted.end());
+            size_t n = sorted.size();
+            r.min = sorted.front();
+            r.median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+            for (double s : sorted)
+                r.mean += s / static_cast<double>(n);
+            for (double s : sorted)
+                r.stddev += (s - r.mean) * (s - r.mean) / static_cast<double>(n > 1 ? n - 1 : 1);
+            r.stddev = std::sqrt(r.stddev);
+            if (state.items)
+                r.itemsPerSecond = static_cast<double>(state.items) * 1e9 / r.median;
+            if (state.bytes)
+                r.bytesPerSecond = static_cast<double>(state.bytes) * 1e9 / r.median;
+            uint64_t peak = peakRss();
+            r.peakRss = peak > startRss ? peak - startRss : 0;
+            return r;
+        }
+
+        inline std::string human(double ns) {
+            std::ostringstream os;
+            os << std::fixed << std::setprecision(1);
+            if (ns < 1e3)
+                os << ns << " ns";
+            else if (ns < 1e6)
+                os << ns / 1e3 << " us";
+            else if (ns < 1e9)
+                os << ns / 1e6 << " ms";
+            else
+                os << ns / 1e9 << " s";
+            return os.str();
+        }
+    } // namespace op
+
+    inline nlohmann::json toJson(std::vector<Result> const &results) {
+        nlohmann::json j;
+        j["context"] = {{"library", "geoson"},
+                        {"version", GEOSON_VERSION},
+                        {"compiler", __VERSION__},
+                        {"threads", std::thread::hardware_concurrency()},
+                        {"machine", op::machine()},
+                        {"unit", "ns"}};
+        j["benchmarks"] = nlohmann::json::array();
+        for (auto const &r : results) {
+            nlohmann::json b = {{"name", r.name},     {"iterations", r.iterations}, {"repetitions", r.samples.size()},
+                                {"min", r.min},       {"median", r.median},         {"mean", r.mean},
+                                {"stddev", r.stddev}, {"samples", r.samples}, {"peak_rss", r.peakRss}};
+            if (r.itemsPerSecond > 0)
+                b["items_per_second"] = r.itemsPerSecond;
+            if (r.bytesPerSecond > 0)
+                b["bytes_per_second"] = r.bytesPerSecond;
+            j["benchmarks"].push_back(std::move(b));
+        }
+        return j;
+    }
+
+    /// the throughput a regression check compares: items/s when declared, iterations/s otherwise
+    inline double throughput(Result const &r) { return r.itemsPerSecond > 0 ? r.itemsPerSecond : 1e9 / r.median; }
+
+    /// baseline file contents for the given results, keeping the tolerances of `previous` if it has any
+    inline nlohmann::json toBaseline(std::vector<Result> const &results, nlohmann::json const &previous = {}) {
+        nlohmann::json j;
+        j["context"] = toJson(std::vector<Result>{})["context"];
+        j["tolerance"] = previous.is_object() && previous.contains("tolerance")
+                             ? previous["tolerance"]
+                             : nlohmann::json{{"throughput", 0.25}, {"peak_rss", 0.25}};
+        j["benchmarks"] = nlohmann::json::object();
+        for (auto const &r : results)
+            j["benchmarks"][r.name] = {{"throughput", throughput(r)}, {"peak_rss", r.peakRss}};
+        return j;
+    }
+
+    /// Compare results against a baseline: throughput may drop and peak RSS may grow by at most the
+    /// baseline's relative tolerances (peak RSS additionally by a fixed 4 MiB, so near-zero footprints do
+    /// not fail on allocator noise). Writes a table to `os`; returns false on any regression.
+    inline bool checkBaseline(std::vector<Result> const &results, nlohmann::json const &baseline, std::ostream &os,
+                              std::optional<double> tolerance = std::nullopt) {
+        double tolThroughput = tolerance.value_or(baseline.at("tolerance").value("throughput", 0.25));
+        double tolRss = tolerance.value_or(baseline.at("tolerance").value("peak_rss", 0.25));
+        auto const &expected = baseline.at("benchmarks");
+
+        bool ok = true;
+        os << "\nperformance regression check (throughput -" << 100 * tolThroughput << "%, peak RSS +"
+           << 100 * tolRss << "%)\n";
+        auto recordedOn = baseline.contains("context") ? baseline["context"].value("machine", nlohmann::json{})
+                                                       : nlohmann::json{};
+        if (recordedOn.is_null())
+            os << "baseline does not say which machine recorded it\n";
+        else if (recordedOn != op::machine())
+            os << "baseline recorded on " << recordedOn.dump() << ", running on " << op::machine().dump()
+               << ": expect differences beyond the tolerance\n";
+        if (expected.empty())
+            os << "baseline is empty: record it with bench/refresh_baseline.sh on the reference machine\n";
+        os << std::left << std::setw(36) << "benchmark" << std::setw(12) << "metric" << std::right << std::setw(14)
+           << "baseline" << std::setw(14) << "measured" << std::setw(10) << "change" << "  status\n";
+        auto row = [&](std::string const &name, std::string const &metric, double base, double now, bool pass) {
+            os << std::left << std::setw(36) << name << std::setw(12) << metric << std::right << std::fixed
+               << std::setprecision(0) << std::setw(14) << base << std::setw(14) << now << std::setprecision(1)
+               << std::setw(9) << (base > 0 ? 100.0 * (now - base) / base : 0.0) << "%  " << (pass ? "ok" : "FAIL")
+               << "\n";
+            ok = ok && pass;
+        };
+        for (auto const &r : results) {
+            if (!expected.contains(r.name)) {
+                os << std::left << std::setw(36) << r.name << "no baseline, skipped\n";
+                continue;
+            }
+            auto const &b = expected[r.name];
+            double baseT = b.at("throughput").get<double>(), nowT = throughput(r);
+            row(r.name, "items/s", baseT, nowT, nowT >= baseT * (1.0 - tolThroughput));
+            if (b.contains("peak_rss")) {
+                double baseM = b["peak_rss"].get<double>(), nowM = static_cast<double>(r.peakRss);
+                row(r.name, "peak_rss", baseM, nowM, nowM <= baseM * (1.0 + tolRss) + 4.0 * (1 << 20));
+            }
+        }
+        for (auto const &[name, b] : expected.items()) {
+            bool ran = std::any_of(results.begin(), results.end(), [&](Result const &r) { return r.name == name; });
+            if (!ran) {
+                os << std::left << std::setw(36) << name << "in baseline but not run  FAIL\n";
+                ok = false;
+            }
+        }
+        os << (ok ? "no regressions\n" : "performance regressions detected\n");
+        return ok;
+    }
+
+    inline nlohmann::json readJsonFile(std::string const &path) {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("Cannot open for read: " + path);
+        return nlohmann::json::parse(in);
+    }
+
+    /// run every registered benchmark matching opts.filter (in --check mode: every benchmark of the
+    /// baseline), in registration order
+    inline std::vector<Result> runAll(Options const &opts) {
+        nlohmann::json baseline;
+        if (!opts.check.empty())
+            baseline = readJsonFile(opts.check);
+
+        std::vector<Result> results;
+        for (auto const &b : registry()) {
+            if (!opts.filter.empty() && b.name.find(opts.filter) == std::string::npos)
+                continue;
+            if (!opts.check.empty() && opts.filter.empty() && !baseline.at("benchmarks").contains(b.name))
+                continue;
+            if (opts.list) {
+                std::cout << b.name << "\n";
+                continue;
+            }
+            auto r = op::measure(b, opts);
+            std::cout << std::left << std::setw(44) << r.name << std::right << std::setw(12) << op::human(r.median)
+                      << "  ±" << std::fixed << std::setprecision(1) << std::setw(5)
+                      << (r.mean > 0 ? 100.0 * r.stddev / r.mean : 0.0) << "%  x" << r.iterations;
+            if (r.itemsPerSecond > 0)
+                std::cout << "  " << std::setprecision(0) << r.itemsPerSecond << " items/s";
+            if (r.bytesPerSecond > 0)
+                std::cout << "  " << std::setprecision(1) << r.bytesPerSecond / (1 << 20) << " MiB/s";
+            std::cout << "  " << std::setprecision(1) << static_cast<double>(r.peakRss) / (1 << 20) << " MiB peak";
+            std::cout << std::endl;
+            results.push_back(std::move(r));
+        }
+        if (!opts.json.empty()) {
+            std::ofstream out(opts.json);
+            if (!out)
+                throw std::runtime_error("Cannot open for write: " + opts.json);
+            out << toJson(results).dump(2) << "\n";
+        }
+        if (!opts.writeBaseline.empty()) {
+            nlohmann::json previous;
+            if (std::filesystem::exists(opts.writeBaseline))
+                previous = readJsonFile(opts.writeBaseline);
+            std::ofstream out(opts.writeBaseline);
+            if (!out)
+                throw std::runtime_error("Cannot open for write: " + opts.writeBaseline);
+            out << toBaseline(results, previous).dump(2) << "\n";
+        }
+        return results;
+    }
+
+    inline Options parseArgs(int argc, char **argv) {
+        Options opts;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](std::string const &flag) -> std::optional<std::string> {
+                if (arg.rfind(flag + "=", 0) == 0)
+                    return arg.substr(flag.size() + 1);
+                return std::nullopt;
+            };
+            if (auto v = value("--filter"))
+                opts.filter = *v;
+            else if (auto v = value("--repetitions"))
+                opts.repetitions = std::stoul(*v);
+            else if (auto v = value("--min-time"))
+                opts.minTime = std::stod(*v);
+            else if (auto v = value("--json"))
+                opts.json = *v;
+            else if (auto v = value("--check"))
+                opts.check = *v;
+            else if (auto v = value("--write-baseline"))
+                opts.writeBaseline = *v;
+            else if (auto v = value("--tolerance"))
+                opts.tolerance = std::stod(*v);
+            else if (arg == "--list")
+                opts.list = true;
+            else
+                throw std::runtime_error("unknown argument: " + arg +
+                                         " (expected --filter=, --repetitions=, --min-time=, --json=, --list, "
+                                         "--check=, --write-baseline=, --tolerance=)");
+        }
+        return opts;
+    }
+
+} // namespace geoson::bench
+
+#define GEOSON_BENCH_CONCAT_(a, b) a##b
+#define GEOSON_BENCH_CONCAT(a, b) GEOSON_BENCH_CONCAT_(a, b)
+
+/// GEOSON_BENCHMARK("group/name") { for (uint64_t i = 0; i < state.iterations; ++i) ...; }
+#define GEOSON_BENCHMARK(name)                                                                                     \
+    static void GEOSON_BENCH_CONCAT(geoson_bench_fn_, __LINE__)(geoson::bench::State & state);                    \
+    static geoson::bench::Registrar GEOSON_BENCH_CONCAT(geoson_bench_reg_, __LINE__)(                             \
+        name, GEOSON_BENCH_CONCAT(geoson_bench_fn_, __LINE__));                                                    \
+    static void GEOSON_BENCH_CONCAT(geoson_bench_fn_, __LINE__)([[maybe_unused]] geoson::bench::State & state)
@@ -0,0 +1,39 @@
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+// Micro benchmarks: single-coordinate parsing and single-geometry serialization.
+
+namespace {
+    using namespace geoson::bench;
+
+    const concord::Datum kDatum{51.98, 5.66, 12.0};
+
+    void parsePoint(State &state, geoson::CRS crs, geoson::ConversionMode mode = geoson::ConversionMode::Exact) {
+        auto coords = crs == geoson::CRS::ENU ? nlohmann::json::array({12.5, -3.25, 0.5})
+                                               : nlohmann::json::array({5.6612, 51.9807, 12.5});
+        geoson::ReadOptions opts;
+        opts.conversion = mode;
+        for (uint64_t i = 0; i < state.iterations; ++i)
+            doNotOptimize(geoson::parsePoint(coords, kDatum, crs, opts));
+        state.items = 1;
+    }
+
+    void geometryToJson(State &state, geoson::CRS crs, geoson::ConversionMode mode = geoson::ConversionMode::Exact) {
+        auto polygon = syntheticPolygon(64); // 65-vertex ring
+        for (uint64_t i = 0; i < state.iterations; ++i)
+            doNotOptimize(geoson::geometryToJson(polygon, kDatum, crs, nullptr, mode));
+        state.items = 65;
+    }
+} // namespace
+
+GEOSON_BENCHMARK("parsePoint/enu") { parsePoint(state, geoson::CRS::ENU); }
+GEOSON_BENCHMARK("parsePoint/wgs") { parsePoint(state, geoson::CRS::WGS); }
+GEOSON_BENCHMARK("parsePoint/wgs/local-tangent") {
+    parsePoint(state, geoson::CRS::WGS, geoson::ConversionMode::LocalTangent);
+}
+
+GEOSON_BENCHMARK("geometryToJson/polygon/enu") { geometryToJson(state, geoson::CRS::ENU); }
+GEOSON_BENCHMARK("geometryToJson/polygon/wgs") { geometryToJson(state, geoson::CRS::WGS); }
+GEOSON_BENCHMARK("geometryToJson/polygon/wgs/local-tangent") {
+    geometryToJson(state, geoson::CRS::WGS, geoson::ConversionMode::LocalTangent);
+}
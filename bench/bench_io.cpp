@@ -0,0 +1,51 @@
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+// Macro benchmarks: whole-file reads and writes of a 10k-feature collection.
+
+namespace {
+    using namespace geoson::bench;
+
+    constexpr size_t kFeatures = 10000;
+
+    geoson::FeatureCollection const &collection() {
+        static auto fc = syntheticCollection(kFeatures);
+        return fc;
+    }
+
+    /// the collection written once in the given CRS, kept for the whole run
+    TempFile const &fixture(geoson::CRS crs) {
+        static TempFile enu("geoson_bench_enu.geojson"), wgs("geoson_bench_wgs.geojson");
+        auto const &f = crs == geoson::CRS::ENU ? enu : wgs;
+        if (!std::filesystem::exists(f.path))
+            geoson::write(collection(), f.path, crs);
+        return f;
+    }
+
+    void read(State &state, geoson::CRS crs) {
+        auto const &f = fixture(crs);
+        for (uint64_t i = 0; i < state.iterations; ++i)
+            doNotOptimize(geoson::ReadFeatureCollection(f.path));
+        state.items = kFeatures;
+        state.bytes = std::filesystem::file_size(f.path);
+    }
+
+    void write(State &state, geoson::CRS crs, bool pretty) {
+        TempFile out("geoson_bench_out.geojson");
+        geoson::WriteOptions opts;
+        opts.outputCrs = crs;
+        opts.pretty = pretty;
+        for (uint64_t i = 0; i < state.iterations; ++i)
+            geoson::WriteFeatureCollection(collection(), out.path, opts);
+        state.items = kFeatures;
+        state.bytes = std::filesystem::file_size(out.path);
+    }
+} // namespace
+
+GEOSON_BENCHMARK("read/enu") { read(state, geoson::CRS::ENU); }
+GEOSON_BENCHMARK("read/wgs") { read(state, geoson::CRS::WGS); }
+
+GEOSON_BENCHMARK("write/enu/pretty") { write(state, geoson::CRS::ENU, true); }
+GEOSON_BENCHMARK("write/enu/compact") { write(state, geoson::CRS::ENU, false); }
+GEOSON_BENCHMARK("write/wgs/pretty") { write(state, geoson::CRS::WGS, true); }
+GEOSON_BENCHMARK("write/wgs/compact") { write(state, geoson::CRS::WGS, false); }
@@ -0,0 +1,73 @@
+#include "bench.hpp"
+#include "fixtures.hpp"
+#include "geoson/stream.hpp"
+#include "geoson/transcode.hpp"
+
+// Regression set: end-to-end reader and writer paths on generated datasets of realistic shape. These are
+// the benchmarks recorded in bench/baseline.json and checked by the perf_regression ctest.
+
+namespace {
+    using namespace geoson::bench;
+
+    geoson::GeneratorOptions dataset(geoson::CRS crs) {
+        geoson::GeneratorOptions opts;
+        opts.seed = 2024;
+        opts.features = 20000;
+        opts.mix = {1.0, 0.5, 2.0, 2.0};
+        opts.minVertices = 8;
+        opts.maxVertices = 64;
+        opts.properties = 4;
+        opts.crs = crs;
+        return opts;
+    }
+
+    /// Both inputs are written on the first call, whichever benchmark makes it, so the ENU and WGS reads
+    /// are timed under the same conditions and do not depend on which of them runs first.
+    TempFile const &file(geoson::CRS crs) {
+        static TempFile enu("geoson_perf_enu.geojson"), wgs("geoson_perf_wgs.geojson");
+        for (auto [f, c] : {std::pair{&enu, geoson::CRS::ENU}, std::pair{&wgs, geoson::CRS::WGS}})
+            if (!std::filesystem::exists(f->path))
+                geoson::generate(f->path, dataset(c));
+        return crs == geoson::CRS::ENU ? enu : wgs;
+    }
+
+    void read(State &state, geoson::CRS crs) {
+        auto const &f = file(crs);
+        for (uint64_t i = 0; i < state.iterations; ++i)
+            doNotOptimize(geoson::read(f.path));
+        state.items = dataset(crs).features;
+        state.bytes = std::filesystem::file_size(f.path);
+    }
+} // namespace
+
+GEOSON_BENCHMARK("perf/read/enu") { read(state, geoson::CRS::ENU); }
+GEOSON_BENCHMARK("perf/read/wgs") { read(state, geoson::CRS::WGS); }
+
+GEOSON_BENCHMARK("perf/write/wgs/compact") {
+    static auto fc = geoson::generate(dataset(geoson::CRS::WGS));
+    TempFile out("geoson_perf_out.geojson");
+    geoson::WriteOptions opts;
+    opts.outputCrs = geoson::CRS::WGS;
+    opts.pretty = false;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+        geoson::write(fc, out.path, opts);
+    state.items = fc.features.size();
+    state.bytes = std::filesystem::file_size(out.path);
+}
+
+GEOSON_BENCHMARK("perf/stream/wgs") {
+    auto const &f = file(geoson::CRS::WGS);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+        geoson::forEachFeature(f.path, [](std::vector<geoson::Feature> &batch) { doNotOptimize(batch); });
+    state.items = dataset(geoson::CRS::WGS).features;
+    state.bytes = std::filesystem::file_size(f.path);
+}
+
+GEOSON_BENCHMARK("perf/transcode/wgs-enu") {
+    auto const &f = file(geoson::CRS::WGS);
+    TempFile out("geoson_perf_transcoded.geojson");
+    for (uint64_t i = 0; i < state.iterations; ++i)
+        geoson::transcode(f.path, out.path, geoson::CRS::ENU);
+    state.items = dataset(geoson::CRS::WGS).features;
+    state.bytes = std::filesystem::file_size(f.path);
+}
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+// Vector queries on a 10k-element collection.
+
+namespace {
+    using namespace geoson::bench;
+
+    constexpr size_t kElements = 10000;
+
+    geoson::Vector const &vector() {
+        static auto v = syntheticVector(kElements);
+        return v;
+    }
+
+    template <typename Fn> void query(State &state, Fn &&fn) {
+        auto const &v = vector();
+        for (uint64_t i = 0; i < state.iterations; ++i)
+            doNotOptimize(fn(v));
+        state.items = kElements;
+    }
+} // namespace
+
+GEOSON_BENCHMARK("vector/getPoints") {
+    query(state, [](auto const &v) { return v.getPoints(); });
+}
+GEOSON_BENCHMARK("vector/getLines") {
+    query(state, [](auto const &v) { return v.getLines(); });
+}
+GEOSON_BENCHMARK("vector/getPaths") {
+    query(state, [](auto const &v) { return v.getPaths(); });
+}
+GEOSON_BENCHMARK("vector/getPolygons") {
+    query(state, [](auto const &v) { return v.getPolygons(); });
+}
+GEOSON_BENCHMARK("vector/getElementsByType") {
+    query(state, [](auto const &v) { return v.getElementsByType("Polygon"); });
+}
+GEOSON_BENCHMARK("vector/filterByProperty") {
+    query(state, [](auto const &v) { return v.filterByProperty("id", "4242"); });
+}
+GEOSON_BENCHMARK("vector/getElement") {
+    auto const &v = vector();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+        doNotOptimize(v.getElement(i % kElements).type);
+    state.items = 1;
+}
+GEOSON_BENCHMARK("vector/getGlobalProperty") {
+    auto const &v = vector();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+        doNotOptimize(v.getGlobalProperty("source"));
+    state.items = 1;
+}
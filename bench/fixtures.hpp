@@ -0,0 +1,53 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "geoson/generate.hpp"
+#include "geoson/geometry.hpp"
+#include "geoson/geoson.hpp"
+#include "geoson/vector.hpp"
+
+// Deterministic datasets shared by the benchmarks, built with the synthetic generator.
+
+namespace geoson::bench {
+
+    /// an even mix of points, lines, paths and polygons with a few properties each
+    inline FeatureCollection syntheticCollection(size_t features, size_t verticesPerGeometry = 32) {
+        GeneratorOptions opts;
+        opts.features = features;
+        opts.minVertices = opts.maxVertices = verticesPerGeometry;
+        opts.properties = 2;
+        return generate(opts);
+    }
+
+    /// a single polygon ring of `vertices` vertices (plus the closing one)
+    inline Geometry syntheticPolygon(size_t vertices) {
+        GeneratorOptions opts;
+        opts.mix = {0.0, 0.0, 0.0, 1.0};
+        opts.minVertices = opts.maxVertices = vertices;
+        return generateFeature(opts, 0).geometry;
+    }
+
+    /// `n` elements spread over the four Vector geometry kinds, typed by geometry
+    inline Vector syntheticVector(size_t n) {
+        Vector v(concord::Polygon{{{0, 0, 0}, {1000, 0, 0}, {1000, 1000, 0}, {0, 1000, 0}, {0, 0, 0}}},
+                 concord::Datum{51.98, 5.66, 12.0});
+        auto fc = syntheticCollection(n, 8);
+        for (auto const &f : fc.features)
+            v.addElement(f.geometry, geometryTypeName(f.geometry), f.properties);
+        v.setGlobalProperty("source", "geoson-bench");
+        return v;
+    }
+
+    /// scratch file in the system temp directory, removed on destruction
+    struct TempFile {
+        std::filesystem::path path;
+        explicit TempFile(std::string const &name) : path(std::filesystem::temp_directory_path() / name) {}
+        ~TempFile() {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    };
+
+} // namespace geoson::bench
@@ -0,0 +1,19 @@
+#include "bench.hpp"
+
+// geoson_bench [--filter=substr] [--repetitions=N] [--min-time=seconds] [--json=report.json] [--list]
+//              [--check=baseline.json [--tolerance=0.3]] [--write-baseline=baseline.json]
+
+int main(int argc, char **argv) {
+    try {
+        auto opts = geoson::bench::parseArgs(argc, argv);
+        auto results = geoson::bench::runAll(opts);
+        if (!opts.check.empty() && !opts.list &&
+            !geoson::bench::checkBaseline(results, geoson::bench::readJsonFile(opts.check), std::cout,
+                                          opts.tolerance))
+            return 1;
+    } catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+# Re-record bench/baseline.json on the reference machine.
+#
+#   bench/refresh_baseline.sh [build-dir]
+#
+# Run it on an idle machine, from a Release build, and commit the result together with the change that
+# moved the numbers. The tolerances already in the baseline file are kept.
+set -euo pipefail
+
+TOP_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="${1:-${TOP_DIR}/build-bench}"
+
+cmake -S "${TOP_DIR}" -B "${BUILD_DIR}" -Wno-dev -DCMAKE_BUILD_TYPE=Release -DGEOSON_BUILD_BENCHMARKS=ON
+cmake --build "${BUILD_DIR}" --target geoson_bench -j"$(nproc)"
+
+"${BUILD_DIR}/geoson_bench" --filter=perf/ --repetitions=10 \
+    --json="${BUILD_DIR}/baseline-run.json" \
+    --write-baseline="${TOP_DIR}/bench/baseline.json"
+
+echo "baseline written to ${TOP_DIR}/bench/baseline.json (full report: ${BUILD_DIR}/baseline-run.json)"
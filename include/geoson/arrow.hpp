@@ -0,0 +1,612 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "geoson/geometry.hpp"
+#include "geoson/json.hpp"
+#include "geoson/types.hpp"
+#include "geoson/writter.hpp"
+
+// Columnar export of a FeatureCollection into GeoArrow memory layouts, plus a dependency-free
+// writer for the Arrow IPC file format (https://arrow.apache.org/docs/format/Columnar.html).
+
+namespace geoson {
+
+    static_assert(std::endian::native == std::endian::little, "geoson::arrow assumes a little-endian host");
+
+    /// how coordinates are laid out in the geometry column
+    enum class CoordinateLayout {
+        Interleaved, // FixedSizeList<double>[3] named "xyz"
+        Separated    // Struct<x: double, y: double, z: double>
+    };
+
+    struct ArrowOptions {
+        CoordinateLayout layout = CoordinateLayout::Interleaved;
+        CRS outputCrs = CRS::ENU;
+        ConversionMode conversion = ConversionMode::Exact;
+    };
+
+    namespace arrow {
+
+        enum class Type { Float64, Utf8, Binary, List, FixedSizeList, Struct };
+
+        using Metadata = std::vector<std::pair<std::string, std::string>>;
+
+        /// one Arrow array together with the Field describing it; children are nested arrays
+        struct Array {
+            std::string name;
+            Type type = Type::Float64;
+            bool nullable = false;
+            int32_t list_size = 0; // FixedSizeList only
+            int64_t length = 0;
+            int64_t null_count = 0;
+            std::vector<uint8_t> validity; // LSB bitmap, left empty when null_count == 0
+            std::vector<int32_t> offsets;  // List, Utf8, Binary
+            std::vector<uint8_t> data;     // Utf8, Binary
+            std::vector<double> values;    // Float64
+            std::vector<Array> children;
+            Metadata metadata; // Field custom_metadata (GeoArrow extension name lives here)
+        };
+
+        struct Table {
+            int64_t num_rows = 0;
+            std::vector<Array> columns;
+            Metadata metadata; // Schema custom_metadata
+        };
+
+        namespace op {
+            inline void checkOffset(size_t n, std::string const &what) {
+                if (n > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+                    throw std::runtime_error("geoson::toGeoArrow(): " + what + " exceeds 32-bit Arrow offsets");
+            }
+
+            inline Array float64(std::string name, std::vector<double> values) {
+                Array a;
+                a.name = std::move(name);
+                a.type = Type::Float64;
+                a.length = static_cast<int64_t>(values.size());
+                a.values = std::move(values);
+                return a;
+            }
+
+            inline Array coordinates(std::string name, const std::vector<std::array<double, 3>> &coords,
+                                     CoordinateLayout layout) {
+                Array a;
+                a.name = std::move(name);
+                a.length = static_cast<int64_t>(coords.size());
+                if (layout == CoordinateLayout::Interleaved) {
+                    a.type = Type::FixedSizeList;
+                    a.list_size = 3;
+                    std::vector<double> xyz;
+                    xyz.reserve(coords.size() * 3);
+                    for (auto const &c : coords)
+                        xyz.insert(xyz.end(), c.begin(), c.end());
+                    a.children.push_back(float64("xyz", std::move(xyz)));
+                } else {
+                    a.type = Type::Struct;
+                    const char *names[3] = {"x", "y", "z"};
+                    for (size_t d = 0; d < 3; ++d) {
+                        std::vector<double> v;
+                        v.reserve(coords.size());
+                        for (auto const &c : coords)
+                            v.push_back(c[d]);
+                        a.children.push_back(float64(names[d], std::move(v)));
+                    }
+                }
+                return a;
+            }
+
+            inline Array list(std::string name, std::vector<int32_t> offsets, Array child) {
+                Array a;
+                a.name = std::move(name);
+                a.type = Type::List;
+                a.length = static_cast<int64_t>(offsets.size()) - 1;
+                a.offsets = std::move(offsets);
+                a.children.push_back(std::move(child));
+                return a;
+            }
+
+            template <typename T> void appendLE(std::vector<uint8_t> &out, T v) {
+                uint8_t b[sizeof(T)];
+                std::memcpy(b, &v, sizeof(T));
+                out.insert(out.end(), b, b + sizeof(T));
+            }
+
+            /// ISO WKB (little endian, Z) for one geometry
+            inline void appendWKB(std::vector<uint8_t> &out, Geometry const &g,
+                                  const std::vector<std::array<double, 3>> &coords) {
+                out.push_back(1);
+                auto putCoords = [&] {
+                    for (auto const &c : coords)
+                        for (double v : c)
+                            appendLE(out, v);
+                };
+                if (std::holds_alternative<concord::Point>(g)) {
+                    appendLE<uint32_t>(out, 1001);
+                    putCoords();
+                } else if (std::holds_alternative<concord::Polygon>(g)) {
+                    appendLE<uint32_t>(out, 1003);
+                    appendLE<uint32_t>(out, 1);
+                    appendLE<uint32_t>(out, static_cast<uint32_t>(coords.size()));
+                    putCoords();
+                } else {
+                    appendLE<uint32_t>(out, 1002);
+                    appendLE<uint32_t>(out, static_cast<uint32_t>(coords.size()));
+                    putCoords();
+                }
+            }
+        } // namespace op
+
+        /// GeoArrow geometry column; homogeneous collections use the native point/linestring/polygon
+        /// layouts, mixed collections fall back to geoarrow.wkb
+        inline Array geometryColumn(FeatureCollection const &fc, ArrowOptions const &opts) {
+            bool allPoints = true, allLines = true, allPolygons = true;
+            for (auto const &f : fc.features) {
+                bool isLine = std::holds_alternative<concord::Line>(f.geometry) ||
+                              std::holds_alternative<concord::Path>(f.geometry);
+                allPoints &= std::holds_alternative<concord::Point>(f.geometry);
+                allLines &= isLine;
+                allPolygons &= std::holds_alternative<concord::Polygon>(f.geometry);
+            }
+
+            nlohmann::json ext = nlohmann::json::object();
+            if (opts.outputCrs == CRS::WGS) {
+                ext["crs"] = "OGC:CRS84";
+                ext["crs_type"] = "authority_code";
+            }
+
+            std::vector<std::array<double, 3>> coords;
+            auto collect = [&](Geometry const &g) {
+                forEachVertex(g, [&](concord::Point const &p) {
+                    coords.push_back(outputCoords(p, fc.datum, opts.outputCrs, opts.conversion));
+                });
+            };
+
+            Array col;
+            std::string extName;
+            if (!fc.features.empty() && allPoints) {
+                for (auto const &f : fc.features)
+                    collect(f.geometry);
+                col = op::coordinates("geometry", coords, opts.layout);
+                extName = "geoarrow.point";
+            } else if (!fc.features.empty() && (allLines || allPolygons)) {
+                std::vector<int32_t> offsets{0};
+                offsets.reserve(fc.features.size() + 1);
+                for (auto const &f : fc.features) {
+                    collect(f.geometry);
+                    op::checkOffset(coords.size(), "coordinate count");
+                    offsets.push_back(static_cast<int32_t>(coords.size()));
+                }
+                auto verts = op::coordinates("vertices", coords, opts.layout);
+                if (allLines) {
+                    col = op::list("geometry", std::move(offsets), std::move(verts));
+                    extName = "geoarrow.linestring";
+                } else {
+                    // geoson polygons carry a single (exterior) ring
+                    std::vector<int32_t> geomOffsets(fc.features.size() + 1);
+                    for (size_t i = 0; i < geomOffsets.size(); ++i)
+                        geomOffsets[i] = static_cast<int32_t>(i);
+                    auto rings = op::list("rings", std::move(offsets), std::move(verts));
+                    col = op::list("geometry", std::move(geomOffsets), std::move(rings));
+                    extName = "geoarrow.polygon";
+                }
+            } else {
+                col.name = "geometry";
+                col.type = Type::Binary;
+                col.length = static_cast<int64_t>(fc.features.size());
+                col.offsets.reserve(fc.features.size() + 1);
+                col.offsets.push_back(0);
+                for (auto const &f : fc.features) {
+                    coords.clear();
+                    collect(f.geometry);
+                    op::appendWKB(col.data, f.geometry, coords);
+                    op::checkOffset(col.data.size(), "WKB buffer");
+                    col.offsets.push_back(static_cast<int32_t>(col.data.size()));
+                }
+                extName = "geoarrow.wkb";
+            }
+            col.metadata = {{"ARROW:extension:name", extName}, {"ARROW:extension:metadata", ext.dump()}};
+            return col;
+        }
+
+        /// nullable Utf8 column for one property key; features lacking the key are null
+        inline Array propertyColumn(FeatureCollection const &fc, std::string const &key) {
+            Array a;
+            a.name = key;
+            a.type = Type::Utf8;
+            a.nullable = true;
+            a.length = static_cast<int64_t>(fc.features.size());
+            a.offsets.reserve(fc.features.size() + 1);
+            a.offsets.push_back(0);
+            a.validity.assign((fc.features.size() + 7) / 8, 0);
+            for (size_t i = 0; i < fc.features.size(); ++i) {
+                auto it = fc.features[i].properties.find(key);
+                if (it == fc.features[i].properties.end()) {
+                    ++a.null_count;
+                } else {
+                    a.validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+                    a.data.insert(a.data.end(), it->second.begin(), it->second.end());
+                    op::checkOffset(a.data.size(), "property column '" + key + "'");
+                }
+                a.offsets.push_back(static_cast<int32_t>(a.data.size()));
+            }
+            if (a.null_count == 0)
+                a.validity.clear();
+            return a;
+        }
+
+    } // namespace arrow
+
+    /// convert a FeatureCollection into columnar GeoArrow buffers: one geometry column followed by one
+    /// Utf8 column per property key (sorted); datum, heading, crs and global properties go into the
+    /// schema metadata under "geoson" exactly as they would appear in the GeoJSON 'properties' object
+    inline arrow::Table toGeoArrow(FeatureCollection const &fc, ArrowOptions const &opts = {}) {
+        arrow::Table t;
+        t.num_rows = static_cast<int64_t>(fc.features.size());
+        t.columns.push_back(arrow::geometryColumn(fc, opts));
+
+        std::set<std::string> keys;
+        for (auto const &f : fc.features)
+            for (auto const &kv : f.properties)
+                keys.insert(kv.first);
+        for (auto const &k : keys)
+            t.columns.push_back(arrow::propertyColumn(fc, k));
+
+        t.metadata = {{"geoson", headerToJson(fc, opts.outputCrs).dump()}};
+        return t;
+    }
+
+    namespace arrow {
+        namespace op {
+
+            /// minimal FlatBuffers serializer: builds a tree of tables/vectors/strings and lays it out
+            /// front to back, parents before children, so every uoffset points forward
+            class FlatBuilder {
+              public:
+                struct Node;
+                using NodePtr = std::shared_ptr<Node>;
+
+                struct Field {
+                    uint16_t id;
+                    size_t size; // 0 marks an offset to a child node
+                    uint64_t bits = 0;
+                    NodePtr child;
+                };
+
+                struct Node {
+                    enum Kind { Table, String, Vector, StructVector } kind = Table;
+                    std::vector<Field> fields;    // Table
+                    std::string str;              // String
+                    std::vector<NodePtr> items;   // Vector of tables/strings
+                    std::vector<uint8_t> structs; // StructVector payload
+                    size_t struct_count = 0;
+                    size_t struct_align = 8;
+                };
+
+                static NodePtr make(Node::Kind kind) {
+                    auto n = std::make_shared<Node>();
+                    n->kind = kind;
+                    return n;
+                }
+                static NodePtr table() { return make(Node::Table); }
+                static NodePtr string(std::string s) {
+                    auto n = make(Node::String);
+                    n->str = std::move(s);
+                    return n;
+                }
+                static NodePtr vector(std::vector<NodePtr> items) {
+                    auto n = make(Node::Vector);
+                    n->items = std::move(items);
+                    return n;
+                }
+                static NodePtr structs(std::vector<uint8_t> bytes, size_t count) {
+                    auto n = make(Node::StructVector);
+                    n->structs = std::move(bytes);
+                    n->struct_count = count;
+                    return n;
+                }
+
+                template <typename T> static void scalar(NodePtr const &t, uint16_t id, T v) {
+                    Field f{id, sizeof(T), 0, nullptr};
+                    std::memcpy(&f.bits, &v, sizeof(T));
+                    t->fields.push_back(f);
+                }
+                static void child(NodePtr const &t, uint16_t id, NodePtr c) {
+                    t->fields.push_back(Field{id, 0, 0, std::move(c)});
+                }
+
+                static std::vector<uint8_t> finish(NodePtr const &root) {
+                    FlatBuilder b;
+                    b.buf_.resize(4);
+                    auto pos = b.emit(*root);
+                    b.put<uint32_t>(0, static_cast<uint32_t>(pos));
+                    b.pad(8);
+                    return std::move(b.buf_);
+                }
+
+              private:
+                std::vector<uint8_t> buf_;
+
+                void pad(size_t a) {
+                    while (buf_.size() % a)
+                        buf_.push_back(0);
+                }
+                template <typename T> void put(size_t at, T v) { std::memcpy(buf_.data() + at, &v, sizeof(T)); }
+                template <typename T> void append(T v) {
+                    buf_.resize(buf_.size() + sizeof(T));
+                    put(buf_.size() - sizeof(T), v);
+                }
+                void link(size_t slot, size_t target) { put<uint32_t>(slot, static_cast<uint32_t>(target - slot)); }
+
+                size_t emit(Node const &n) {
+                    switch (n.kind) {
+                    case Node::String: {
+                        pad(4);
+                        size_t at = buf_.size();
+                        append<uint32_t>(static_cast<uint32_t>(n.str.size()));
+                        buf_.insert(buf_.end(), n.str.begin(), n.str.end());
+                        buf_.push_back(0);
+                        return at;
+                    }
+                    case Node::StructVector: {
+                        while ((buf_.size() + 4) % n.struct_align)
+                            buf_.push_back(0);
+                        size_t at = buf_.size();
+                        append<uint32_t>(static_cast<uint32_t>(n.struct_count));
+                        buf_.insert(buf_.end(), n.structs.begin(), n.structs.end());
+                        return at;
+                    }
+                    case Node::Vector: {
+                        pad(4);
+                        size_t at = buf_.size();
+                        append<uint32_t>(static_cast<uint32_t>(n.items.size()));
+                        size_t slots = buf_.size();
+                        buf_.resize(buf_.size() + 4 * n.items.size());
+                        for (size_t i = 0; i < n.items.size(); ++i)
+                            link(slots + 4 * i, emit(*n.items[i]));
+                        return at;
+                    }
+                    case Node::Table:
+                        break;
+                    }
+
+                    // vtable first, then the table it describes; larger fields first keeps alignment simple
+                    std::vector<Field> fields = n.fields;
+                    std::stable_sort(fields.begin(), fields.end(), [](Field const &a, Field const &b) {
+                        return (a.size ? a.size : 4) > (b.size ? b.size : 4);
+                    });
+                    uint16_t slotsCount = 0;
+                    for (auto const &f : fields)
+                        slotsCount = std::max<uint16_t>(slotsCount, f.id + 1);
+
+                    pad(2);
+                    size_t vt = buf_.size();
+                    buf_.resize(vt + 4 + 2 * slotsCount, 0);
+                    pad(4);
+                    size_t table = buf_.size();
+                    append<int32_t>(static_cast<int32_t>(table - vt));
+
+                    std::vector<std::pair<size_t, NodePtr>> pending;
+                    for (auto const &f : fields) {
+                        size_t sz = f.size ? f.size : 4;
+                        pad(sz);
+                        size_t at = buf_.size();
+                        buf_.resize(at + sz, 0);
+                        if (f.size)
+                            std::memcpy(buf_.data() + at, &f.bits, sz);
+                        else
+                            pending.emplace_back(at, f.child);
+                        put<uint16_t>(vt + 4 + 2 * f.id, static_cast<uint16_t>(at - table));
+                    }
+                    put<uint16_t>(vt, static_cast<uint16_t>(4 + 2 * slotsCount));
+                    put<uint16_t>(vt + 2, static_cast<uint16_t>(buf_.size() - table));
+
+                    for (auto &[slot, c] : pending)
+                        link(slot, emit(*c));
+                    return table;
+                }
+            };
+
+            using FB = FlatBuilder;
+
+            constexpr int16_t kMetadataV5 = 4;
+
+            inline FB::NodePtr keyValues(Metadata const &md) {
+                std::vector<FB::NodePtr> kvs;
+                for (auto const &[k, v] : md) {
+                    auto kv = FB::table();
+                    FB::child(kv, 0, FB::string(k));
+                    FB::child(kv, 1, FB::string(v));
+                    kvs.push_back(kv);
+                }
+                return FB::vector(std::move(kvs));
+            }
+
+            inline FB::NodePtr field(Array const &a) {
+                // Schema.fbs: Type union ids
+                auto type = FB::table();
+                uint8_t typeId = 0;
+                switch (a.type) {
+                case Type::Float64:
+                    typeId = 3; // FloatingPoint { precision: DOUBLE }
+                    FB::scalar<int16_t>(type, 0, 2);
+                    break;
+                case Type::Binary:
+                    typeId = 4;
+                    break;
+                case Type::Utf8:
+                    typeId = 5;
+                    break;
+                case Type::List:
+                    typeId = 12;
+                    break;
+                case Type::Struct:
+                    typeId = 13;
+                    break;
+                case Type::FixedSizeList:
+                    typeId = 16;
+                    FB::scalar<int32_t>(type, 0, a.list_size);
+                    break;
+                }
+
+                auto f = FB::table();
+                FB::child(f, 0, FB::string(a.name));
+                FB::scalar<uint8_t>(f, 1, a.nullable ? 1 : 0);
+                FB::scalar<uint8_t>(f, 2, typeId);
+                FB::child(f, 3, type);
+                std::vector<FB::NodePtr> children;
+                for (auto const &c : a.children)
+                    children.push_back(field(c));
+                FB::child(f, 5, FB::vector(std::move(children)));
+                if (!a.metadata.empty())
+                    FB::child(f, 6, keyValues(a.metadata));
+                return f;
+            }
+
+            inline FB::NodePtr schema(Table const &t) {
+                auto s = FB::table();
+                FB::scalar<int16_t>(s, 0, 0); // Little endian
+                std::vector<FB::NodePtr> fields;
+                for (auto const &c : t.columns)
+                    fields.push_back(field(c));
+                FB::child(s, 1, FB::vector(std::move(fields)));
+                if (!t.metadata.empty())
+                    FB::child(s, 2, keyValues(t.metadata));
+                return s;
+            }
+
+            inline FB::NodePtr message(uint8_t headerType, FB::NodePtr header, int64_t bodyLength) {
+                auto m = FB::table();
+                FB::scalar<int16_t>(m, 0, kMetadataV5);
+                FB::scalar<uint8_t>(m, 1, headerType);
+                FB::child(m, 2, std::move(header));
+                FB::scalar<int64_t>(m, 3, bodyLength);
+                return m;
+            }
+
+            /// record batch body: buffers in pre-order, each padded to 8 bytes
+            struct Body {
+                std::vector<uint8_t> bytes;
+                std::vector<uint8_t> nodes;   // FieldNode structs
+                std::vector<uint8_t> buffers; // Buffer structs
+                size_t node_count = 0, buffer_count = 0;
+
+                void buffer(const void *p, size_t n) {
+                    appendLE<int64_t>(buffers, static_cast<int64_t>(bytes.size()));
+                    appendLE<int64_t>(buffers, static_cast<int64_t>(n));
+                    ++buffer_count;
+                    auto *b = static_cast<const uint8_t *>(p);
+                    bytes.insert(bytes.end(), b, b + n);
+                    while (bytes.size() % 8)
+                        bytes.push_back(0);
+                }
+
+                void add(Array const &a) {
+                    appendLE<int64_t>(nodes, a.length);
+                    appendLE<int64_t>(nodes, a.null_count);
+                    ++node_count;
+                    buffer(a.validity.data(), a.null_count ? a.validity.size() : 0);
+                    switch (a.type) {
+                    case Type::Float64:
+                        buffer(a.values.data(), a.values.size() * sizeof(double));
+                        break;
+                    case Type::Utf8:
+                    case Type::Binary:
+                        buffer(a.offsets.data(), a.offsets.size() * sizeof(int32_t));
+                        buffer(a.data.data(), a.data.size());
+                        break;
+                    case Type::List:
+                        buffer(a.offsets.data(), a.offsets.size() * sizeof(int32_t));
+                        break;
+                    case Type::FixedSizeList:
+                    case Type::Struct:
+                        break;
+                    }
+                    for (auto const &c : a.children)
+                        add(c);
+                }
+            };
+
+            /// encapsulated message: continuation marker, metadata length, flatbuffer, then body
+            inline std::pair<int32_t, int64_t> writeMessage(std::ostream &os, std::vector<uint8_t> const &meta,
+                                                            std::vector<uint8_t> const &body) {
+                int32_t metaLen = static_cast<int32_t>(meta.size()); // already padded to 8
+                uint32_t cont = 0xFFFFFFFFu;
+                os.write(reinterpret_cast<const char *>(&cont), 4);
+                os.write(reinterpret_cast<const char *>(&metaLen), 4);
+                os.write(reinterpret_cast<const char *>(meta.data()), static_cast<std::streamsize>(meta.size()));
+                os.write(reinterpret_cast<const char *>(body.data()), static_cast<std::streamsize>(body.size()));
+                return {metaLen + 8, static_cast<int64_t>(body.size())};
+            }
+
+        } // namespace op
+
+        /// write a Table as an Arrow IPC file (single record batch, metadata version V5)
+        inline void writeIPC(Table const &t, std::ostream &os) {
+            using op::FB;
+            static const char magic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+            os.write(magic, 8);
+
+            op::writeMessage(os, FB::finish(op::message(1, op::schema(t), 0)), {});
+
+            op::Body body;
+            for (auto const &c : t.columns)
+                body.add(c);
+            auto rb = FB::table();
+            FB::scalar<int64_t>(rb, 0, t.num_rows);
+            FB::child(rb, 1, FB::structs(std::move(body.nodes), body.node_count));
+            FB::child(rb, 2, FB::structs(std::move(body.buffers), body.buffer_count));
+            int64_t blockOffset = static_cast<int64_t>(os.tellp());
+            auto [metaLen, bodyLen] = op::writeMessage(
+                os, FB::finish(op::message(3, rb, static_cast<int64_t>(body.bytes.size()))), body.bytes);
+
+            // end-of-stream marker, then the footer that makes it a random-access file
+            const uint32_t eos[2] = {0xFFFFFFFFu, 0};
+            os.write(reinterpret_cast<const char *>(eos), 8);
+
+            std::vector<uint8_t> block;
+            op::appendLE<int64_t>(block, blockOffset);
+            op::appendLE<int32_t>(block, metaLen);
+            op::appendLE<int32_t>(block, 0);
+            op::appendLE<int64_t>(block, bodyLen);
+            auto footer = FB::table();
+            FB::scalar<int16_t>(footer, 0, op::kMetadataV5);
+            FB::child(footer, 1, op::schema(t));
+            FB::child(footer, 3, FB::structs(std::move(block), 1));
+            auto fb = FB::finish(footer);
+            os.write(reinterpret_cast<const char *>(fb.data()), static_cast<std::streamsize>(fb.size()));
+            int32_t footerLen = static_cast<int32_t>(fb.size());
+            os.write(reinterpret_cast<const char *>(&footerLen), 4);
+            os.write(magic, 6);
+        }
+
+        inline void writeIPC(Table const &t, std::filesystem::path const &outPath) {
+            std::ofstream ofs(outPath, std::ios::binary);
+            if (!ofs)
+                throw std::runtime_error("Cannot open for write: " + outPath.string());
+            writeIPC(t, ofs);
+        }
+
+    } // namespace arrow
+
+    /// export a FeatureCollection as a GeoArrow-layout Arrow IPC file (.arrow / .feather)
+    inline void WriteGeoArrow(FeatureCollection const &fc, std::filesystem::path const &outPath,
+                              ArrowOptions const &opts = {}) {
+        arrow::writeIPC(toGeoArrow(fc, opts), outPath);
+    }
+
+} // namespace geoson
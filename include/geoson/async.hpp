@@ -0,0 +1,195 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "geoson/executor.hpp"
+#include "geoson/stream.hpp"
+#include "geoson/trace.hpp"
+
+// Non-blocking reads and writes for event-loop code. readAsync()/writeAsync() start the work on an Executor
+// and return a Task, which a C++20 coroutine can co_await (it resumes on the executor thread that finished
+// the work) and other code can wait on with get(). Both stream the collection feature by feature, so a
+// std::stop_token is honoured between chunks of features (and, for reads, between 64 KiB blocks of the
+// file) and a progress callback sees the work advance.
+
+namespace geoson {
+
+    /// thrown by an async operation whose stop_token was triggered
+    struct OperationCancelled : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    /// progress of an async operation: bytes read of the file, or features written of the collection.
+    /// Called on the executor thread after each chunk and once at the end (done == total)
+    using ProgressFn = std::function<void(uint64_t done, uint64_t total)>;
+
+    /// Result of work running on an executor. Awaitable once (co_await moves the result out) or waited on
+    /// with get(); dropping the task does not stop the work, request a stop through its stop_token instead.
+    template <typename T> class Task {
+      public:
+        bool ready() const {
+            std::lock_guard lock(state_->mutex);
+            return state_->done;
+        }
+
+        /// blocks until the work has finished; returns its result or rethrows its exception
+        T get() {
+            std::unique_lock lock(state_->mutex);
+            state_->finished.wait(lock, [&] { return state_->done; });
+            return take();
+        }
+
+        bool await_ready() const { return ready(); }
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            std::lock_guard lock(state_->mutex);
+            if (state_->done)
+                return false;
+            state_->continuation = awaiting;
+            return true;
+        }
+        T await_resume() {
+            std::lock_guard lock(state_->mutex);
+            return take();
+        }
+
+        /// run fn() on `executor` (null: defaultExecutor()) and complete the task with its outcome
+        template <typename Fn> static Task start(Executor *executor, Fn fn) {
+            Task task;
+            if (!executor)
+                executor = &defaultExecutor();
+            executor->submit([state = task.state_, fn = std::move(fn)]() mutable {
+                std::optional<T> value;
+                std::exception_ptr error;
+                try {
+                    value.emplace(fn());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::coroutine_handle<> continuation;
+                {
+                    std::lock_guard lock(state->mutex);
+                    state->value = std::move(value);
+                    state->error = error;
+                    state->done = true;
+                    continuation = std::exchange(state->continuation, nullptr);
+                }
+                state->finished.notify_all();
+                if (continuation)
+                    continuation.resume();
+            });
+            return task;
+        }
+
+      private:
+        struct State {
+            mutable std::mutex mutex;
+            std::condition_variable finished;
+            bool done = false;
+            std::optional<T> value;
+            std::exception_ptr error;
+            std::coroutine_handle<> continuation;
+        };
+
+        Task() : state_(std::make_shared<State>()) {}
+
+        T take() {
+            if (state_->error)
+                std::rethrow_exception(state_->error);
+            if (!state_->value)
+                throw std::logic_error("geoson::Task: result already taken");
+            T value = std::move(*state_->value);
+            state_->value.reset();
+            return value;
+        }
+
+        std::shared_ptr<State> state_;
+    };
+
+    namespace op {
+        inline void throwIfStopped(std::stop_token const &stop, const char *what) {
+            if (stop.stop_requested())
+                throw OperationCancelled(std::string(what) + ": cancelled");
+        }
+    } // namespace op
+
+    /// Read a FeatureCollection on opts.executor (null: defaultExecutor()). Produces the same collection as
+    /// read(file, opts); features are decoded on the one executor thread, as they are streamed.
+    inline Task<FeatureCollection> readAsync(std::filesystem::path file, ReadOptions opts = {},
+                                             std::stop_token stop = {}, ProgressFn progress = {}) {
+        Executor *executor = opts.executor;
+        return Task<FeatureCollection>::start(executor, [file = std::move(file), opts, stop = std::move(stop),
+                                                         progress = std::move(progress)] {
+            GEOSON_TRACE_SCOPE("readAsync");
+            op::throwIfStopped(stop, "geoson::readAsync()");
+            // also checked while the file is scanned, e.g. for the header after a long features array
+            FeatureReader reader(file, opts, [&] { op::throwIfStopped(stop, "geoson::readAsync()"); });
+            auto const &header = reader.header();
+            FeatureCollection fc{header.datum, header.heading, {}, header.global_properties};
+            std::vector<Feature> batch;
+            for (size_t n = 1; reader.next(batch); ++n) {
+                std::move(batch.begin(), batch.end(), std::back_inserter(fc.features));
+                if (n % op::kFeatureChunk == 0) {
+                    op::throwIfStopped(stop, "geoson::readAsync()");
+                    if (progress)
+                        progress(reader.offset(), reader.size());
+                }
+            }
+            if (progress)
+                progress(reader.size(), reader.size());
+            return fc;
+        });
+    }
+
+    /// Write `fc` on opts.executor (null: defaultExecutor()); `fc` must stay alive and unchanged until the
+    /// task completes. Features are written one per line (opts.pretty does not apply); outputCrs, quantum
+    /// and conversion do. Returns the number of features written. A cancelled or failed write removes the
+    /// partial file.
+    inline Task<uint64_t> writeAsync(FeatureCollection const &fc, std::filesystem::path file, WriteOptions opts = {},
+                                     std::stop_token stop = {}, ProgressFn progress = {}) {
+        Executor *executor = opts.executor;
+        return Task<uint64_t>::start(executor, [&fc, file = std::move(file), opts, stop = std::move(stop),
+                                                progress = std::move(progress)] {
+            GEOSON_TRACE_SCOPE("writeAsync");
+            op::throwIfStopped(stop, "geoson::writeAsync()");
+            CollectionHeader header{opts.outputCrs, fc.datum, fc.heading, fc.global_properties, std::nullopt};
+            if (opts.quantum > 0.0)
+                header.quantization = makeQuantization(fc.datum, opts);
+            std::optional<FeatureWriter> writer(std::in_place, file, header, opts.outputCrs, opts.conversion);
+            try {
+                uint64_t total = fc.features.size();
+                for (size_t i = 0; i < fc.features.size(); ++i) {
+                    writer->write(fc.features[i]);
+                    if ((i + 1) % op::kFeatureChunk == 0) {
+                        op::throwIfStopped(stop, "geoson::writeAsync()");
+                        if (progress)
+                            progress(i + 1, total);
+                    }
+                }
+                writer->close();
+                if (progress)
+                    progress(total, total);
+            } catch (...) {
+                writer.reset();
+                std::error_code ec;
+                std::filesystem::remove(file, ec);
+                throw;
+            }
+            return writer->count();
+        });
+    }
+
+} // namespace geoson
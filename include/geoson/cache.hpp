@@ -0,0 +1,202 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "geoson/geoson.hpp"
+#include "geoson/trace.hpp"
+
+// Sharing parsed collections between independent readers of the same file. The cache is opt-in: nothing in
+// the library consults it, callers that want sharing go through CollectionCache::get() instead of read().
+
+namespace geoson {
+
+    /// Parsed FeatureCollections shared by path. An entry is reused while the file keeps its size and
+    /// modification time and is read with the same options; it is reloaded once either changes. Entries are
+    /// evicted least recently used first once their estimated footprint (memoryUsage()) exceeds the budget.
+    /// Concurrent get()s of a file that is not cached yet wait for one load instead of each parsing it.
+    class CollectionCache {
+      public:
+        using Handle = std::shared_ptr<const FeatureCollection>;
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;    // loads performed
+            uint64_t coalesced = 0; // requests that waited on another thread's load
+            uint64_t evictions = 0;
+        };
+
+        static constexpr size_t kDefaultBudget = size_t(256) << 20;
+
+        explicit CollectionCache(size_t budgetBytes = kDefaultBudget) : budget_(budgetBytes) {}
+
+        CollectionCache(CollectionCache const &) = delete;
+        CollectionCache &operator=(CollectionCache const &) = delete;
+
+        /// the process-wide cache
+        static CollectionCache &global() {
+            static CollectionCache cache;
+            return cache;
+        }
+
+        /// the collection in `file`, parsed with `opts`; the handle stays valid after eviction
+        Handle get(const std::filesystem::path &file, ReadOptions const &opts = {}) {
+            auto path = std::filesystem::canonical(file);
+            Version version{std::filesystem::file_size(path), std::filesystem::last_write_time(path)};
+            std::string key = path.string() + '\n' + optionsKey(opts);
+
+            std::promise<Handle> loaded;
+            {
+                std::unique_lock lock(mutex_);
+                if (auto it = entries_.find(key); it != entries_.end()) {
+                    if (it->second.version == version) {
+                        ++stats_.hits;
+                        lru_.splice(lru_.begin(), lru_, it->second.lru);
+                        return it->second.collection;
+                    }
+                    drop(it); // the file changed underneath
+                }
+                if (auto it = loading_.find(key); it != loading_.end() && it->second.version == version) {
+                    ++stats_.coalesced;
+                    auto pending = it->second.result;
+                    lock.unlock();
+                    return pending.get();
+                }
+                ++stats_.misses;
+                loading_[key] = {version, loaded.get_future().share()};
+            }
+
+            GEOSON_TRACE_SCOPE("CollectionCache/load");
+            Handle collection;
+            try {
+                collection = std::make_shared<const FeatureCollection>(read(path, opts));
+            } catch (...) {
+                std::lock_guard lock(mutex_);
+                finishLoading(key, version);
+                loaded.set_exception(std::current_exception());
+                throw;
+            }
+
+            {
+                std::lock_guard lock(mutex_);
+                finishLoading(key, version);
+                if (auto it = entries_.find(key); it != entries_.end())
+                    drop(it);
+                size_t bytes = collection->memoryUsage().total();
+                lru_.push_front(key);
+                entries_[key] = {version, collection, bytes, lru_.begin()};
+                bytes_ += bytes;
+                evict();
+            }
+            loaded.set_value(collection);
+            return collection;
+        }
+
+        /// forget every entry of `file` (under any options)
+        void erase(const std::filesystem::path &file) {
+            std::error_code ec;
+            auto path = std::filesystem::weakly_canonical(file, ec).string() + '\n';
+            std::lock_guard lock(mutex_);
+            for (auto it = entries_.begin(); it != entries_.end();) {
+                auto next = std::next(it);
+                if (it->first.compare(0, path.size(), path) == 0)
+                    drop(it);
+                it = next;
+            }
+        }
+
+        void clear() {
+            std::lock_guard lock(mutex_);
+            entries_.clear();
+            lru_.clear();
+            bytes_ = 0;
+        }
+
+        /// change the memory budget, evicting down to it
+        void setBudget(size_t budgetBytes) {
+            std::lock_guard lock(mutex_);
+            budget_ = budgetBytes;
+            evict();
+        }
+
+        size_t budget() const {
+            std::lock_guard lock(mutex_);
+            return budget_;
+        }
+        /// estimated footprint of the cached collections
+        size_t bytes() const {
+            std::lock_guard lock(mutex_);
+            return bytes_;
+        }
+        size_t size() const {
+            std::lock_guard lock(mutex_);
+            return entries_.size();
+        }
+        Stats stats() const {
+            std::lock_guard lock(mutex_);
+            return stats_;
+        }
+
+      private:
+        struct Version {
+            uintmax_t size = 0;
+            std::filesystem::file_time_type mtime;
+            bool operator==(Version const &) const = default;
+        };
+
+        struct Entry {
+            Version version;
+            Handle collection;
+            size_t bytes = 0;
+            std::list<std::string>::iterator lru;
+        };
+
+        struct Loading {
+            Version version;
+            std::shared_future<Handle> result;
+        };
+
+        /// the read options that change the parsed result
+        static std::string optionsKey(ReadOptions const &opts) {
+            return std::to_string(std::bit_cast<uint64_t>(opts.simplifyTolerance)) + ',' +
+                   std::to_string(opts.maxVerticesPerGeometry) + ',' +
+                   std::to_string(static_cast<int>(opts.conversion));
+        }
+
+        /// a newer load of the same key (the file changed meanwhile) keeps its slot
+        void finishLoading(std::string const &key, Version const &version) {
+            if (auto it = loading_.find(key); it != loading_.end() && it->second.version == version)
+                loading_.erase(it);
+        }
+
+        void drop(std::unordered_map<std::string, Entry>::iterator it) {
+            bytes_ -= it->second.bytes;
+            lru_.erase(it->second.lru);
+            entries_.erase(it);
+        }
+
+        void evict() {
+            while (bytes_ > budget_ && !lru_.empty()) {
+                drop(entries_.find(lru_.back()));
+                ++stats_.evictions;
+            }
+        }
+
+        mutable std::mutex mutex_;
+        size_t budget_;
+        size_t bytes_ = 0;
+        std::list<std::string> lru_; // most recently used first
+        std::unordered_map<std::string, Entry> entries_;
+        std::unordered_map<std::string, Loading> loading_;
+        Stats stats_;
+    };
+
+} // namespace geoson
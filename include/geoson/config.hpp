@@ -0,0 +1,12 @@
+#pragma once
+
+// Build mode. By default geoson is header-only and every function is defined inline in its header. Code
+// linking the compiled `geoson_static` CMake target gets GEOSON_COMPILED_LIBRARY defined instead: the
+// parser, writer, Vector and trace-export implementations (include/geoson/impl/*.ipp) are then compiled
+// once into the library (src/geoson.cpp), and their headers only pull in nlohmann/json_fwd.hpp.
+
+#if defined(GEOSON_COMPILED_LIBRARY)
+#define GEOSON_API
+#else
+#define GEOSON_API inline
+#endif
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Where the library's parallel work runs. Every parallel path (sharded summaries, the transcode pipeline,
+// chunked reads and writes, Vector queries) submits tasks to an Executor instead of starting threads of
+// its own, so an application can hand all of them one scheduler with a known number of threads. Callers
+// that pass nothing get defaultExecutor(), a process-wide ThreadPool sized to the hardware.
+
+namespace geoson {
+
+    /// something that runs tasks, typically on other threads
+    class Executor {
+      public:
+        virtual ~Executor() = default;
+
+        /// run `task` at some point; tasks must not throw (the library's own tasks catch and forward)
+        virtual void submit(std::function<void()> task) = 0;
+
+        /// number of tasks that can make progress at the same time
+        virtual size_t concurrency() const = 0;
+    };
+
+    /// runs every task immediately on the submitting thread; makes parallel paths sequential
+    class InlineExecutor final : public Executor {
+      public:
+        void submit(std::function<void()> task) override { task(); }
+        size_t concurrency() const override { return 1; }
+    };
+
+    /// Fixed set of worker threads with one deque each. A worker takes its own newest task first (tasks it
+    /// spawned, still warm in cache) and, when empty, steals the oldest task of another worker; tasks
+    /// submitted from outside the pool are dealt round-robin. The destructor runs what is queued, then joins.
+    class ThreadPool final : public Executor {
+      public:
+        /// `threads` workers; 0 uses the hardware concurrency
+        explicit ThreadPool(size_t threads = 0) {
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            for (size_t i = 0; i < threads; ++i)
+                queues_.push_back(std::make_unique<Queue>());
+            workers_.reserve(threads);
+            for (size_t i = 0; i < threads; ++i)
+                workers_.emplace_back([this, i] { run(i); });
+        }
+
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool &operator=(ThreadPool const &) = delete;
+
+        ~ThreadPool() override {
+            {
+                std::lock_guard lock(sleepMutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &w : workers_)
+                w.join();
+        }
+
+        void submit(std::function<void()> task) override {
+            size_t target = current().pool == this ? current().index : next_++ % queues_.size();
+            {
+                // counted before it is visible, so a worker that finds it never sees pending_ drop below zero
+                std::lock_guard lock(sleepMutex_);
+                ++pending_;
+            }
+            {
+                std::lock_guard lock(queues_[target]->mutex);
+                queues_[target]->tasks.push_back(std::move(task));
+            }
+            wake_.notify_one();
+        }
+
+        size_t concurrency() const override { return workers_.size(); }
+
+      private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        struct Worker {
+            ThreadPool const *pool = nullptr;
+            size_t index = 0;
+        };
+
+        static Worker &current() {
+            thread_local Worker self;
+            return self;
+        }
+
+        bool take(size_t self, std::function<void()> &task) {
+            {
+                auto &own = *queues_[self];
+                std::lock_guard lock(own.mutex);
+                if (!own.tasks.empty()) {
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (size_t k = 1; k < queues_.size(); ++k) {
+                auto &victim = *queues_[(self + k) % queues_.size()];
+                std::lock_guard lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run(size_t self) {
+            current() = {this, self};
+            std::function<void()> task;
+            while (true) {
+                if (take(self, task)) {
+                    {
+                        std::lock_guard lock(sleepMutex_);
+                        --pending_;
+                    }
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+                std::unique_lock lock(sleepMutex_);
+                if (stop_ && pending_ == 0)
+                    return;
+                wake_.wait(lock, [&] { return stop_ || pending_ > 0; });
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> workers_;
+        std::atomic<size_t> next_{0};
+
+        std::mutex sleepMutex_;
+        std::condition_variable wake_;
+        size_t pending_ = 0; // submitted, not yet taken
+        bool stop_ = false;
+    };
+
+    /// the process-wide pool used when no executor is given; created on first use
+    inline Executor &defaultExecutor() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    namespace op {
+
+        /// features per task when reads, writes and queries are spread over an executor: large enough to
+        /// amortize scheduling, small enough to balance uneven geometries
+        inline constexpr size_t kFeatureChunk = 256;
+
+        /// Run fn(chunk, begin, end) over [0, n) cut into chunks of `grain` items, on `executor` (null: the
+        /// default one) with the calling thread taking part. Helpers claim chunks from a shared counter,
+        /// so the caller never waits on a task that has not started: nesting inside a pool task, or a pool
+        /// busy elsewhere, degrades to running the chunks inline rather than deadlocking. The first
+        /// exception thrown by fn is rethrown once every claimed chunk has finished.
+        template <typename Fn> void parallelFor(Executor *executor, size_t n, size_t grain, Fn &&fn) {
+            grain = std::max<size_t>(grain, 1);
+            size_t chunks = (n + grain - 1) / grain;
+            if (!executor)
+                executor = &defaultExecutor();
+            size_t helpers = std::min(executor->concurrency(), chunks);
+            if (helpers <= 1) {
+                for (size_t c = 0; c < chunks; ++c)
+                    fn(c, c * grain, std::min(n, (c + 1) * grain));
+                return;
+            }
+
+            struct State {
+                std::atomic<size_t> next{0};
+                std::atomic<bool> failed{false};
+                size_t done = 0;
+                std::exception_ptr error;
+                std::mutex mutex;
+                std::condition_variable finished;
+            };
+            auto state = std::make_shared<State>();
+            // late helpers only touch `state`: fn is not called once every chunk has been claimed
+            auto work = [state, chunks, n, grain, &fn] {
+                for (size_t c; (c = state->next++) < chunks;) {
+                    if (!state->failed) {
+                        try {
+                            fn(c, c * grain, std::min(n, (c + 1) * grain));
+                        } catch (...) {
+                            std::lock_guard lock(state->mutex);
+                            if (!state->error)
+                                state->error = std::current_exception();
+                            state->failed = true;
+                        }
+                    }
+                    std::lock_guard lock(state->mutex);
+                    if (++state->done == chunks)
+                        state->finished.notify_all();
+                }
+            };
+            for (size_t h = 1; h < helpers; ++h)
+                executor->submit(work);
+            work();
+
+            std::unique_lock lock(state->mutex);
+            state->finished.wait(lock, [&] { return state->done == chunks; });
+            if (state->error)
+                std::rethrow_exception(state->error);
+        }
+
+        /// A result computed on an executor. wait() runs the job on the calling thread if no worker has
+        /// picked it up yet, so waiting on one never depends on a free worker.
+        template <typename T> class Job {
+          public:
+            Job(Executor *executor, std::function<T()> fn) : state_(std::make_shared<State>()) {
+                state_->fn = std::move(fn);
+                if (!executor)
+                    executor = &defaultExecutor();
+                executor->submit([s = state_] { run(*s); });
+            }
+
+            /// the job's value; rethrows what it threw
+            T get() {
+                run(*state_);
+                std::unique_lock lock(state_->mutex);
+                state_->finished.wait(lock, [&] { return state_->done; });
+                if (state_->error)
+                    std::rethrow_exception(state_->error);
+                return std::move(state_->value);
+            }
+
+          private:
+            struct State {
+                std::atomic<bool> claimed{false};
+                std::function<T()> fn;
+                T value{};
+                std::exception_ptr error;
+                bool done = false;
+                std::mutex mutex;
+                std::condition_variable finished;
+            };
+
+            static void run(State &s) {
+                if (s.claimed.exchange(true))
+                    return;
+                T value{};
+                std::exception_ptr error;
+                try {
+                    value = s.fn();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard lock(s.mutex);
+                s.value = std::move(value);
+                s.error = error;
+                s.done = true;
+                s.fn = nullptr;
+                s.finished.notify_all();
+            }
+
+            std::shared_ptr<State> state_;
+        };
+
+    } // namespace op
+
+} // namespace geoson
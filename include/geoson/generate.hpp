@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "geoson/stream.hpp"
+
+// Reproducible synthetic FeatureCollections for benchmarks, scaling studies and stress tests.
+
+namespace geoson {
+
+    struct GeneratorOptions {
+        uint64_t seed = 1;
+        size_t features = 1000;
+        /// relative weights of the geometry kinds; need not sum to one
+        struct Mix {
+            double points = 1.0, lines = 1.0, paths = 1.0, polygons = 1.0;
+        } mix;
+        /// vertices per Path / Polygon ring (without the closing vertex), drawn uniformly
+        size_t minVertices = 4;
+        size_t maxVertices = 64;
+        /// string properties per feature (besides "id") and the length of each value
+        size_t properties = 4;
+        size_t propertyBytes = 16;
+        /// features are scattered over a square of this side (metres) centred on the datum
+        double extent = 1000.0;
+        /// CRS of generated files; in-memory collections are always in the internal ENU frame
+        geoson::CRS crs = geoson::CRS::ENU;
+        concord::Datum datum{51.98, 5.66, 12.0};
+    };
+
+    namespace op {
+        /// splitmix64: tiny, fast and, unlike the <random> distributions, identical on every platform
+        class SplitMix {
+          public:
+            explicit SplitMix(uint64_t seed) : state_(seed) {}
+
+            uint64_t next() {
+                uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                return z ^ (z >> 31);
+            }
+            /// uniform in [0, 1)
+            double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+            double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+            /// uniform in [lo, hi]
+            size_t between(size_t lo, size_t hi) { return hi <= lo ? lo : lo + next() % (hi - lo + 1); }
+
+          private:
+            uint64_t state_;
+        };
+    } // namespace op
+
+    /// Feature number `index` of the collection described by `opts`. Every feature has its own random
+    /// stream derived from (seed, index), so any feature can be produced independently of the others.
+    inline Feature generateFeature(GeneratorOptions const &opts, uint64_t index) {
+        op::SplitMix rng(opts.seed ^ (index * 0xd1342543de82ef95ull));
+        rng.next();
+
+        double half = opts.extent / 2.0;
+        concord::Point centre{rng.uniform(-half, half), rng.uniform(-half, half), rng.uniform(0.0, 5.0)};
+
+        auto const &m = opts.mix;
+        double total = m.points + m.lines + m.paths + m.polygons;
+        if (!(total > 0.0))
+            throw std::invalid_argument("geoson::generate(): geometry mix weights must not all be zero");
+        double pick = rng.uniform() * total;
+
+        size_t minV = std::max<size_t>(opts.minVertices, 3);
+        size_t maxV = std::max(minV, opts.maxVertices);
+        size_t n = rng.between(minV, maxV);
+        // geometry size grows with its vertex count, at roughly one metre between vertices
+        double step = 1.0;
+
+        Feature f;
+        if ((pick -= m.points) < 0.0) {
+            f.geometry = centre;
+        } else if ((pick -= m.lines) < 0.0) {
+            double a = rng.uniform(0.0, 2.0 * std::numbers::pi), len = rng.uniform(1.0, 50.0);
+            f.geometry = concord::Line{centre, concord::Point{centre.x + len * std::cos(a),
+                                                              centre.y + len * std::sin(a), centre.z}};
+        } else if ((pick -= m.paths) < 0.0) {
+            // random walk with a persistent heading, like a vehicle trace
+            std::vector<concord::Point> pts{centre};
+            double a = rng.uniform(0.0, 2.0 * std::numbers::pi);
+            for (size_t k = 1; k < n; ++k) {
+                a += rng.uniform(-0.3, 0.3);
+                auto const &p = pts.back();
+                pts.emplace_back(p.x + step * std::cos(a), p.y + step * std::sin(a), p.z + rng.uniform(-0.05, 0.05));
+            }
+            f.geometry = concord::Path{pts};
+        } else {
+            // star-shaped ring around the centre, closed
+            std::vector<concord::Point> pts;
+            double r = step * static_cast<double>(n) / (2.0 * std::numbers::pi);
+            for (size_t k = 0; k < n; ++k) {
+                double a = 2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n);
+                double rk = r * rng.uniform(0.6, 1.0);
+                pts.emplace_back(centre.x + rk * std::cos(a), centre.y + rk * std::sin(a), centre.z);
+            }
+            pts.push_back(pts.front());
+            f.geometry = concord::Polygon{pts};
+        }
+
+        static constexpr char kAlphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        f.properties["id"] = std::to_string(index);
+        for (size_t p = 0; p < opts.properties; ++p) {
+            std::string value(opts.propertyBytes, ' ');
+            for (auto &c : value)
+                c = kAlphabet[rng.next() % (sizeof(kAlphabet) - 1)];
+            f.properties["p" + std::to_string(p)] = std::move(value);
+        }
+        return f;
+    }
+
+    /// header (datum, heading, CRS) of a generated collection
+    inline CollectionHeader generatedHeader(GeneratorOptions const &opts) {
+        CollectionHeader h;
+        h.crs = opts.crs;
+        h.datum = opts.datum;
+        h.heading = concord::Euler{0.0, 0.0, 0.0};
+        h.global_properties["generator"] = "geoson";
+        h.global_properties["seed"] = std::to_string(opts.seed);
+        return h;
+    }
+
+    /// generate the whole collection in memory
+    inline FeatureCollection generate(GeneratorOptions const &opts) {
+        auto h = generatedHeader(opts);
+        FeatureCollection fc{h.datum, h.heading, {}, h.global_properties};
+        fc.features.reserve(opts.features);
+        for (size_t i = 0; i < opts.features; ++i)
+            fc.features.push_back(generateFeature(opts, i));
+        return fc;
+    }
+
+    /// Stream a generated collection to `out` one feature at a time, so memory does not grow with the
+    /// feature count (multi-GB files are fine). `progress(written)` is called every 64k features.
+    /// Returns the number of bytes written.
+    inline uint64_t generate(std::filesystem::path const &out, GeneratorOptions const &opts,
+                             std::function<void(uint64_t)> const &progress = {}) {
+        {
+            FeatureWriter writer(out, generatedHeader(opts), opts.crs);
+            for (size_t i = 0; i < opts.features; ++i) {
+                writer.write(generateFeature(opts, i));
+                if (progress && (i + 1) % 65536 == 0)
+                    progress(i + 1);
+            }
+            writer.close();
+        }
+        if (progress)
+            progress(opts.features);
+        return std::filesystem::file_size(out);
+    }
+
+} // namespace geoson
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <variant>
+#include <vector>
+
+#include "geoson/types.hpp"
+
+namespace geoson {
+
+    /// axis-aligned bounding box; empty until the first expand()
+    struct BoundingBox {
+        std::array<double, 3> min{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                                  std::numeric_limits<double>::infinity()};
+        std::array<double, 3> max{-std::numeric_limits<double>::infinity(),
+                                  -std::numeric_limits<double>::infinity(),
+                                  -std::numeric_limits<double>::infinity()};
+
+        bool empty() const { return min[0] > max[0]; }
+
+        void expand(double x, double y, double z) {
+            min = {std::min(min[0], x), std::min(min[1], y), std::min(min[2], z)};
+            max = {std::max(max[0], x), std::max(max[1], y), std::max(max[2], z)};
+        }
+        void expand(concord::Point const &p) { expand(p.x, p.y, p.z); }
+        void expand(BoundingBox const &o) {
+            if (!o.empty()) {
+                expand(o.min[0], o.min[1], o.min[2]);
+                expand(o.max[0], o.max[1], o.max[2]);
+            }
+        }
+
+        bool intersects(BoundingBox const &o) const {
+            return !empty() && !o.empty() && min[0] <= o.max[0] && o.min[0] <= max[0] && min[1] <= o.max[1] &&
+                   o.min[1] <= max[1];
+        }
+    };
+
+    /// call fn(concord::Point const &) for every vertex of a geometry
+    template <typename Fn> void forEachVertex(Geometry const &geom, Fn &&fn) {
+        std::visit(
+            [&](auto const &shape) {
+                using T = std::decay_t<decltype(shape)>;
+                if constexpr (std::is_same_v<T, concord::Point>) {
+                    fn(shape);
+                } else if constexpr (std::is_same_v<T, concord::Line>) {
+                    fn(shape.getStart());
+                    fn(shape.getEnd());
+                } else {
+                    for (auto const &p : shape.getPoints())
+                        fn(p);
+                }
+            },
+            geom);
+    }
+
+    /// copy of a geometry with every vertex replaced by fn(concord::Point const &) -> concord::Point
+    template <typename Fn> Geometry mapVertices(Geometry const &geom, Fn &&fn) {
+        return std::visit(
+            [&](auto const &shape) -> Geometry {
+                using T = std::decay_t<decltype(shape)>;
+                if constexpr (std::is_same_v<T, concord::Point>) {
+                    return fn(shape);
+                } else if constexpr (std::is_same_v<T, concord::Line>) {
+                    return concord::Line{fn(shape.getStart()), fn(shape.getEnd())};
+                } else {
+                    std::vector<concord::Point> pts;
+                    pts.reserve(shape.getPoints().size());
+                    for (auto const &p : shape.getPoints())
+                        pts.push_back(fn(p));
+                    return T{pts};
+                }
+            },
+            geom);
+    }
+
+    /// all vertices of a geometry, in order
+    inline std::vector<concord::Point> vertices(Geometry const &geom) {
+        std::vector<concord::Point> out;
+        forEachVertex(geom, [&](concord::Point const &p) { out.push_back(p); });
+        return out;
+    }
+
+    inline size_t vertexCount(Geometry const &geom) {
+        return std::visit(
+            [](auto const &shape) -> size_t {
+                using T = std::decay_t<decltype(shape)>;
+                if constexpr (std::is_same_v<T, concord::Point>)
+                    return 1;
+                else if constexpr (std::is_same_v<T, concord::Line>)
+                    return 2;
+                else
+                    return shape.getPoints().size();
+            },
+            geom);
+    }
+
+    /// bounding box of a geometry in the internal ENU frame
+    inline BoundingBox boundingBox(Geometry const &geom) {
+        BoundingBox box;
+        forEachVertex(geom, [&](concord::Point const &p) { box.expand(p); });
+        return box;
+    }
+
+    /// GeoJSON type name a geometry is written as
+    inline const char *geometryTypeName(Geometry const &geom) {
+        if (std::holds_alternative<concord::Point>(geom))
+            return "Point";
+        if (std::holds_alternative<concord::Polygon>(geom))
+            return "Polygon";
+        return "LineString";
+    }
+
+} // namespace geoson
@@ -10,11 +10,21 @@ namespace geoson {
     // Read function alias
     inline FeatureCollection read(const std::filesystem::path &file) { return ReadFeatureCollection(file); }
 
+    // Read with options (e.g. preview loads with parse-time simplification)
+    inline FeatureCollection read(const std::filesystem::path &file, const ReadOptions &opts) {
+        return ReadFeatureCollection(file, opts);
+    }
+
     // Write function aliases - with CRS choice
     inline void write(const FeatureCollection &fc, const std::filesystem::path &outPath, CRS outputCrs) {
         WriteFeatureCollection(fc, outPath, outputCrs);
     }
 
+    // Write function alias - full control (pretty/compact, quantized compact profile)
+    inline void write(const FeatureCollection &fc, const std::filesystem::path &outPath, const WriteOptions &opts) {
+        WriteFeatureCollection(fc, outPath, opts);
+    }
+
     // Write function alias - defaults to ENU output format (matches internal representation)
     // Note: Internal representation is always Point (ENU) coordinates
     inline void write(const FeatureCollection &fc, const std::filesystem::path &outPath) {
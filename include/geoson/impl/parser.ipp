@@ -0,0 +1,412 @@
+#pragma once
+
+// Implementation of geoson/parser.hpp: included by the header in header-only builds, compiled into the
+// library (src/geoson.cpp) otherwise.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <variant>
+
+#include "geoson/json.hpp"
+#include "geoson/parser.hpp"
+#include "geoson/trace.hpp"
+
+namespace geoson {
+
+    namespace op {
+        GEOSON_API nlohmann::json ReadFeatureCollection(const std::filesystem::path &file) {
+            std::ifstream ifs(file);
+            if (!ifs) {
+                throw std::runtime_error("geoson::ReadFeatureCollection(): cannot open \"" + file.string() + '\"');
+            }
+
+            nlohmann::json j;
+            ifs >> j;
+
+            if (!j.is_object() || !j.contains("type") || !j["type"].is_string()) {
+                throw std::runtime_error(
+                    "geoson::ReadFeatureCollection(): top-level object has no string 'type' field");
+            }
+
+            auto type = j["type"].get<std::string>();
+            if (type == "FeatureCollection") {
+                return j;
+            }
+            if (type == "Feature") {
+                return nlohmann::json{{"type", "FeatureCollection"}, {"features", nlohmann::json::array({j})}};
+            }
+
+            // bare geometry → wrap into a one-feature collection
+            nlohmann::json feat = {{"type", "Feature"}, {"geometry", j}, {"properties", nlohmann::json::object()}};
+            return nlohmann::json{{"type", "FeatureCollection"}, {"features", nlohmann::json::array({feat})}};
+        }
+    } // namespace op
+
+    GEOSON_API std::unordered_map<std::string, std::string> parseProperties(const json &props) {
+        std::unordered_map<std::string, std::string> m;
+        m.reserve(props.size());
+        for (auto const &item : props.items()) {
+            if (item.value().is_string())
+                m[item.key()] = item.value().get<std::string>();
+            else
+                m[item.key()] = item.value().dump();
+        }
+        return m;
+    }
+
+    GEOSON_API concord::Point parsePoint(const json &coords, const concord::Datum &datum, geoson::CRS crs,
+                                         ReadOptions const &opts) {
+        double x = coords.at(0).get<double>();
+        double y = coords.at(1).get<double>();
+        double z = coords.size() > 2 ? coords.at(2).get<double>() : 0.0;
+        GEOSON_STATS(if (op::activeParseStats) ++op::activeParseStats->vertices;)
+
+        // Internal representation is always in Point coordinates (ENU/local system)
+        if (crs == geoson::CRS::ENU) {
+            // ENU flavor: coordinates are already local x,y,z
+            return concord::Point{x, y, z};
+        } else {
+            // WGS flavor: coordinates are lon,lat,alt - convert to ENU using datum
+            // Note: toENU takes (lat, lon, alt), so swap x,y
+            GEOSON_STATS(op::PhaseTimer timer(op::parsePhase(&ParseStats::conversionNs));)
+            auto enu = toENU(y, x, z, datum, opts.conversion);
+            return concord::Point{enu[0], enu[1], enu[2]};
+        }
+    }
+
+    namespace op {
+        /// convert a coordinate array vertex by vertex, striding over the input when it exceeds the
+        /// vertex budget and simplifying on the fly, so the full-resolution ring is never built
+        GEOSON_API std::vector<concord::Point> parseVertices(const json &coords, const concord::Datum &datum,
+                                                             geoson::CRS crs, ReadOptions const &opts,
+                                                             size_t minVertices) {
+            size_t n = coords.size();
+            size_t budget = opts.maxVerticesPerGeometry ? std::max(opts.maxVerticesPerGeometry, minVertices) : n;
+
+            std::vector<concord::Point> pts;
+            pts.reserve(std::min(n, budget));
+            StreamingSimplifier simplifier(pts, opts.simplifyTolerance);
+            if (n <= budget) {
+                for (auto const &c : coords)
+                    simplifier.push(parsePoint(c, datum, crs, opts));
+            } else {
+                // evenly spaced samples, always including the first and last vertex
+                for (size_t k = 0; k < budget; ++k)
+                    simplifier.push(parsePoint(coords.at(k * (n - 1) / (budget - 1)), datum, crs, opts));
+            }
+            simplifier.finish();
+            return pts;
+        }
+    } // namespace op
+
+    GEOSON_API Geometry parseLineString(const json &coords, const concord::Datum &datum, geoson::CRS crs,
+                                        ReadOptions const &opts) {
+        auto pts = op::parseVertices(coords, datum, crs, opts, 2);
+        if (pts.size() == 2)
+            return concord::Line{pts[0], pts[1]};
+        else
+            return concord::Path{pts};
+    }
+
+    GEOSON_API concord::Polygon parsePolygon(const json &coords, const concord::Datum &datum, geoson::CRS crs,
+                                             ReadOptions const &opts) {
+        auto const &ring = coords.at(0);
+        auto pts = op::parseVertices(ring, datum, crs, opts, 4);
+        if (pts.size() < 4 && ring.size() >= 4 && opts.simplifyTolerance > 0.0) {
+            // simplified below a triangle: keep the (possibly strided) ring unsimplified
+            auto unsimplified = opts;
+            unsimplified.simplifyTolerance = 0.0;
+            pts = op::parseVertices(ring, datum, crs, unsimplified, 4);
+        }
+        return concord::Polygon{pts};
+    }
+
+    GEOSON_API std::vector<Geometry> parseGeometry(const json &geom, const concord::Datum &datum, geoson::CRS crs,
+                                                   ReadOptions const &opts) {
+        std::vector<Geometry> out;
+        auto type = geom.at("type").get<std::string>();
+
+        if (type == "Point") {
+            out.emplace_back(parsePoint(geom.at("coordinates"), datum, crs, opts));
+        } else if (type == "LineString") {
+            out.emplace_back(parseLineString(geom.at("coordinates"), datum, crs, opts));
+        } else if (type == "Polygon") {
+            out.emplace_back(parsePolygon(geom.at("coordinates"), datum, crs, opts));
+        } else if (type == "MultiPoint") {
+            for (auto const &c : geom.at("coordinates"))
+                out.emplace_back(parsePoint(c, datum, crs, opts));
+        } else if (type == "MultiLineString") {
+            for (auto const &linegeoson : geom.at("coordinates"))
+                out.emplace_back(parseLineString(linegeoson, datum, crs, opts));
+        } else if (type == "MultiPolygon") {
+            for (auto const &poly : geom.at("coordinates"))
+                out.emplace_back(parsePolygon(poly, datum, crs, opts));
+        } else if (type == "GeometryCollection") {
+            for (auto const &sub : geom.at("geometries")) {
+                auto subs = parseGeometry(sub, datum, crs, opts);
+                out.insert(out.end(), subs.begin(), subs.end());
+            }
+        }
+        return out;
+    }
+
+    // ––– parse the CRS string into the enum –––
+
+    GEOSON_API geoson::CRS parseCRS(const std::string &s) {
+        if (s == "EPSG:4326" || s == "WGS84" || s == "WGS")
+            return geoson::CRS::WGS;
+        else if (s == "ENU" || s == "ECEF")
+            return geoson::CRS::ENU;
+        throw std::runtime_error("Unknown CRS string: " + s);
+    }
+
+    // ––– compact profile: quantized, delta-encoded coordinates –––
+
+    GEOSON_API Quantization parseQuantization(const json &t) {
+        Quantization q;
+        auto const &S = t.at("scale");
+        auto const &T = t.at("translate");
+        for (size_t i = 0; i < 3; ++i) {
+            q.scale[i] = i < S.size() ? S.at(i).get<double>() : S.at(0).get<double>();
+            q.translate[i] = i < T.size() ? T.at(i).get<double>() : 0.0;
+        }
+        return q;
+    }
+
+    GEOSON_API bool hasQuantization(const json &P) {
+        auto it = P.find("transform");
+        return it != P.end() && it->is_object() && it->contains("scale") && it->contains("translate");
+    }
+
+    namespace op {
+        GEOSON_API json dequantizePosition(const json &c, Quantization const &q, std::array<int64_t, 3> const &base) {
+            json out = json::array();
+            for (size_t i = 0; i < c.size() && i < 3; ++i)
+                out.push_back(static_cast<double>(base[i] + c.at(i).get<int64_t>()) * q.scale[i] + q.translate[i]);
+            return out;
+        }
+
+        GEOSON_API json dequantizeRing(const json &ring, Quantization const &q) {
+            json out = json::array();
+            std::array<int64_t, 3> acc{0, 0, 0};
+            for (auto const &c : ring) {
+                out.push_back(dequantizePosition(c, q, acc));
+                for (size_t i = 0; i < c.size() && i < 3; ++i)
+                    acc[i] += c.at(i).get<int64_t>();
+            }
+            return out;
+        }
+    } // namespace op
+
+    GEOSON_API json dequantizeGeometry(const json &geom, Quantization const &q) {
+        json out = geom;
+        auto type = geom.at("type").get<std::string>();
+        const std::array<int64_t, 3> origin{0, 0, 0};
+
+        if (type == "Point") {
+            out["coordinates"] = op::dequantizePosition(geom.at("coordinates"), q, origin);
+        } else if (type == "MultiPoint") {
+            out["coordinates"] = json::array();
+            for (auto const &c : geom.at("coordinates"))
+                out["coordinates"].push_back(op::dequantizePosition(c, q, origin));
+        } else if (type == "LineString") {
+            out["coordinates"] = op::dequantizeRing(geom.at("coordinates"), q);
+        } else if (type == "Polygon" || type == "MultiLineString") {
+            out["coordinates"] = json::array();
+            for (auto const &ring : geom.at("coordinates"))
+                out["coordinates"].push_back(op::dequantizeRing(ring, q));
+        } else if (type == "MultiPolygon") {
+            out["coordinates"] = json::array();
+            for (auto const &poly : geom.at("coordinates")) {
+                json rings = json::array();
+                for (auto const &ring : poly)
+                    rings.push_back(op::dequantizeRing(ring, q));
+                out["coordinates"].push_back(std::move(rings));
+            }
+        } else if (type == "GeometryCollection") {
+            out["geometries"] = json::array();
+            for (auto const &sub : geom.at("geometries"))
+                out["geometries"].push_back(dequantizeGeometry(sub, q));
+        }
+        return out;
+    }
+
+    // ––– collection header –––
+
+    GEOSON_API CollectionHeader parseHeader(const json &P) {
+        if (!P.is_object())
+            throw std::runtime_error("missing top-level 'properties'");
+
+        if (!P.contains("crs") || !P["crs"].is_string())
+            throw std::runtime_error("'properties' missing string 'crs'");
+        if (!P.contains("datum") || !P["datum"].is_array() || P["datum"].size() < 3)
+            throw std::runtime_error("'properties' missing array 'datum' of ≥3 numbers");
+        if (!P.contains("heading") || !P["heading"].is_number())
+            throw std::runtime_error("'properties' missing numeric 'heading'");
+
+        // extract the new types
+        CollectionHeader h;
+        h.crs = parseCRS(P["crs"].get<std::string>());
+        auto &A = P["datum"];
+        h.datum = concord::Datum{A[0].get<double>(), A[1].get<double>(), A[2].get<double>()};
+        double yaw = P["heading"].get<double>();
+        h.heading = concord::Euler{0.0, 0.0, yaw};
+
+        if (hasQuantization(P))
+            h.quantization = parseQuantization(P["transform"]);
+
+        // Parse global properties (excluding built-in ones)
+        for (const auto &[key, value] : P.items()) {
+            if (key != "crs" && key != "datum" && key != "heading" && !(h.quantization && key == "transform")) {
+                if (value.is_string()) {
+                    h.global_properties[key] = value.get<std::string>();
+                } else {
+                    h.global_properties[key] = value.dump();
+                }
+            }
+        }
+        return h;
+    }
+
+    GEOSON_API void parseFeature(const json &feat, CollectionHeader const &h, std::vector<Feature> &out,
+                                 ReadOptions const &opts) {
+        if (feat.value("geometry", json{}).is_null())
+            return;
+        std::vector<Geometry> geoms;
+        {
+            GEOSON_STATS(op::PhaseTimer timer(op::parsePhase(&ParseStats::geometryNs),
+                                              op::parsePhase(&ParseStats::geometryAlloc));)
+            geoms = h.quantization ? parseGeometry(dequantizeGeometry(feat["geometry"], *h.quantization), h.datum,
+                                                   h.crs, opts)
+                                   : parseGeometry(feat["geometry"], h.datum, h.crs, opts);
+        }
+        std::unordered_map<std::string, std::string> props_map;
+        {
+            GEOSON_STATS(op::PhaseTimer timer(op::parsePhase(&ParseStats::propertiesNs),
+                                              op::parsePhase(&ParseStats::propertiesAlloc));)
+            props_map = parseProperties(feat.value("properties", json::object()));
+        }
+        GEOSON_STATS(op::PhaseTimer timer(op::parsePhase(&ParseStats::buildNs),
+                                          op::parsePhase(&ParseStats::buildAlloc));)
+        GEOSON_STATS(if (op::activeParseStats) {
+            op::activeParseStats->features += geoms.size();
+            op::activeParseStats->properties += props_map.size() * geoms.size();
+        })
+        for (auto &g : geoms)
+            out.emplace_back(Feature{std::move(g), props_map});
+    }
+
+    namespace op {
+        GEOSON_API void parseFeatures(std::span<const json> features, CollectionHeader const &h,
+                                      std::vector<Feature> &out, ReadOptions const &opts) {
+            if (!opts.executor || features.size() <= kFeatureChunk) {
+                for (auto const &feat : features)
+                    parseFeature(feat, h, out, opts);
+                return;
+            }
+            // each chunk decodes into its own vector (and stats); concatenated in order afterwards
+            std::vector<std::vector<Feature>> parts((features.size() + kFeatureChunk - 1) / kFeatureChunk);
+            GEOSON_STATS(std::vector<ParseStats> partStats(opts.stats ? parts.size() : 0);)
+            parallelFor(opts.executor, features.size(), kFeatureChunk, [&](size_t c, size_t b, size_t e) {
+                GEOSON_TRACE_SCOPE("read/chunk");
+                GEOSON_STATS(
+                    StatsScope<ParseStats> chunkScope(activeParseStats, opts.stats ? &partStats[c] : nullptr);)
+                for (size_t i = b; i < e; ++i)
+                    parseFeature(features[i], h, parts[c], opts);
+            });
+            for (auto &part : parts)
+                std::move(part.begin(), part.end(), std::back_inserter(out));
+            GEOSON_STATS(for (auto const &ps : partStats) *opts.stats += ps;)
+        }
+    } // namespace op
+
+    // ––– main loader –––
+
+    GEOSON_API FeatureCollection ReadFeatureCollection(const std::filesystem::path &file, ReadOptions const &opts) {
+        GEOSON_TRACE_SCOPE("read");
+        GEOSON_STATS(op::StatsScope<ParseStats> scope(op::activeParseStats, opts.stats);
+                     uint64_t conversionBefore = opts.stats ? opts.stats->conversionNs : 0;)
+
+        // decimating reads exist to keep large files small in memory: never hold the whole document
+        if (opts.simplifyTolerance > 0.0 || opts.maxVerticesPerGeometry > 0) {
+            FeatureCollection fc;
+            {
+                GEOSON_TRACE_SCOPE("read/features");
+                fc = op::readStreamed(file, opts);
+            }
+            GEOSON_STATS(if (opts.stats) {
+                opts.stats->bytes += std::filesystem::file_size(file);
+                opts.stats->geometryNs -= opts.stats->conversionNs - conversionBefore;
+            })
+            return fc;
+        }
+
+        json fc_json;
+        {
+            GEOSON_TRACE_SCOPE("read/tokenize");
+            GEOSON_STATS(op::PhaseTimer timer(op::parsePhase(&ParseStats::tokenizeNs),
+                                              op::parsePhase(&ParseStats::tokenizeAlloc));)
+            fc_json = op::ReadFeatureCollection(file);
+        }
+
+        GEOSON_STATS(std::optional<op::PhaseTimer> build(std::in_place, op::parsePhase(&ParseStats::buildNs),
+                                                         op::parsePhase(&ParseStats::buildAlloc));)
+        if (!fc_json.contains("properties") || !fc_json["properties"].is_object())
+            throw std::runtime_error("missing top-level 'properties'");
+        auto header = parseHeader(fc_json["properties"]);
+
+        FeatureCollection fc;
+        fc.datum = header.datum;
+        fc.heading = header.heading;
+        fc.global_properties = std::move(header.global_properties);
+        fc.features.reserve(fc_json["features"].size());
+        GEOSON_STATS(build.reset();)
+
+        {
+            GEOSON_TRACE_SCOPE("read/features");
+            json const &features = fc_json["features"];
+            if (features.is_array()) {
+                op::parseFeatures(features.get_ref<json::array_t const &>(), header, fc.features, opts);
+            } else {
+                for (auto const &feat : features)
+                    parseFeature(feat, header, fc.features, opts);
+            }
+        }
+
+        GEOSON_STATS(if (opts.stats) {
+            opts.stats->bytes += std::filesystem::file_size(file);
+            // conversion ran inside the geometry phase: report the two exclusively
+            opts.stats->geometryNs -= opts.stats->conversionNs - conversionBefore;
+        })
+        return fc;
+    }
+
+    // ––– pretty-print FeatureCollection header –––
+
+    GEOSON_API std::ostream &operator<<(std::ostream &os, FeatureCollection const &fc) {
+        os << "DATUM: " << fc.datum.lat << ", " << fc.datum.lon << ", " << fc.datum.alt << "\n"
+           << "HEADING: " << fc.heading.yaw << "\n";
+        os << "FEATURES: " << fc.features.size() << "\n";
+
+        for (auto const &f : fc.features) {
+            auto &v = f.geometry;
+            if (std::get_if<concord::Polygon>(&v)) {
+                os << "  POLYGON\n";
+            } else if (std::get_if<concord::Line>(&v)) {
+                os << "  LINE\n";
+            } else if (std::get_if<concord::Path>(&v)) {
+                os << "  PATH\n";
+            } else if (std::get_if<concord::Point>(&v)) {
+                os << "   POINT\n";
+            }
+            if (f.properties.size() > 0)
+                os << "    PROPS:" << f.properties.size() << "\n";
+        }
+
+        return os;
+    }
+
+} // namespace geoson
@@ -0,0 +1,41 @@
+#pragma once
+
+// Implementation of the trace export in geoson/trace.hpp: included by the header in header-only builds,
+// compiled into the library (src/geoson.cpp) otherwise.
+
+#include <fstream>
+#include <stdexcept>
+
+#include "geoson/json.hpp"
+#include "geoson/trace.hpp"
+
+namespace geoson::trace {
+
+    GEOSON_API nlohmann::json toJson() {
+        auto &r = op::registry();
+        std::lock_guard lock(r.mutex);
+        nlohmann::json events = nlohmann::json::array();
+        for (auto const &[tid, name] : r.threadNames)
+            events.push_back(
+                {{"ph", "M"}, {"name", "thread_name"}, {"pid", 1}, {"tid", tid}, {"args", {{"name", name}}}});
+        for (auto const &b : r.buffers)
+            b->forEach([&](const char *name, const char *category, uint64_t start, uint64_t duration, uint32_t tid) {
+                events.push_back({{"ph", "X"},
+                                  {"name", name},
+                                  {"cat", category},
+                                  {"ts", static_cast<double>(start) / 1e3},
+                                  {"dur", static_cast<double>(duration) / 1e3},
+                                  {"pid", 1},
+                                  {"tid", tid}});
+            });
+        return {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ns"}};
+    }
+
+    GEOSON_API void write(const std::filesystem::path &path) {
+        std::ofstream out(path);
+        if (!out)
+            throw std::runtime_error("Cannot open for write: " + path.string());
+        out << toJson().dump() << "\n";
+    }
+
+} // namespace geoson::trace
@@ -0,0 +1,385 @@
+#pragma once
+
+// Implementation of the Vector members declared out of line in geoson/vector.hpp: included by the header
+// in header-only builds, compiled into the library (src/geoson.cpp) otherwise.
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "geoson/trace.hpp"
+#include "geoson/vector.hpp"
+
+namespace geoson {
+
+    GEOSON_API Vector &Vector::operator=(Vector const &other) {
+        if (this != &other)
+            *this = Vector(other);
+        return *this;
+    }
+
+    GEOSON_API Vector &Vector::operator=(Vector &&other) {
+        if (this == &other)
+            return *this;
+        if (observed())
+            for (size_t i = 0; i < elements_.size(); ++i)
+                noteRemoved(i);
+        uint64_t first = std::max(nextId_, other.nextId_);
+        bool editing = recording();
+
+        field_boundary_ = std::move(other.field_boundary_);
+        field_properties_ = std::move(other.field_properties_);
+        elements_ = std::move(other.elements_);
+        datum_ = other.datum_;
+        heading_ = other.heading_;
+        crs_ = other.crs_;
+        global_properties_ = std::move(other.global_properties_);
+        history_ = other.history_; // drops ours, keeping the limit
+        if (editing)
+            --changes_.depth; // the batch beginEdit() opened
+
+        // renumber past both vectors' ids, so an id the observers were given is never handed out again
+        ids_.clear();
+        other.ids_.clear();
+        nextId_ = first;
+        assignIds();
+        if (observed())
+            for (uint64_t id : ids_)
+                changes_.at(id).added = true;
+        notify();
+        return *this;
+    }
+
+    GEOSON_API Vector Vector::fromFile(const std::filesystem::path &path) {
+        GEOSON_TRACE_SCOPE("Vector::fromFile", "vector");
+        auto fc = geoson::read(path);
+
+        if (fc.features.empty()) {
+            throw std::runtime_error("Vector::fromFile: No features found in file");
+        }
+
+        std::optional<std::pair<concord::Polygon, std::unordered_map<std::string, std::string>>> field_data;
+
+        // First, look for a feature explicitly marked as "field"
+        for (const auto &feature : fc.features) {
+            if (std::holds_alternative<concord::Polygon>(feature.geometry)) {
+                auto it = feature.properties.find("type");
+                if (it != feature.properties.end() && it->second == "field") {
+                    field_data = std::make_pair(std::get<concord::Polygon>(feature.geometry), feature.properties);
+                    break;
+                }
+            }
+        }
+
+        // If no explicit field found, use the first polygon
+        if (!field_data) {
+            for (const auto &feature : fc.features) {
+                if (std::holds_alternative<concord::Polygon>(feature.geometry)) {
+                    field_data = std::make_pair(std::get<concord::Polygon>(feature.geometry), feature.properties);
+                    break;
+                }
+            }
+        }
+
+        if (!field_data) {
+            throw std::runtime_error("Vector::fromFile: No polygon found to use as field boundary");
+        }
+
+        Vector vector(field_data->first, fc.datum, fc.heading);
+        vector.field_properties_ = field_data->second;
+        vector.global_properties_ = fc.global_properties;
+
+        // Add all other features as elements (exclude the field boundary)
+        for (const auto &feature : fc.features) {
+            // Skip features that are explicitly marked as "field" type
+            auto type_it = feature.properties.find("type");
+            bool isExplicitField = (type_it != feature.properties.end() && type_it->second == "field");
+
+            if (!isExplicitField) {
+                std::string elem_type = "unknown";
+                if (type_it != feature.properties.end()) {
+                    elem_type = type_it->second;
+                }
+
+                vector.elements_.emplace_back(feature.geometry, feature.properties, elem_type);
+            }
+        }
+        vector.assignIds();
+
+        return vector;
+    }
+
+    GEOSON_API void Vector::toFile(const std::filesystem::path &path, CRS outputCrs) const {
+        GEOSON_TRACE_SCOPE("Vector::toFile", "vector");
+        FeatureCollection fc;
+        fc.datum = datum_;
+        fc.heading = heading_;
+        fc.global_properties = global_properties_;
+
+        auto field_props = field_properties_;
+        field_props["type"] = "field";
+        fc.features.emplace_back(Feature{field_boundary_, field_props});
+
+        for (const auto &element : elements_) {
+            fc.features.emplace_back(Feature{element.geometry, element.properties});
+        }
+
+        geoson::write(fc, path, outputCrs);
+    }
+
+    GEOSON_API std::vector<Element> Vector::getElementsByType(const std::string &type, Executor *executor) const {
+        GEOSON_TRACE_SCOPE("Vector::getElementsByType", "vector");
+        return filter([&](const Element &element) { return element.type == type; }, executor);
+    }
+
+    GEOSON_API std::vector<Element> Vector::getPoints() const {
+        GEOSON_TRACE_SCOPE("Vector::getPoints", "vector");
+        std::vector<Element> result;
+        for (const auto &element : elements_) {
+            if (std::holds_alternative<concord::Point>(element.geometry)) {
+                result.push_back(element);
+            }
+        }
+        return result;
+    }
+
+    GEOSON_API std::vector<Element> Vector::getLines() const {
+        GEOSON_TRACE_SCOPE("Vector::getLines", "vector");
+        std::vector<Element> result;
+        for (const auto &element : elements_) {
+            if (std::holds_alternative<concord::Line>(element.geometry)) {
+                result.push_back(element);
+            }
+        }
+        return result;
+    }
+
+    GEOSON_API std::vector<Element> Vector::getPaths() const {
+        GEOSON_TRACE_SCOPE("Vector::getPaths", "vector");
+        std::vector<Element> result;
+        for (const auto &element : elements_) {
+            if (std::holds_alternative<concord::Path>(element.geometry)) {
+                result.push_back(element);
+            }
+        }
+        return result;
+    }
+
+    GEOSON_API std::vector<Element> Vector::getPolygons() const {
+        GEOSON_TRACE_SCOPE("Vector::getPolygons", "vector");
+        std::vector<Element> result;
+        for (const auto &element : elements_) {
+            if (std::holds_alternative<concord::Polygon>(element.geometry)) {
+                result.push_back(element);
+            }
+        }
+        return result;
+    }
+
+    GEOSON_API std::vector<Element> Vector::filterByProperty(const std::string &key, const std::string &value,
+                                                             Executor *executor) const {
+        GEOSON_TRACE_SCOPE("Vector::filterByProperty", "vector");
+        return filter(
+            [&](const Element &element) {
+                auto it = element.properties.find(key);
+                return it != element.properties.end() && it->second == value;
+            },
+            executor);
+    }
+
+    GEOSON_API std::vector<Element> Vector::filter(const std::function<bool(const Element &)> &pred,
+                                                   Executor *executor) const {
+        std::vector<Element> result;
+        if (!executor || elements_.size() <= op::kFeatureChunk) {
+            for (const auto &element : elements_) {
+                if (pred(element)) {
+                    result.push_back(element);
+                }
+            }
+            return result;
+        }
+        std::vector<std::vector<Element>> parts((elements_.size() + op::kFeatureChunk - 1) / op::kFeatureChunk);
+        op::parallelFor(executor, elements_.size(), op::kFeatureChunk, [&](size_t c, size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                if (pred(elements_[i])) {
+                    parts[c].push_back(elements_[i]);
+                }
+            }
+        });
+        for (auto &part : parts) {
+            std::move(part.begin(), part.end(), std::back_inserter(result));
+        }
+        return result;
+    }
+
+    GEOSON_API MemoryUsage Vector::memoryUsage() const {
+        MemoryUsage m;
+        m.other += sizeof(Vector) + (elements_.capacity() - elements_.size()) * sizeof(Element) +
+                   ids_.capacity() * sizeof(uint64_t);
+        m.coordinates += field_boundary_.getPoints().capacity() * sizeof(concord::Point);
+        op::addMemoryUsage(m, field_properties_);
+        for (auto const &e : elements_) {
+            m.geometry += sizeof(Geometry);
+            m.other += sizeof(Element) - sizeof(Geometry) + op::heapBytes(e.type);
+            op::addMemoryUsage(m, e.geometry);
+            op::addMemoryUsage(m, e.properties);
+        }
+        op::addMemoryUsage(m, global_properties_);
+        m.other += history_.bytes;
+        return m;
+    }
+
+    GEOSON_API void Vector::beginEdit(std::string label) {
+        if (history_.open)
+            throw std::logic_error("Vector::beginEdit: an edit is already open");
+        history_.open = op::Edit{std::move(label), {}, 0};
+        ++changes_.depth;
+    }
+
+    GEOSON_API void Vector::commit() {
+        if (!history_.open)
+            throw std::logic_error("Vector::commit: no edit is open");
+        op::Edit edit = std::move(*history_.open);
+        history_.open.reset();
+        if (!edit.steps.empty()) {
+            edit.steps.shrink_to_fit();
+            edit.bytes = op::editBytes(edit);
+            for (auto const &e : history_.redo)
+                history_.bytes -= e.bytes;
+            history_.redo.clear();
+            history_.bytes += edit.bytes;
+            history_.undo.push_back(std::move(edit));
+            history_.trim();
+        }
+        if (--changes_.depth == 0) // the batch beginEdit() opened
+            notify();
+    }
+
+    GEOSON_API void Vector::rollback() {
+        if (!history_.open)
+            throw std::logic_error("Vector::rollback: no edit is open");
+        op::Edit edit = std::move(*history_.open);
+        history_.open.reset();
+        try {
+            replay(std::move(edit));
+        } catch (...) {
+            --changes_.depth;
+            throw;
+        }
+        if (--changes_.depth == 0)
+            notify();
+    }
+
+    GEOSON_API bool Vector::undo() {
+        if (history_.open)
+            throw std::logic_error("Vector::undo: an edit is open");
+        if (history_.undo.empty())
+            return false;
+        op::Edit edit = std::move(history_.undo.back());
+        history_.undo.pop_back();
+        history_.bytes -= edit.bytes;
+        op::Edit inverse = replay(std::move(edit));
+        history_.bytes += inverse.bytes;
+        history_.redo.push_back(std::move(inverse));
+        return true;
+    }
+
+    GEOSON_API bool Vector::redo() {
+        if (history_.open)
+            throw std::logic_error("Vector::redo: an edit is open");
+        if (history_.redo.empty())
+            return false;
+        op::Edit edit = std::move(history_.redo.back());
+        history_.redo.pop_back();
+        history_.bytes -= edit.bytes;
+        op::Edit inverse = replay(std::move(edit));
+        history_.bytes += inverse.bytes;
+        history_.undo.push_back(std::move(inverse));
+        history_.trim();
+        return true;
+    }
+
+    GEOSON_API op::Edit Vector::replay(op::Edit edit) {
+        // record the inverse of each inverse step: that is the edit reverting this replay
+        Batch batch(*this);
+        history_.open = op::Edit{std::move(edit.label), {}, 0};
+        try {
+            for (auto it = edit.steps.rbegin(); it != edit.steps.rend(); ++it)
+                undoStep(std::move(*it));
+        } catch (...) {
+            history_.open.reset();
+            history_.clear();
+            throw;
+        }
+        op::Edit inverse = std::move(*history_.open);
+        history_.open.reset();
+        inverse.steps.shrink_to_fit();
+        inverse.bytes = op::editBytes(inverse);
+        return inverse;
+    }
+
+    GEOSON_API void Vector::undoStep(op::UndoStep &&step) {
+        std::visit(
+            [&](auto &s) {
+                using T = std::decay_t<decltype(s)>;
+                if constexpr (std::is_same_v<T, op::UndoAdd>)
+                    removeElement(indexOfRecorded(s.id));
+                else if constexpr (std::is_same_v<T, op::UndoRemove>)
+                    insertElement(s.index, s.id, std::move(s.element));
+                else if constexpr (std::is_same_v<T, op::UndoReplace>)
+                    replaceElement(indexOfRecorded(s.id), std::move(s.element));
+                else if constexpr (std::is_same_v<T, op::UndoGeometry>)
+                    setElementGeometry(indexOfRecorded(s.id), s.geometry);
+                else if constexpr (std::is_same_v<T, op::UndoProperty>) {
+                    if (s.value)
+                        setElementProperty(indexOfRecorded(s.id), s.key, *s.value);
+                    else
+                        removeElementProperty(indexOfRecorded(s.id), s.key);
+                } else if constexpr (std::is_same_v<T, op::UndoFieldProperty>) {
+                    if (s.value)
+                        setFieldProperty(s.key, *s.value);
+                    else
+                        removeFieldProperty(s.key);
+                } else if constexpr (std::is_same_v<T, op::UndoGlobalProperty>) {
+                    if (s.value)
+                        setGlobalProperty(s.key, *s.value);
+                    else
+                        removeGlobalProperty(s.key);
+                } else if constexpr (std::is_same_v<T, op::UndoFieldBoundary>)
+                    setFieldBoundary(s.boundary);
+                else if constexpr (std::is_same_v<T, op::UndoDatum>)
+                    setDatum(s.datum);
+                else if constexpr (std::is_same_v<T, op::UndoHeading>)
+                    setHeading(s.heading);
+                else
+                    setCRS(s.crs);
+            },
+            step);
+    }
+
+    GEOSON_API size_t Vector::indexOfRecorded(uint64_t id) const {
+        auto index = indexOf(id);
+        if (!index)
+            throw std::logic_error("Vector: edit history refers to a missing element");
+        return *index;
+    }
+
+    GEOSON_API void Vector::insertElement(size_t index, uint64_t id, Element element) {
+        if (index > elements_.size())
+            throw std::logic_error("Vector: edit history refers to a missing position");
+        record([&] { return op::UndoAdd{id}; });
+        elements_.insert(elements_.begin() + static_cast<std::ptrdiff_t>(index), std::move(element));
+        ids_.insert(ids_.begin() + static_cast<std::ptrdiff_t>(index), id);
+        if (observed()) {
+            auto &p = changes_.at(id);
+            if (p.removed)
+                p.removed = false; // back as it was when removed; changes before that still stand
+            else
+                p.added = true;
+        }
+        notify();
+    }
+
+} // namespace geoson
@@ -0,0 +1,236 @@
+#pragma once
+
+// Implementation of geoson/writter.hpp: included by the header in header-only builds, compiled into the
+// library (src/geoson.cpp) otherwise.
+
+#include <cmath>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "geoson/json.hpp"
+#include "geoson/trace.hpp"
+#include "geoson/writter.hpp"
+
+namespace geoson {
+
+    GEOSON_API std::array<double, 3> outputCoords(concord::Point const &p, const concord::Datum &datum,
+                                                  geoson::CRS outputCrs, ConversionMode conversion) {
+        // Internal representation is always in Point coordinates (ENU/local system)
+        if (outputCrs == geoson::CRS::ENU) {
+            // ENU output: coordinates are already in local system, output directly as x,y,z
+            return {p.x, p.y, p.z};
+        }
+        // WGS output: convert Point to ENU with datum, then to WGS
+        GEOSON_STATS(op::PhaseTimer timer(op::writePhase(&WriteStats::conversionNs));)
+        auto wgs = toWGS(p.x, p.y, p.z, datum, conversion);
+        return {wgs[1], wgs[0], wgs[2]};
+    }
+
+    GEOSON_API Quantization makeQuantization(const concord::Datum &datum, WriteOptions const &opts) {
+        Quantization q;
+        double z = opts.quantumZ > 0.0 ? opts.quantumZ : opts.quantum;
+        q.scale = {opts.quantum, opts.quantum, z};
+        q.translate = outputCoords(concord::Point{0.0, 0.0, 0.0}, datum, opts.outputCrs, opts.conversion);
+        return q;
+    }
+
+    GEOSON_API nlohmann::json geometryToJson(Geometry const &geom, const concord::Datum &datum,
+                                             geoson::CRS outputCrs, Quantization const *quant,
+                                             ConversionMode conversion) {
+        // Helper to build coordinates based on desired output CRS
+        auto quantize = [&](std::array<double, 3> const &c) {
+            std::array<int64_t, 3> q;
+            for (size_t i = 0; i < 3; ++i)
+                q[i] = std::llround((c[i] - quant->translate[i]) / quant->scale[i]);
+            return q;
+        };
+        auto ptCoords = [&](concord::Point const &p) {
+            auto c = outputCoords(p, datum, outputCrs, conversion);
+            if (quant) {
+                auto q = quantize(c);
+                return nlohmann::json::array({q[0], q[1], q[2]});
+            }
+            return nlohmann::json::array({c[0], c[1], c[2]});
+        };
+        auto ringCoords = [&](auto const &pts) {
+            nlohmann::json arr = nlohmann::json::array();
+            std::array<int64_t, 3> prev{0, 0, 0};
+            for (auto const &p : pts) {
+                if (!quant) {
+                    arr.push_back(ptCoords(p));
+                    continue;
+                }
+                auto q = quantize(outputCoords(p, datum, outputCrs, conversion));
+                arr.push_back(nlohmann::json::array({q[0] - prev[0], q[1] - prev[1], q[2] - prev[2]}));
+                prev = q;
+            }
+            return arr;
+        };
+
+        GEOSON_STATS(op::PhaseTimer timer(op::writePhase(&WriteStats::geometryNs),
+                                          op::writePhase(&WriteStats::geometryAlloc));)
+        return std::visit(
+            [&](auto const &shape) -> nlohmann::json {
+                using T = std::decay_t<decltype(shape)>;
+                GEOSON_STATS(if (op::activeWriteStats) {
+                    if constexpr (std::is_same_v<T, concord::Point>)
+                        op::activeWriteStats->vertices += 1;
+                    else if constexpr (std::is_same_v<T, concord::Line>)
+                        op::activeWriteStats->vertices += 2;
+                    else
+                        op::activeWriteStats->vertices += shape.getPoints().size();
+                })
+                nlohmann::json j;
+                if constexpr (std::is_same_v<T, concord::Point>) {
+                    j["type"] = "Point";
+                    j["coordinates"] = ptCoords(shape);
+                } else if constexpr (std::is_same_v<T, concord::Line>) {
+                    j["type"] = "LineString";
+                    j["coordinates"] = ringCoords(std::array<concord::Point, 2>{shape.getStart(), shape.getEnd()});
+                } else if constexpr (std::is_same_v<T, concord::Path>) {
+                    j["type"] = "LineString";
+                    j["coordinates"] = ringCoords(shape.getPoints());
+                } else if constexpr (std::is_same_v<T, concord::Polygon>) {
+                    j["type"] = "Polygon";
+                    j["coordinates"] = nlohmann::json::array({ringCoords(shape.getPoints())});
+                }
+                return j;
+            },
+            geom);
+    }
+
+    GEOSON_API nlohmann::json featureToJson(Feature const &f, const concord::Datum &datum, geoson::CRS outputCrs,
+                                            Quantization const *quant, ConversionMode conversion) {
+        nlohmann::json j;
+        j["type"] = "Feature";
+        {
+            GEOSON_STATS(op::PhaseTimer timer(op::writePhase(&WriteStats::propertiesNs),
+                                              op::writePhase(&WriteStats::propertiesAlloc));)
+            j["properties"] = nlohmann::json::object();
+            for (auto const &kv : f.properties)
+                j["properties"][kv.first] = kv.second;
+        }
+        GEOSON_STATS(if (op::activeWriteStats) {
+            ++op::activeWriteStats->features;
+            op::activeWriteStats->properties += f.properties.size();
+        })
+        j["geometry"] = geometryToJson(f.geometry, datum, outputCrs, quant, conversion);
+        return j;
+    }
+
+    GEOSON_API nlohmann::json headerToJson(FeatureCollection const &fc, geoson::CRS outputCrs) {
+        nlohmann::json P = nlohmann::json::object();
+
+        // crs → string (based on output CRS, not internal storage)
+        switch (outputCrs) {
+        case geoson::CRS::WGS:
+            P["crs"] = "EPSG:4326";
+            break;
+        case geoson::CRS::ENU:
+            P["crs"] = "ENU";
+            break;
+        }
+
+        // datum array
+        P["datum"] = nlohmann::json::array({fc.datum.lat, fc.datum.lon, fc.datum.alt});
+
+        // yaw only
+        P["heading"] = fc.heading.yaw;
+
+        // Add global properties
+        for (const auto &[key, value] : fc.global_properties) {
+            P[key] = value;
+        }
+        return P;
+    }
+
+    GEOSON_API nlohmann::json toJson(FeatureCollection const &fc, WriteOptions const &opts) {
+        GEOSON_TRACE_SCOPE("write/build");
+        GEOSON_STATS(op::StatsScope<WriteStats> scope(op::activeWriteStats, opts.stats);
+                     uint64_t conversionBefore = opts.stats ? opts.stats->conversionNs : 0;)
+        nlohmann::json j;
+        j["type"] = "FeatureCollection";
+
+        // top‐level properties
+        j["properties"] = headerToJson(fc, opts.outputCrs);
+
+        std::optional<Quantization> quant;
+        if (opts.quantum > 0.0) {
+            quant = makeQuantization(fc.datum, opts);
+            j["properties"]["transform"] = {{"scale", quant->scale}, {"translate", quant->translate}};
+        }
+
+        // features (use output CRS for coordinate conversion)
+        if (opts.executor && fc.features.size() > op::kFeatureChunk) {
+            nlohmann::json::array_t features(fc.features.size());
+            GEOSON_STATS(std::vector<WriteStats> partStats(
+                             opts.stats ? (fc.features.size() + op::kFeatureChunk - 1) / op::kFeatureChunk : 0);)
+            auto buildChunk = [&]([[maybe_unused]] size_t c, size_t b, size_t e) {
+                GEOSON_TRACE_SCOPE("write/chunk");
+                GEOSON_STATS(op::StatsScope<WriteStats> chunkScope(op::activeWriteStats,
+                                                                   opts.stats ? &partStats[c] : nullptr);)
+                for (size_t i = b; i < e; ++i)
+                    features[i] = featureToJson(fc.features[i], fc.datum, opts.outputCrs, quant ? &*quant : nullptr,
+                                                opts.conversion);
+            };
+            op::parallelFor(opts.executor, fc.features.size(), op::kFeatureChunk, buildChunk);
+            GEOSON_STATS(for (auto const &ws : partStats) *opts.stats += ws;)
+            j["features"] = std::move(features);
+        } else {
+            j["features"] = nlohmann::json::array();
+            for (auto const &f : fc.features)
+                j["features"].push_back(
+                    featureToJson(f, fc.datum, opts.outputCrs, quant ? &*quant : nullptr, opts.conversion));
+        }
+
+        // conversion ran inside the geometry phase: report the two exclusively
+        GEOSON_STATS(if (opts.stats) opts.stats->geometryNs -= opts.stats->conversionNs - conversionBefore;)
+        return j;
+    }
+
+    GEOSON_API nlohmann::json toJson(FeatureCollection const &fc, geoson::CRS outputCrs) {
+        WriteOptions opts;
+        opts.outputCrs = outputCrs;
+        return toJson(fc, opts);
+    }
+
+    GEOSON_API nlohmann::json toJson(FeatureCollection const &fc) { return toJson(fc, geoson::CRS::ENU); }
+
+    GEOSON_API void WriteFeatureCollection(FeatureCollection const &fc, std::filesystem::path const &outPath,
+                                           WriteOptions const &opts) {
+        GEOSON_TRACE_SCOPE("write");
+        auto j = toJson(fc, opts);
+        std::ofstream ofs(outPath);
+        if (!ofs)
+            throw std::runtime_error("Cannot open for write: " + outPath.string());
+        std::string text;
+        {
+            GEOSON_TRACE_SCOPE("write/serialize");
+            GEOSON_STATS(op::PhaseTimer timer(opts.stats ? &opts.stats->serializeNs : nullptr,
+                                              opts.stats ? &opts.stats->serializeAlloc : nullptr);)
+            text = j.dump(opts.pretty ? 2 : -1);
+        }
+        GEOSON_TRACE_SCOPE("write/io");
+        GEOSON_STATS(op::PhaseTimer timer(opts.stats ? &opts.stats->ioNs : nullptr,
+                                          opts.stats ? &opts.stats->ioAlloc : nullptr);
+                     if (opts.stats) opts.stats->bytes += text.size() + 1;)
+        ofs << text << "\n";
+        ofs.close();
+    }
+
+    GEOSON_API void WriteFeatureCollection(FeatureCollection const &fc, std::filesystem::path const &outPath,
+                                           geoson::CRS outputCrs) {
+        WriteOptions opts;
+        opts.outputCrs = outputCrs;
+        WriteFeatureCollection(fc, outPath, opts);
+    }
+
+    GEOSON_API void WriteFeatureCollection(FeatureCollection const &fc, std::filesystem::path const &outPath) {
+        WriteFeatureCollection(fc, outPath, geoson::CRS::ENU);
+    }
+
+} // namespace geoson
@@ -0,0 +1,562 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "geoson/record.hpp"
+#include "geoson/summary.hpp"
+#include "geoson/trace.hpp"
+#include "geoson/vector.hpp"
+
+// Crash-safe editing of a Vector. Every mutation is applied in memory and appended as a small binary record
+// to a write-ahead log next to the snapshot (<snapshot>.wal); loading replays the log over the snapshot.
+// Appends are group-committed: records pile up in a buffer and are written and fdatasync()ed together. Once
+// the log grows large it is compacted, i.e. folded into a new snapshot.
+//
+// Snapshot layout: "GEOSONSN", the Vector header record, the element count as u64, then each element record,
+// every record prefixed with its u32 length (see geoson/record.hpp). Unlike a GeoJSON round trip through
+// toFile()/fromFile(), this keeps the element list, the element types and the CRS exactly, which the
+// index-addressed log records rely on.
+//
+// Log layout: a 16-byte header ("GEOSONWL" and the hash64 of the snapshot bytes the log applies to), then
+// records of [u32 payload length][u32 checksum][u8 kind][payload]. A torn last record is dropped on load.
+
+namespace geoson {
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    struct JournalOptions {
+        /// pending records that trigger a commit from the mutating call; 1 makes every mutation durable
+        /// before it returns
+        size_t groupSize = 64;
+        /// longest time a mutation waits in the buffer before a background commit; zero disables the
+        /// background commit (then only groupSize, commit() and close commit)
+        std::chrono::milliseconds groupWindow{50};
+        /// compact once the log exceeds this many bytes; 0 never compacts automatically
+        uint64_t compactBytes = uint64_t(64) << 20;
+    };
+
+    /// A Vector whose mutations are journaled. Mutators mirror Vector's and may be called from several
+    /// threads; read the vector through vector() while holding lock() (and call no mutator meanwhile).
+    class VectorJournal {
+      public:
+        /// write `initial` as the snapshot `file` and start an empty log
+        static void create(const std::filesystem::path &file, Vector const &initial) {
+            ::close(writeSnapshot(initial, file, logPath(file)));
+        }
+
+        /// the Vector in the snapshot `file`, without the edits in its log
+        static Vector snapshot(const std::filesystem::path &file) { return decodeSnapshot(readAll(file)); }
+
+        /// load the snapshot `file` and replay its log
+        explicit VectorJournal(std::filesystem::path file, JournalOptions opts = {})
+            : file_(std::move(file)), log_(logPath(file_)), opts_(opts) {
+            std::string snapshot = readAll(file_);
+            vector_.emplace(decodeSnapshot(snapshot));
+            replay(hash64(snapshot));
+            fd_ = ::open(log_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+            if (fd_ < 0)
+                throw std::runtime_error("geoson::VectorJournal(): cannot open " + log_.string());
+            if (opts_.groupWindow.count() > 0)
+                flusher_ = std::thread([this] { flushLoop(); });
+        }
+
+        VectorJournal(VectorJournal const &) = delete;
+        VectorJournal &operator=(VectorJournal const &) = delete;
+
+        /// commits what is pending; does not compact
+        ~VectorJournal() {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            pendingCv_.notify_all();
+            if (flusher_.joinable())
+                flusher_.join();
+            try {
+                commit();
+            } catch (...) {
+            }
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        /// hold while reading vector() from another thread
+        std::unique_lock<std::mutex> lock() { return std::unique_lock(mutex_); }
+        Vector const &vector() const { return *vector_; }
+
+        void addElement(const Geometry &geometry, const std::string &type = "",
+                        const std::unordered_map<std::string, std::string> &properties = {}) {
+            std::unique_lock lock(mutex_);
+            vector_->addElement(geometry, type, properties);
+            Element const &e = vector_->getElement(vector_->elementCount() - 1);
+            append(Op::AddElement, [&](op::RecordEncoder &enc) { enc.out += op::encodeElement(e); }, lock);
+        }
+
+        /// out-of-range indices are ignored, as by Vector::removeElement()
+        void removeElement(size_t index) {
+            std::unique_lock lock(mutex_);
+            if (index >= vector_->elementCount())
+                return;
+            vector_->removeElement(index);
+            append(Op::RemoveElement, [&](op::RecordEncoder &enc) { enc.put(uint64_t(index)); }, lock);
+        }
+
+        void replaceElement(size_t index, Element const &e) {
+            std::unique_lock lock(mutex_);
+            vector_->replaceElement(index, e);
+            append(Op::ReplaceElement, [&](op::RecordEncoder &enc) {
+                enc.put(uint64_t(index));
+                enc.out += op::encodeElement(e);
+            }, lock);
+        }
+
+        void setElementProperty(size_t index, const std::string &key, const std::string &value) {
+            std::unique_lock lock(mutex_);
+            vector_->setElementProperty(index, key, value);
+            append(Op::SetElementProperty, [&](op::RecordEncoder &enc) {
+                enc.put(uint64_t(index));
+                enc.putString(key);
+                enc.putString(value);
+            }, lock);
+        }
+
+        void removeElementProperty(size_t index, const std::string &key) {
+            std::unique_lock lock(mutex_);
+            vector_->removeElementProperty(index, key);
+            append(Op::RemoveElementProperty, [&](op::RecordEncoder &enc) {
+                enc.put(uint64_t(index));
+                enc.putString(key);
+            }, lock);
+        }
+
+        void setGlobalProperty(const std::string &key, const std::string &value) {
+            keyed(Op::SetGlobalProperty, key, &value, [&] { vector_->setGlobalProperty(key, value); });
+        }
+        void removeGlobalProperty(const std::string &key) {
+            keyed(Op::RemoveGlobalProperty, key, nullptr, [&] { vector_->removeGlobalProperty(key); });
+        }
+        void setFieldProperty(const std::string &key, const std::string &value) {
+            keyed(Op::SetFieldProperty, key, &value, [&] { vector_->setFieldProperty(key, value); });
+        }
+        void removeFieldProperty(const std::string &key) {
+            keyed(Op::RemoveFieldProperty, key, nullptr, [&] { vector_->removeFieldProperty(key); });
+        }
+
+        void setFieldBoundary(const concord::Polygon &boundary) {
+            headerChange([&] { vector_->setFieldBoundary(boundary); });
+        }
+        void setDatum(const concord::Datum &datum) {
+            headerChange([&] { vector_->setDatum(datum); });
+        }
+        void setHeading(const concord::Euler &heading) {
+            headerChange([&] { vector_->setHeading(heading); });
+        }
+
+        /// write and fdatasync everything appended so far. Concurrent callers share one write: whoever
+        /// finds no commit in progress writes the whole buffer, the others wait for it
+        void commit() {
+            std::unique_lock lock(mutex_);
+            commitLocked(lock);
+        }
+
+        /// fold the log into a new snapshot and start an empty log. Mutations wait meanwhile
+        void compact() {
+            std::unique_lock lock(mutex_);
+            compactLocked(lock);
+        }
+
+        /// bytes in the log, including records not committed yet
+        uint64_t logBytes() const {
+            std::lock_guard lock(mutex_);
+            return logBytes_ + buffer_.size();
+        }
+        /// records replayed from the log when this journal was opened
+        uint64_t replayed() const { return replayed_; }
+        uint64_t compactions() const {
+            std::lock_guard lock(mutex_);
+            return compactions_;
+        }
+
+        static std::filesystem::path logPath(const std::filesystem::path &snapshot) {
+            auto p = snapshot;
+            p += ".wal";
+            return p;
+        }
+
+      private:
+        enum class Op : uint8_t {
+            AddElement = 1,
+            RemoveElement,
+            ReplaceElement,
+            SetElementProperty,
+            RemoveElementProperty,
+            SetGlobalProperty,
+            RemoveGlobalProperty,
+            SetFieldProperty,
+            RemoveFieldProperty,
+            Header, // datum, heading, CRS, field boundary and properties
+        };
+
+        static constexpr uint64_t kMagic = 0x4c57'4e4f'5345'4547ull;         // "GEOSONWL"
+        static constexpr uint64_t kSnapshotMagic = 0x4e53'4e4f'5345'4547ull; // "GEOSONSN"
+        static constexpr uint64_t kHeaderBytes = 16;
+        static constexpr size_t kRecordHeader = 9;
+
+        template <typename Apply> void keyed(Op kind, std::string const &key, std::string const *value, Apply apply) {
+            std::unique_lock lock(mutex_);
+            apply();
+            append(kind, [&](op::RecordEncoder &enc) {
+                enc.putString(key);
+                if (value)
+                    enc.putString(*value);
+            }, lock);
+        }
+
+        template <typename Apply> void headerChange(Apply apply) {
+            std::unique_lock lock(mutex_);
+            apply();
+            append(Op::Header, [&](op::RecordEncoder &enc) { enc.out += op::encodeVectorHeader(*vector_); }, lock);
+        }
+
+        template <typename Encode>
+        void append(Op kind, Encode encode, std::unique_lock<std::mutex> &lock) {
+            op::RecordEncoder enc;
+            enc.out.resize(kRecordHeader);
+            encode(enc);
+            auto payload = std::string_view(enc.out).substr(kRecordHeader);
+            uint32_t length = static_cast<uint32_t>(payload.size());
+            uint32_t checksum = static_cast<uint32_t>(hash64(payload)) ^ static_cast<uint32_t>(kind);
+            std::memcpy(enc.out.data(), &length, 4);
+            std::memcpy(enc.out.data() + 4, &checksum, 4);
+            enc.out[8] = static_cast<char>(kind);
+            buffer_ += enc.out;
+            ++appended_;
+            if (appended_ - durable_ >= opts_.groupSize)
+                commitLocked(lock);
+            else if (appended_ - durable_ == 1)
+                pendingCv_.notify_all();
+        }
+
+        void commitLocked(std::unique_lock<std::mutex> &lock) {
+            uint64_t target = appended_;
+            while (durable_ < target) {
+                if (committing_) {
+                    committedCv_.wait(lock);
+                    continue;
+                }
+                committing_ = true;
+                std::string batch = std::move(buffer_);
+                buffer_.clear();
+                uint64_t upto = appended_;
+                lock.unlock();
+                bool ok = writeAll(fd_, batch) && ::fdatasync(fd_) == 0;
+                auto err = ok ? std::string() : std::string(std::strerror(errno));
+                lock.lock();
+                committing_ = false;
+                committedCv_.notify_all();
+                if (!ok) {
+                    // drop a partial write and keep the records for the next attempt
+                    [[maybe_unused]] int rc = ::ftruncate(fd_, static_cast<off_t>(logBytes_));
+                    buffer_.insert(0, batch);
+                    throw std::runtime_error("geoson::VectorJournal(): cannot append to " + log_.string() + ": " + err);
+                }
+                durable_ = std::max(durable_, upto);
+                logBytes_ += batch.size();
+            }
+            if (opts_.compactBytes && logBytes_ > opts_.compactBytes && !compacting_)
+                compactLocked(lock);
+        }
+
+        void compactLocked(std::unique_lock<std::mutex> &lock) {
+            GEOSON_TRACE_SCOPE("VectorJournal/compact");
+            compacting_ = true;
+            struct Done {
+                bool &flag;
+                ~Done() { flag = false; }
+            } done{compacting_};
+            commitLocked(lock);
+            committedCv_.wait(lock, [&] { return !committing_; }); // nobody may be writing the old log
+            int fd = writeSnapshot(*vector_, file_, log_); // if it throws, appends go on to the old log
+            ::close(fd_);
+            fd_ = fd;
+            // records appended while the lock was released are in the snapshot already
+            buffer_.clear();
+            durable_ = appended_;
+            logBytes_ = kHeaderBytes;
+            ++compactions_;
+            committedCv_.notify_all();
+        }
+
+        /// background group commit: once a record is pending, commit after groupWindow
+        void flushLoop() {
+            std::unique_lock lock(mutex_);
+            while (!stop_) {
+                if (appended_ == durable_) {
+                    pendingCv_.wait(lock);
+                    continue;
+                }
+                pendingCv_.wait_for(lock, opts_.groupWindow, [&] { return stop_; });
+                try {
+                    commitLocked(lock);
+                } catch (...) {
+                    // reported by the next commit() of a caller, which retries the write
+                }
+            }
+        }
+
+        /// Apply the log's records to the loaded snapshot. A log written for another snapshot (compaction
+        /// was interrupted after the new snapshot was in place) is discarded: the snapshot already holds it
+        void replay(uint64_t snapshotHash) {
+            std::string log;
+            if (std::filesystem::exists(log_))
+                log = readAll(log_);
+            uint64_t magic = 0, base = 0;
+            if (log.size() >= kHeaderBytes) {
+                std::memcpy(&magic, log.data(), 8);
+                std::memcpy(&base, log.data() + 8, 8);
+            }
+            if (magic != kMagic || base != snapshotHash) {
+                writeLogHeader(log_, snapshotHash);
+                logBytes_ = kHeaderBytes;
+                return;
+            }
+
+            size_t at = kHeaderBytes;
+            while (log.size() - at >= kRecordHeader) {
+                uint32_t length, checksum;
+                std::memcpy(&length, log.data() + at, 4);
+                std::memcpy(&checksum, log.data() + at + 4, 4);
+                auto kind = static_cast<uint8_t>(log[at + 8]);
+                if (log.size() - at - kRecordHeader < length)
+                    break;
+                auto payload = std::string_view(log).substr(at + kRecordHeader, length);
+                if ((static_cast<uint32_t>(hash64(payload)) ^ kind) != checksum)
+                    break;
+                apply(static_cast<Op>(kind), payload);
+                at += kRecordHeader + length;
+                ++replayed_;
+            }
+            if (at < log.size()) // torn tail of an interrupted append: cut it off
+                std::filesystem::resize_file(log_, at);
+            logBytes_ = at;
+        }
+
+        void apply(Op kind, std::string_view payload) {
+            op::RecordDecoder dec{payload.data(), payload.data() + payload.size()};
+            auto &v = *vector_;
+            auto index = [&] {
+                auto i = dec.get<uint64_t>();
+                if (i >= v.elementCount())
+                    throw std::runtime_error("geoson::VectorJournal(): log refers to a missing element");
+                return static_cast<size_t>(i);
+            };
+            switch (kind) {
+            case Op::AddElement:
+                v.appendElement(op::decodeElement(payload));
+                break;
+            case Op::RemoveElement:
+                v.removeElement(index());
+                break;
+            case Op::ReplaceElement: {
+                size_t i = index();
+                v.replaceElement(i, op::decodeElement(payload.substr(8)));
+                break;
+            }
+            case Op::SetElementProperty: {
+                size_t i = index();
+                auto key = dec.getString();
+                v.setElementProperty(i, key, dec.getString());
+                break;
+            }
+            case Op::RemoveElementProperty: {
+                size_t i = index();
+                v.removeElementProperty(i, dec.getString());
+                break;
+            }
+            case Op::SetGlobalProperty: {
+                auto key = dec.getString();
+                v.setGlobalProperty(key, dec.getString());
+                break;
+            }
+            case Op::RemoveGlobalProperty:
+                v.removeGlobalProperty(dec.getString());
+                break;
+            case Op::SetFieldProperty: {
+                auto key = dec.getString();
+                v.setFieldProperty(key, dec.getString());
+                break;
+            }
+            case Op::RemoveFieldProperty:
+                v.removeFieldProperty(dec.getString());
+                break;
+            case Op::Header: {
+                auto h = op::decodeVectorHeader(payload);
+                v.setFieldBoundary(h.getFieldBoundary());
+                v.setDatum(h.getDatum());
+                v.setHeading(h.getHeading());
+                v.setCRS(h.getCRS());
+                for (auto const &[key, value] : std::unordered_map(v.getFieldProperties()))
+                    if (!h.getFieldProperties().count(key))
+                        v.removeFieldProperty(key);
+                for (auto const &[key, value] : h.getFieldProperties())
+                    v.setFieldProperty(key, value);
+                for (auto const &[key, value] : std::unordered_map(v.getGlobalProperties()))
+                    if (!h.getGlobalProperties().count(key))
+                        v.removeGlobalProperty(key);
+                for (auto const &[key, value] : h.getGlobalProperties())
+                    v.setGlobalProperty(key, value);
+                break;
+            }
+            default:
+                throw std::runtime_error("geoson::VectorJournal(): unknown log record");
+            }
+        }
+
+        static std::string encodeSnapshot(Vector const &v) {
+            op::RecordEncoder enc;
+            enc.put(kSnapshotMagic);
+            enc.putString(op::encodeVectorHeader(v));
+            enc.put(uint64_t(v.elementCount()));
+            for (auto const &e : v)
+                enc.putString(op::encodeElement(e));
+            return std::move(enc.out);
+        }
+
+        static Vector decodeSnapshot(std::string_view data) {
+            op::RecordDecoder dec{data.data(), data.data() + data.size()};
+            if (data.size() < 8 || dec.get<uint64_t>() != kSnapshotMagic)
+                throw std::runtime_error("geoson::VectorJournal(): not a journal snapshot");
+            Vector v = op::decodeVectorHeader(dec.getString());
+            auto count = dec.get<uint64_t>();
+            for (uint64_t i = 0; i < count; ++i)
+                v.appendElement(op::decodeElement(dec.getString()));
+            return v;
+        }
+
+        static std::string readAll(const std::filesystem::path &file) {
+            std::ifstream in(file, std::ios::binary);
+            if (!in)
+                throw std::runtime_error("geoson::VectorJournal(): cannot open " + file.string());
+            return std::string(std::istreambuf_iterator<char>(in), {});
+        }
+
+        static bool writeAll(int fd, std::string_view data) {
+            while (!data.empty()) {
+                auto n = ::write(fd, data.data(), data.size());
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                data.remove_prefix(static_cast<size_t>(n));
+            }
+            return true;
+        }
+
+        static std::filesystem::path tempPath(std::filesystem::path file) {
+            file += ".tmp";
+            return file;
+        }
+
+        /// create the temporary of `file` holding `data`, fsync()ed; returns it open for appending
+        static int writeTemp(const std::filesystem::path &file, std::string_view data) {
+            auto tmp = tempPath(file);
+            int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+            if (fd >= 0 && writeAll(fd, data) && ::fsync(fd) == 0)
+                return fd;
+            auto err = std::string(std::strerror(errno));
+            if (fd >= 0)
+                ::close(fd);
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            throw std::runtime_error("geoson::VectorJournal(): cannot write " + tmp.string() + ": " + err);
+        }
+
+        /// write `data` to `file` durably, through a temporary renamed into place
+        static void replaceFile(const std::filesystem::path &file, std::string_view data) {
+            ::close(writeTemp(file, data));
+            std::filesystem::rename(tempPath(file), file);
+            syncDirectory(file);
+        }
+
+        static void syncDirectory(const std::filesystem::path &file) {
+            auto dir = file.parent_path().empty() ? std::filesystem::path(".") : file.parent_path();
+            int fd = ::open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                ::fsync(fd);
+                ::close(fd);
+            }
+        }
+
+        static std::string logHeader(uint64_t snapshotHash) {
+            std::string header(kHeaderBytes, '\0');
+            std::memcpy(header.data(), &kMagic, 8);
+            std::memcpy(header.data() + 8, &snapshotHash, 8);
+            return header;
+        }
+
+        static void writeLogHeader(const std::filesystem::path &log, uint64_t snapshotHash) {
+            replaceFile(log, logHeader(snapshotHash));
+        }
+
+        /// Write the snapshot of `v` and its empty log, both to temporaries first, and return the new log open
+        /// for appending. The snapshot goes in first; the old log then no longer matches it and is ignored if
+        /// the new one is not in place yet. A failure before the snapshot is replaced changes nothing.
+        static int writeSnapshot(Vector const &v, const std::filesystem::path &file,
+                                 const std::filesystem::path &log) {
+            std::string data = encodeSnapshot(v);
+            int fd = -1;
+            try {
+                ::close(writeTemp(file, data));
+                fd = writeTemp(log, logHeader(hash64(data)));
+                std::filesystem::rename(tempPath(file), file);
+                std::filesystem::rename(tempPath(log), log);
+            } catch (...) {
+                if (fd >= 0)
+                    ::close(fd);
+                std::error_code ec;
+                std::filesystem::remove(tempPath(file), ec);
+                std::filesystem::remove(tempPath(log), ec);
+                throw;
+            }
+            syncDirectory(file);
+            return fd;
+        }
+
+        std::filesystem::path file_, log_;
+        JournalOptions opts_;
+        std::optional<Vector> vector_;
+        int fd_ = -1;
+
+        mutable std::mutex mutex_;
+        std::condition_variable pendingCv_, committedCv_;
+        std::string buffer_;
+        uint64_t appended_ = 0, durable_ = 0;
+        uint64_t logBytes_ = 0, replayed_ = 0, compactions_ = 0;
+        bool committing_ = false, compacting_ = false, stop_ = false;
+        std::thread flusher_;
+    };
+
+#endif
+
+} // namespace geoson
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include "geoson/config.hpp"
+
+// The full nlohmann::json, for the headers that work on JSON values directly. In compiled-library builds
+// nlohmann::json is instantiated once, in the library, rather than in every translation unit using it.
+
+#if defined(GEOSON_COMPILED_LIBRARY)
+extern template class nlohmann::basic_json<>;
+#endif
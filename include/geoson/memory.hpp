@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Optional allocation accounting. The library never replaces the global allocator itself: an application
+// (or benchmark / test binary) that wants allocation counts puts GEOSON_INSTALL_ALLOCATION_HOOKS() in
+// exactly one translation unit, which defines counting global operator new / delete on top of malloc.
+// Counters are per thread, so concurrent readers do not contend and each thread sees its own work.
+
+namespace geoson::alloc {
+
+    struct Counters {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t bytes = 0; // requested by allocations; frees are not sized reliably, so not subtracted
+    };
+
+    namespace op {
+        inline thread_local Counters counters;
+        inline bool installed = false;
+
+        inline void onAllocate(size_t n) {
+            ++counters.allocations;
+            counters.bytes += n;
+        }
+        inline void onFree() { ++counters.deallocations; }
+
+        inline void *allocate(size_t n) {
+            onAllocate(n);
+            if (void *p = std::malloc(n ? n : 1))
+                return p;
+            throw std::bad_alloc();
+        }
+        inline void release(void *p) {
+            if (p) {
+                onFree();
+                std::free(p);
+            }
+        }
+    } // namespace op
+
+    /// true when GEOSON_INSTALL_ALLOCATION_HOOKS() is part of the program; without it every count is zero
+    inline bool hooksInstalled() { return op::installed; }
+
+    /// allocation counters of the calling thread since it started
+    inline Counters current() { return op::counters; }
+
+    /// counts the allocations made by the calling thread during the scope's lifetime
+    class Scope {
+      public:
+        Scope() : start_(op::counters) {}
+
+        Counters delta() const {
+            auto now = op::counters;
+            return {now.allocations - start_.allocations, now.deallocations - start_.deallocations,
+                    now.bytes - start_.bytes};
+        }
+
+      private:
+        Counters start_;
+    };
+
+} // namespace geoson::alloc
+
+/// define the counting global allocation functions; use in one .cpp file at namespace scope
+#define GEOSON_INSTALL_ALLOCATION_HOOKS()                                                                     \
+    void *operator new(std::size_t n) { return ::geoson::alloc::op::allocate(n); }                           \
+    void *operator new[](std::size_t n) { return ::geoson::alloc::op::allocate(n); }                         \
+    void operator delete(void *p) noexcept { ::geoson::alloc::op::release(p); }                              \
+    void operator delete[](void *p) noexcept { ::geoson::alloc::op::release(p); }                            \
+    void operator delete(void *p, std::size_t) noexcept { ::geoson::alloc::op::release(p); }                 \
+    void operator delete[](void *p, std::size_t) noexcept { ::geoson::alloc::op::release(p); }               \
+    static const bool geoson_allocation_hooks_installed_ = (::geoson::alloc::op::installed = true)
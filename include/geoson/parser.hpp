@@ -1,213 +1,127 @@
 #pragma once
 
+#include <array>
 #include <filesystem>
-#include <fstream>
-#include <iostream>
-#include <nlohmann/json.hpp>
-#include <stdexcept>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
 #include <unordered_map>
-#include <variant>
 #include <vector>
 
 #include "concord/concord.hpp" // for concord::CRS, Datum, Euler
 
+#include "geoson/config.hpp"
+#include "geoson/executor.hpp"
+#include "geoson/projection.hpp"
+#include "geoson/simplify.hpp"
+#include "geoson/stats.hpp"
+#include "geoson/trace.hpp"
 #include "geoson/types.hpp"
 
+#if defined(GEOSON_COMPILED_LIBRARY)
+#include <nlohmann/json_fwd.hpp>
+#else
+#include "geoson/json.hpp"
+#endif
+
 namespace geoson {
 
-    namespace op {
-        inline nlohmann::json ReadFeatureCollection(const std::filesystem::path &file) {
-            std::ifstream ifs(file);
-            if (!ifs) {
-                throw std::runtime_error("geoson::ReadFeatureCollection(): cannot open \"" + file.string() + '\"');
-            }
-
-            nlohmann::json j;
-            ifs >> j;
-
-            if (!j.is_object() || !j.contains("type") || !j["type"].is_string()) {
-                throw std::runtime_error(
-                    "geoson::ReadFeatureCollection(): top-level object has no string 'type' field");
-            }
-
-            auto type = j["type"].get<std::string>();
-            if (type == "FeatureCollection") {
-                return j;
-            }
-            if (type == "Feature") {
-                return nlohmann::json{{"type", "FeatureCollection"}, {"features", nlohmann::json::array({j})}};
-            }
-
-            // bare geometry → wrap into a one-feature collection
-            nlohmann::json feat = {{"type", "Feature"}, {"geometry", j}, {"properties", nlohmann::json::object()}};
-            return nlohmann::json{{"type", "FeatureCollection"}, {"features", nlohmann::json::array({feat})}};
-        }
-    } // namespace op
+    /// options controlling how a GeoJSON file is turned into a FeatureCollection
+    struct ReadOptions {
+        /// Douglas-Peucker tolerance (metres, in the internal ENU frame) applied to every LineString
+        /// and Polygon ring while it is parsed; 0 keeps every vertex
+        double simplifyTolerance = 0.0;
+        /// upper bound on vertices taken from any single LineString or ring (evenly strided, endpoints
+        /// kept, never below 2 for lines / 4 for rings); 0 means unlimited. With this or simplifyTolerance
+        /// set, ReadFeatureCollection() streams the file instead of parsing it whole, so only the decimated
+        /// collection is held in memory
+        size_t maxVerticesPerGeometry = 0;
+        /// how WGS input is converted to ENU; LocalTangent trades sub-millimetre accuracy near the datum
+        /// for a much cheaper per-vertex conversion (see geoson/projection.hpp)
+        ConversionMode conversion = ConversionMode::Exact;
+        /// per-phase counters and timings of the read, added to *stats; only filled in builds with
+        /// GEOSON_ENABLE_STATS (see geoson/stats.hpp). Phase times of a parallel read are summed over threads
+        ParseStats *stats = nullptr;
+        /// decode features in chunks on this executor (e.g. &defaultExecutor()); null decodes them on the
+        /// calling thread. Feature order is the same either way
+        Executor *executor = nullptr;
+    };
+
+    /// everything a FeatureCollection carries besides its features
+    struct CollectionHeader {
+        geoson::CRS crs = geoson::CRS::ENU;
+        concord::Datum datum;
+        concord::Euler heading;
+        std::unordered_map<std::string, std::string> global_properties;
+        std::optional<Quantization> quantization; // compact profile transform, if present
+    };
 
     using json = nlohmann::json;
 
-    inline std::unordered_map<std::string, std::string> parseProperties(const json &props) {
-        std::unordered_map<std::string, std::string> m;
-        m.reserve(props.size());
-        for (auto const &item : props.items()) {
-            if (item.value().is_string())
-                m[item.key()] = item.value().get<std::string>();
-            else
-                m[item.key()] = item.value().dump();
-        }
-        return m;
-    }
-
-    inline concord::Point parsePoint(const json &coords, const concord::Datum &datum, geoson::CRS crs) {
-        double x = coords.at(0).get<double>();
-        double y = coords.at(1).get<double>();
-        double z = coords.size() > 2 ? coords.at(2).get<double>() : 0.0;
-
-        // Internal representation is always in Point coordinates (ENU/local system)
-        if (crs == geoson::CRS::ENU) {
-            // ENU flavor: coordinates are already local x,y,z
-            return concord::Point{x, y, z};
-        } else {
-            // WGS flavor: coordinates are lon,lat,alt - convert to ENU using datum
-            // Note: WGS constructor is (lat, lon, alt), so swap x,y
-            concord::WGS wgs{y, x, z};
-            concord::ENU enu = wgs.toENU(datum);
-            return concord::Point{enu.x, enu.y, enu.z};
-        }
-    }
-
-    inline Geometry parseLineString(const json &coords, const concord::Datum &datum, geoson::CRS crs) {
-        std::vector<concord::Point> pts;
-        pts.reserve(coords.size());
-        for (auto const &c : coords)
-            pts.push_back(parsePoint(c, datum, crs));
-        if (pts.size() == 2)
-            return concord::Line{pts[0], pts[1]};
-        else
-            return concord::Path{pts};
-    }
-
-    inline concord::Polygon parsePolygon(const json &coords, const concord::Datum &datum, geoson::CRS crs) {
-        std::vector<concord::Point> pts;
-        auto const &ring = coords.at(0);
-        pts.reserve(ring.size());
-        for (auto const &c : ring)
-            pts.push_back(parsePoint(c, datum, crs));
-        return concord::Polygon{pts};
-    }
-
-    inline std::vector<Geometry> parseGeometry(const json &geom, const concord::Datum &datum, geoson::CRS crs) {
-        std::vector<Geometry> out;
-        auto type = geom.at("type").get<std::string>();
-
-        if (type == "Point") {
-            out.emplace_back(parsePoint(geom.at("coordinates"), datum, crs));
-        } else if (type == "LineString") {
-            out.emplace_back(parseLineString(geom.at("coordinates"), datum, crs));
-        } else if (type == "Polygon") {
-            out.emplace_back(parsePolygon(geom.at("coordinates"), datum, crs));
-        } else if (type == "MultiPoint") {
-            for (auto const &c : geom.at("coordinates"))
-                out.emplace_back(parsePoint(c, datum, crs));
-        } else if (type == "MultiLineString") {
-            for (auto const &linegeoson : geom.at("coordinates"))
-                out.emplace_back(parseLineString(linegeoson, datum, crs));
-        } else if (type == "MultiPolygon") {
-            for (auto const &poly : geom.at("coordinates"))
-                out.emplace_back(parsePolygon(poly, datum, crs));
-        } else if (type == "GeometryCollection") {
-            for (auto const &sub : geom.at("geometries")) {
-                auto subs = parseGeometry(sub, datum, crs);
-                out.insert(out.end(), subs.begin(), subs.end());
-            }
-        }
-        return out;
-    }
-
-    // ––– parse the CRS string into the enum –––
-
-    inline geoson::CRS parseCRS(const std::string &s) {
-        if (s == "EPSG:4326" || s == "WGS84" || s == "WGS")
-            return geoson::CRS::WGS;
-        else if (s == "ENU" || s == "ECEF")
-            return geoson::CRS::ENU;
-        throw std::runtime_error("Unknown CRS string: " + s);
-    }
+    /// copy a GeoJSON 'properties' object into a string map (non-string values as their JSON text)
+    GEOSON_API std::unordered_map<std::string, std::string> parseProperties(const json &props);
+
+    /// one GeoJSON position in the file's CRS as an internal (ENU) Point
+    GEOSON_API concord::Point parsePoint(const json &coords, const concord::Datum &datum, geoson::CRS crs,
+                                         ReadOptions const &opts = {});
+
+    GEOSON_API Geometry parseLineString(const json &coords, const concord::Datum &datum, geoson::CRS crs,
+                                        ReadOptions const &opts = {});
+
+    GEOSON_API concord::Polygon parsePolygon(const json &coords, const concord::Datum &datum, geoson::CRS crs,
+                                             ReadOptions const &opts = {});
+
+    /// one geoson Geometry per (sub-)geometry of a GeoJSON geometry object
+    GEOSON_API std::vector<Geometry> parseGeometry(const json &geom, const concord::Datum &datum, geoson::CRS crs,
+                                                   ReadOptions const &opts = {});
+
+    GEOSON_API geoson::CRS parseCRS(const std::string &s);
+
+    // ––– compact profile: quantized, delta-encoded coordinates –––
+
+    /// read a 'transform' object ({"scale": [..], "translate": [..]}) into a Quantization
+    GEOSON_API Quantization parseQuantization(const json &t);
+
+    /// true when the header carries a compact-profile transform
+    GEOSON_API bool hasQuantization(const json &P);
+
+    /// decode a compact-profile geometry back to plain coordinates in the file's CRS
+    GEOSON_API json dequantizeGeometry(const json &geom, Quantization const &q);
+
+    // ––– collection header –––
+
+    /// validate and parse the top-level 'properties' object of a FeatureCollection
+    GEOSON_API CollectionHeader parseHeader(const json &P);
+
+    /// parse one GeoJSON Feature object, appending one geoson Feature per (sub-)geometry to `out`;
+    /// features with a null geometry are skipped
+    GEOSON_API void parseFeature(const json &feat, CollectionHeader const &h, std::vector<Feature> &out,
+                                 ReadOptions const &opts = {});
+
+    namespace op {
+        /// parseFeature() over `features` in order, in chunks on opts.executor when one is given
+        GEOSON_API void parseFeatures(std::span<const json> features, CollectionHeader const &h,
+                                      std::vector<Feature> &out, ReadOptions const &opts);
+
+        /// ReadFeatureCollection() one feature at a time through FeatureReader, for decimating reads.
+        /// Defined in geoson/stream.hpp, which this header includes at its end
+        inline FeatureCollection readStreamed(const std::filesystem::path &file, ReadOptions const &opts);
+    } // namespace op
 
     // ––– main loader –––
 
-    inline FeatureCollection ReadFeatureCollection(const std::filesystem::path &file) {
-        auto fc_json = op::ReadFeatureCollection(file);
-
-        if (!fc_json.contains("properties") || !fc_json["properties"].is_object())
-            throw std::runtime_error("missing top-level 'properties'");
-        auto &P = fc_json["properties"];
-
-        if (!P.contains("crs") || !P["crs"].is_string())
-            throw std::runtime_error("'properties' missing string 'crs'");
-        if (!P.contains("datum") || !P["datum"].is_array() || P["datum"].size() < 3)
-            throw std::runtime_error("'properties' missing array 'datum' of ≥3 numbers");
-        if (!P.contains("heading") || !P["heading"].is_number())
-            throw std::runtime_error("'properties' missing numeric 'heading'");
-
-        // extract the new types
-        auto crsVal = parseCRS(P["crs"].get<std::string>());
-        auto &A = P["datum"];
-        concord::Datum d{A[0].get<double>(), A[1].get<double>(), A[2].get<double>()};
-        double yaw = P["heading"].get<double>();
-        concord::Euler euler{0.0, 0.0, yaw};
-
-        FeatureCollection fc;
-        fc.datum = d;
-        fc.heading = euler;
-        fc.features.reserve(fc_json["features"].size());
-        
-        // Parse global properties (excluding built-in ones)
-        for (const auto& [key, value] : P.items()) {
-            if (key != "crs" && key != "datum" && key != "heading") {
-                if (value.is_string()) {
-                    fc.global_properties[key] = value.get<std::string>();
-                } else {
-                    fc.global_properties[key] = value.dump();
-                }
-            }
-        }
-
-        for (auto const &feat : fc_json["features"]) {
-            if (feat.value("geometry", json{}).is_null())
-                continue;
-            auto geoms = parseGeometry(feat["geometry"], d, crsVal);
-            auto props_map = parseProperties(feat.value("properties", json::object()));
-            for (auto &g : geoms)
-                fc.features.emplace_back(Feature{std::move(g), props_map});
-        }
-
-        return fc;
-    }
-
-    // ––– pretty-print FeatureCollection header –––
-
-    inline std::ostream &operator<<(std::ostream &os, FeatureCollection const &fc) {
-        os << "DATUM: " << fc.datum.lat << ", " << fc.datum.lon << ", " << fc.datum.alt << "\n"
-           << "HEADING: " << fc.heading.yaw << "\n";
-        os << "FEATURES: " << fc.features.size() << "\n";
-
-        for (auto const &f : fc.features) {
-            auto &v = f.geometry;
-            if (std::get_if<concord::Polygon>(&v)) {
-                os << "  POLYGON\n";
-            } else if (std::get_if<concord::Line>(&v)) {
-                os << "  LINE\n";
-            } else if (std::get_if<concord::Path>(&v)) {
-                os << "  PATH\n";
-            } else if (std::get_if<concord::Point>(&v)) {
-                os << "   POINT\n";
-            }
-            if (f.properties.size() > 0)
-                os << "    PROPS:" << f.properties.size() << "\n";
-        }
-
-        return os;
-    }
+    GEOSON_API FeatureCollection ReadFeatureCollection(const std::filesystem::path &file,
+                                                       ReadOptions const &opts = {});
+
+    /// pretty-print the FeatureCollection header and a line per feature
+    GEOSON_API std::ostream &operator<<(std::ostream &os, FeatureCollection const &fc);
 
 } // namespace geoson
+
+#if !defined(GEOSON_COMPILED_LIBRARY)
+#include "geoson/impl/parser.ipp"
+#endif
+
+// last: the streaming reader builds on the declarations above
+#include "geoson/stream.hpp"
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "geoson/executor.hpp"
+#include "geoson/geometry.hpp"
+#include "geoson/json.hpp"
+#include "geoson/projection.hpp"
+#include "geoson/stream.hpp"
+#include "geoson/trace.hpp"
+
+// Splitting a collection into k spatially compact shards of similar work, e.g. to spread it over worker
+// nodes. Features are ordered along a Hilbert curve over their WGS centres and the curve is cut into k runs
+// of equal vertex count: neighbouring features land in the same shard, and dense and sparse regions get
+// shards of different area but similar weight. Each shard goes to its own file, next to a manifest.json
+// listing extents and counts. At most PartitionOptions::maxOpenFiles shard files are open at once; more
+// shards are written in several passes over the input.
+
+namespace geoson {
+
+    struct PartitionOptions {
+        /// shard files are named <prefix>000.geojson, <prefix>001.geojson, ...
+        std::string prefix = "shard-";
+        /// how a file input is parsed (conversion and executor apply)
+        ReadOptions read;
+        /// how a collection input is written; file inputs are copied feature by feature in their own
+        /// CRS and encoding
+        WriteOptions write;
+        /// where placements are computed; null uses defaultExecutor()
+        Executor *executor = nullptr;
+        /// shard files open for writing at once, well below the usual open-file limit (RLIMIT_NOFILE, often
+        /// 1024). Beyond it shards are written in groups of this size, one pass over the input per group
+        /// (a file input is read again for each)
+        size_t maxOpenFiles = 256;
+    };
+
+    struct ShardInfo {
+        std::filesystem::path file;
+        uint64_t features = 0;
+        uint64_t vertices = 0;
+        BoundingBox enu; // internal ENU frame (x, y, z)
+        BoundingBox wgs; // lon, lat, alt
+    };
+
+    struct PartitionManifest {
+        concord::Datum datum;
+        std::vector<ShardInfo> shards;
+    };
+
+    namespace op {
+
+        /// position of (x, y) along a Hilbert curve filling the 2^32 x 2^32 grid
+        inline uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+            uint64_t d = 0;
+            for (uint32_t s = uint32_t(1) << 31; s > 0; s >>= 1) {
+                uint32_t rx = (x & s) ? 1 : 0;
+                uint32_t ry = (y & s) ? 1 : 0;
+                d += uint64_t(s) * uint64_t(s) * ((3 * rx) ^ ry);
+                if (ry == 0) { // rotate the quadrant
+                    if (rx == 1) {
+                        x = ~x;
+                        y = ~y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return d;
+        }
+
+        /// where a feature goes: Hilbert key of its centre, weight and ENU extent
+        struct Placement {
+            uint64_t key = 0;
+            uint64_t vertices = 0;
+            BoundingBox enu;
+        };
+
+        /// place one source feature, i.e. all the geoson Features parsed from it (a Multi* geometry yields
+        /// several); features without geometry get key 0 and weight 0
+        inline Placement place(std::span<const Feature> parts, concord::Datum const &datum, ConversionMode mode) {
+            Placement p;
+            for (auto const &f : parts) {
+                p.vertices += vertexCount(f.geometry);
+                p.enu.expand(boundingBox(f.geometry));
+            }
+            if (p.enu.empty())
+                return p;
+            auto wgs = toWGS((p.enu.min[0] + p.enu.max[0]) / 2, (p.enu.min[1] + p.enu.max[1]) / 2, 0.0, datum, mode);
+            auto grid = [](double v, double lo, double span) {
+                double t = std::clamp((v - lo) / span, 0.0, 1.0);
+                return static_cast<uint32_t>(t * 4294967295.0);
+            };
+            p.key = hilbertIndex(grid(wgs[1], -180.0, 360.0), grid(wgs[0], -90.0, 180.0));
+            return p;
+        }
+
+        /// lon/lat/alt extent of an ENU box, from its corners
+        inline BoundingBox wgsBox(BoundingBox const &enu, concord::Datum const &datum, ConversionMode mode) {
+            BoundingBox box;
+            if (enu.empty())
+                return box;
+            for (int c = 0; c < 8; ++c) {
+                // skip repeated corners of degenerate (point or flat) boxes
+                if (((c & 1) && enu.min[0] == enu.max[0]) || ((c & 2) && enu.min[1] == enu.max[1]) ||
+                    ((c & 4) && enu.min[2] == enu.max[2]))
+                    continue;
+                auto w = toWGS((c & 1) ? enu.max[0] : enu.min[0], (c & 2) ? enu.max[1] : enu.min[1],
+                               (c & 4) ? enu.max[2] : enu.min[2], datum, mode);
+                box.expand(w[1], w[0], w[2]);
+            }
+            return box;
+        }
+
+        /// the last key of each of the first k-1 shards, cutting the key order into runs of equal weight;
+        /// a feature goes to shardOf(cuts, key). Features with equal keys stay together
+        inline std::vector<uint64_t> cutKeys(std::vector<std::pair<uint64_t, uint64_t>> weighted, size_t k) {
+            std::sort(weighted.begin(), weighted.end());
+            uint64_t total = 0;
+            for (auto const &[key, w] : weighted)
+                total += w;
+            std::vector<uint64_t> cuts;
+            uint64_t acc = 0;
+            size_t next = 1;
+            for (auto const &[key, w] : weighted) {
+                acc += w;
+                while (next < k && acc * k >= total * next) {
+                    cuts.push_back(key);
+                    ++next;
+                }
+            }
+            while (cuts.size() + 1 < k)
+                cuts.push_back(UINT64_MAX);
+            return cuts;
+        }
+
+        inline size_t shardOf(std::vector<uint64_t> const &cuts, uint64_t key) {
+            return static_cast<size_t>(std::lower_bound(cuts.begin(), cuts.end(), key) - cuts.begin());
+        }
+
+        inline std::vector<ShardInfo> shardFiles(const std::filesystem::path &dir, std::string const &prefix,
+                                                 size_t k) {
+            size_t width = std::max<size_t>(3, std::to_string(k - 1).size());
+            std::vector<ShardInfo> shards(k);
+            for (size_t i = 0; i < k; ++i) {
+                auto n = std::to_string(i);
+                shards[i].file = dir / (prefix + std::string(width - n.size(), '0') + n + ".geojson");
+            }
+            return shards;
+        }
+
+        inline nlohmann::json manifestToJson(PartitionManifest const &m) {
+            auto box = [](BoundingBox const &b) {
+                if (b.empty())
+                    return nlohmann::json(nullptr);
+                return nlohmann::json::array({b.min[0], b.min[1], b.min[2], b.max[0], b.max[1], b.max[2]});
+            };
+            nlohmann::json j;
+            j["datum"] = nlohmann::json::array({m.datum.lat, m.datum.lon, m.datum.alt});
+            j["shards"] = nlohmann::json::array();
+            for (auto const &s : m.shards)
+                j["shards"].push_back({{"file", s.file.filename().string()},
+                                       {"features", s.features},
+                                       {"vertices", s.vertices},
+                                       {"bbox", box(s.wgs)},
+                                       {"enu", box(s.enu)}});
+            return j;
+        }
+
+        inline void writeManifest(const std::filesystem::path &dir, PartitionManifest const &m) {
+            std::ofstream out(dir / "manifest.json", std::ios::binary);
+            out << manifestToJson(m).dump(2) << '\n';
+            if (!out)
+                throw std::runtime_error("geoson::partition(): cannot write " + (dir / "manifest.json").string());
+        }
+
+        inline void removeShards(PartitionManifest const &m, const std::filesystem::path &dir) {
+            std::error_code ec;
+            for (auto const &s : m.shards)
+                std::filesystem::remove(s.file, ec);
+            std::filesystem::remove(dir / "manifest.json", ec);
+        }
+
+        inline void checkShardCount(size_t k) {
+            if (k == 0)
+                throw std::runtime_error("geoson::partition(): the number of shards must be positive");
+        }
+
+        /// writers for shards [first, first + count), the group written in one pass
+        inline std::vector<std::optional<FeatureWriter>> openShards(PartitionManifest const &m, size_t first,
+                                                                    size_t count, CollectionHeader const &header,
+                                                                    geoson::CRS crs, ConversionMode mode) {
+            std::vector<std::optional<FeatureWriter>> writers(count);
+            for (size_t s = 0; s < count; ++s)
+                writers[s].emplace(m.shards[first + s].file, header, crs, mode);
+            return writers;
+        }
+
+    } // namespace op
+
+    /// Split `fc` into k spatially compact shards of similar vertex count, written as GeoJSON files under
+    /// `dir` (created if needed) with opts.write, plus dir/manifest.json. Shards keep the collection's
+    /// header and their features' relative order; a shard may be empty when k exceeds the distinct places.
+    inline PartitionManifest partition(FeatureCollection const &fc, size_t k, const std::filesystem::path &dir,
+                                       PartitionOptions const &opts = {}) {
+        GEOSON_TRACE_SCOPE("partition");
+        op::checkShardCount(k);
+        std::filesystem::create_directories(dir);
+        auto mode = opts.write.conversion;
+
+        std::vector<op::Placement> placed(fc.features.size());
+        op::parallelFor(opts.executor, placed.size(), op::kFeatureChunk, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                placed[i] = op::place(std::span(&fc.features[i], 1), fc.datum, mode);
+        });
+        std::vector<std::pair<uint64_t, uint64_t>> weighted;
+        weighted.reserve(placed.size());
+        for (auto const &p : placed)
+            weighted.emplace_back(p.key, p.vertices);
+        auto cuts = op::cutKeys(std::move(weighted), k);
+
+        PartitionManifest manifest{fc.datum, op::shardFiles(dir, opts.prefix, k)};
+        CollectionHeader header{opts.write.outputCrs, fc.datum, fc.heading, fc.global_properties, std::nullopt};
+        if (opts.write.quantum > 0.0)
+            header.quantization = makeQuantization(fc.datum, opts.write);
+        size_t group = std::max<size_t>(opts.maxOpenFiles, 1);
+        try {
+            for (size_t first = 0; first < k; first += group) {
+                size_t count = std::min(group, k - first);
+                auto writers = op::openShards(manifest, first, count, header, opts.write.outputCrs, mode);
+                for (size_t i = 0; i < fc.features.size(); ++i) {
+                    size_t s = op::shardOf(cuts, placed[i].key);
+                    if (s < first || s >= first + count)
+                        continue;
+                    writers[s - first]->write(fc.features[i]);
+                    auto &info = manifest.shards[s];
+                    ++info.features;
+                    info.vertices += placed[i].vertices;
+                    info.enu.expand(placed[i].enu);
+                    info.wgs.expand(op::wgsBox(placed[i].enu, fc.datum, mode));
+                }
+                for (auto &w : writers)
+                    w->close();
+            }
+            op::writeManifest(dir, manifest);
+        } catch (...) {
+            op::removeShards(manifest, dir);
+            throw;
+        }
+        return manifest;
+    }
+
+    /// Same as above for a GeoJSON file too large to load: a first streaming pass keeps one 16-byte
+    /// (key, weight) record per feature to choose the cuts, a second copies every feature's JSON into its
+    /// shard (one such pass per group of opts.maxOpenFiles shards), so memory does not hold any features.
+    /// Shards keep the input's header, CRS and encoding. On error the shard files written so far are removed.
+    inline PartitionManifest partition(const std::filesystem::path &file, size_t k, const std::filesystem::path &dir,
+                                       PartitionOptions const &opts = {}) {
+        GEOSON_TRACE_SCOPE("partition");
+        op::checkShardCount(k);
+        FeatureReader reader(file, opts.read);
+        CollectionHeader const &header = reader.header();
+        auto mode = opts.read.conversion;
+        Executor &executor = opts.executor ? *opts.executor : defaultExecutor();
+
+        // pass 1: keys and weights, over byte-range shards of the file in parallel
+        std::vector<uint64_t> cuts;
+        {
+            auto ranges = reader.shards(executor.concurrency());
+            std::vector<std::vector<std::pair<uint64_t, uint64_t>>> partial(ranges.empty() ? 0 : ranges.size() - 1);
+            op::parallelFor(&executor, partial.size(), 1, [&](size_t r, size_t, size_t) {
+                GEOSON_TRACE_SCOPE("partition/place");
+                FeatureReader range(file, header, ranges[r], ranges[r + 1], opts.read);
+                std::vector<Feature> parts;
+                while (range.next(parts)) {
+                    auto p = op::place(parts, header.datum, mode);
+                    partial[r].emplace_back(p.key, p.vertices);
+                }
+            });
+            std::vector<std::pair<uint64_t, uint64_t>> weighted;
+            for (auto &p : partial) {
+                weighted.insert(weighted.end(), p.begin(), p.end());
+                std::vector<std::pair<uint64_t, uint64_t>>().swap(p);
+            }
+            cuts = op::cutKeys(std::move(weighted), k);
+        }
+
+        // pass 2: the caller reads batches and writes them out in order; placing runs on the executor
+        std::filesystem::create_directories(dir);
+        PartitionManifest manifest{header.datum, op::shardFiles(dir, opts.prefix, k)};
+        struct Routed {
+            size_t shard;
+            op::Placement place;
+            BoundingBox wgs;
+            std::string text;
+        };
+        std::deque<op::Job<std::vector<Routed>>> inflight;
+        size_t group = std::max<size_t>(opts.maxOpenFiles, 1);
+        try {
+            for (size_t first = 0; first < k; first += group) {
+                size_t count = std::min(group, k - first);
+                // the first group continues the reader of pass 1; every further one reads the file again
+                std::optional<FeatureReader> again;
+                if (first > 0)
+                    again.emplace(file, opts.read);
+                FeatureReader &source = again ? *again : reader;
+                auto writers = op::openShards(manifest, first, count, header, header.crs, mode);
+                auto writeOldest = [&] {
+                    auto batch = inflight.front().get();
+                    inflight.pop_front();
+                    GEOSON_TRACE_SCOPE("partition/write");
+                    for (auto const &r : batch) {
+                        writers[r.shard - first]->writeJson(r.text);
+                        auto &info = manifest.shards[r.shard];
+                        ++info.features;
+                        info.vertices += r.place.vertices;
+                        info.enu.expand(r.place.enu);
+                        info.wgs.expand(r.wgs);
+                    }
+                };
+                bool more = true;
+                while (more) {
+                    std::vector<nlohmann::json> batch;
+                    batch.reserve(op::kFeatureChunk);
+                    nlohmann::json feat;
+                    while (batch.size() < op::kFeatureChunk && source.nextJson(feat))
+                        batch.push_back(std::move(feat));
+                    more = batch.size() == op::kFeatureChunk;
+                    if (batch.empty())
+                        break;
+                    if (inflight.size() == 4)
+                        writeOldest();
+                    inflight.emplace_back(&executor, [&header, &cuts, &opts, mode, first, count,
+                                                      batch = std::move(batch)] {
+                        GEOSON_TRACE_SCOPE("partition/route");
+                        std::vector<Routed> routed;
+                        routed.reserve(batch.size());
+                        std::vector<Feature> parts;
+                        for (auto const &raw : batch) {
+                            parts.clear();
+                            parseFeature(raw, header, parts, opts.read);
+                            auto p = op::place(parts, header.datum, mode);
+                            size_t shard = op::shardOf(cuts, p.key);
+                            if (shard >= first && shard < first + count) // other groups have their own pass
+                                routed.push_back({shard, p, op::wgsBox(p.enu, header.datum, mode), raw.dump()});
+                        }
+                        return routed;
+                    });
+                }
+                while (!inflight.empty())
+                    writeOldest();
+                for (auto &w : writers)
+                    w->close();
+            }
+            op::writeManifest(dir, manifest);
+        } catch (...) {
+            // the jobs refer to this frame: let them finish before unwinding
+            for (auto &job : inflight) {
+                try {
+                    job.get();
+                } catch (...) {
+                }
+            }
+            op::removeShards(manifest, dir);
+            throw;
+        }
+        return manifest;
+    }
+
+} // namespace geoson
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "geoson/executor.hpp"
+#include "geoson/json.hpp"
+#include "geoson/projection.hpp"
+#include "geoson/simplify.hpp"
+#include "geoson/stream.hpp"
+#include "geoson/trace.hpp"
+
+// Fused, streaming feature transforms. A pipeline records its stages and runs them only when given a
+// sink: features are streamed from the source in batches, every batch goes through all stages (and, for a
+// file sink, serialization) as one task on the executor, and finished batches are emitted in source order.
+// Memory stays at a few batches, and no stage materializes a copy of the collection.
+
+namespace geoson {
+
+    class Pipeline {
+      public:
+        /// per-feature stage: transforms the feature in place, returns false to drop it
+        using Stage = std::function<bool(Feature &)>;
+
+        explicit Pipeline(std::filesystem::path source, ReadOptions opts = {})
+            : source_(std::move(source)), read_(opts) {}
+
+        /// keep the features for which pred(feature) holds; `pred` must be safe to call concurrently, as
+        /// batches run in parallel on the executor
+        Pipeline &filter(std::function<bool(Feature const &)> pred) {
+            builders_.push_back([pred = std::move(pred)](concord::Datum &) -> Stage {
+                return [pred](Feature &f) { return pred(f); };
+            });
+            return *this;
+        }
+
+        /// apply fn to every feature (geometry in the datum in effect at this point of the pipeline); `fn` must
+        /// be safe to call concurrently
+        Pipeline &map(std::function<void(Feature &)> fn) {
+            builders_.push_back([fn = std::move(fn)](concord::Datum &) -> Stage {
+                return [fn](Feature &f) {
+                    fn(f);
+                    return true;
+                };
+            });
+            return *this;
+        }
+
+        /// re-anchor coordinates around `datum` from here on; the output is written around it
+        Pipeline &rebase(concord::Datum const &datum) {
+            builders_.push_back([datum, mode = read_.conversion](concord::Datum &current) -> Stage {
+                auto shift = std::make_shared<op::DatumShift>(current, datum, mode);
+                current = datum;
+                return [shift](Feature &f) {
+                    f.geometry = mapVertices(f.geometry, *shift);
+                    return true;
+                };
+            });
+            return *this;
+        }
+
+        /// Douglas-Peucker simplification of every LineString and ring (metres)
+        Pipeline &simplify(double tolerance) {
+            builders_.push_back([tolerance](concord::Datum &) -> Stage {
+                return [tolerance](Feature &f) {
+                    f.geometry = geoson::simplify(f.geometry, tolerance);
+                    return true;
+                };
+            });
+            return *this;
+        }
+
+        /// run batches on `executor` (null: defaultExecutor())
+        Pipeline &on(Executor *executor) {
+            executor_ = executor;
+            return *this;
+        }
+
+        /// features per task and tasks in flight; together they bound memory
+        Pipeline &batching(size_t batchSize, size_t inFlight = 4) {
+            batchSize_ = batchSize ? batchSize : 1;
+            inFlight_ = inFlight ? inFlight : 1;
+            return *this;
+        }
+
+        /// Run the pipeline into a GeoJSON file, one feature per line. opts.outputCrs, quantum and conversion
+        /// apply; `pretty` does not. Returns the number of features written; on error the partial file is
+        /// removed.
+        uint64_t sink(const std::filesystem::path &out, WriteOptions const &opts = {}) {
+            GEOSON_TRACE_SCOPE("pipeline");
+            FeatureReader reader(source_, read_);
+            CollectionHeader header = reader.header();
+            auto stages = build(header.datum);
+            header.crs = opts.outputCrs;
+            header.quantization.reset();
+            if (opts.quantum > 0.0)
+                header.quantization = makeQuantization(header.datum, opts);
+            std::optional<FeatureWriter> writer(std::in_place, out, header, opts.outputCrs, opts.conversion);
+
+            auto const datum = header.datum;
+            auto const quant = header.quantization;
+            try {
+                run<std::vector<std::string>>(
+                    reader, stages,
+                    [&, datum, quant](std::vector<Feature> &features) {
+                        GEOSON_TRACE_SCOPE("pipeline/serialize");
+                        std::vector<std::string> text;
+                        text.reserve(features.size());
+                        for (auto const &f : features)
+                            text.push_back(
+                                featureToJson(f, datum, opts.outputCrs, quant ? &*quant : nullptr, opts.conversion)
+                                    .dump());
+                        return text;
+                    },
+                    [&](std::vector<std::string> &text) {
+                        for (auto const &feat : text)
+                            writer->writeJson(feat);
+                    });
+                writer->close();
+            } catch (...) {
+                writer.reset();
+                std::error_code ec;
+                std::filesystem::remove(out, ec);
+                throw;
+            }
+            return writer->count();
+        }
+
+        /// Run the pipeline into fn(Feature &), called on the calling thread in source order. Returns the
+        /// number of features passed to fn.
+        uint64_t sink(std::function<void(Feature &)> fn) {
+            GEOSON_TRACE_SCOPE("pipeline");
+            FeatureReader reader(source_, read_);
+            concord::Datum datum = reader.header().datum;
+            auto stages = build(datum);
+            uint64_t count = 0;
+            run<std::vector<Feature>>(
+                reader, stages, [](std::vector<Feature> &features) { return std::move(features); },
+                [&](std::vector<Feature> &features) {
+                    for (auto &f : features)
+                        fn(f);
+                    count += features.size();
+                });
+            return count;
+        }
+
+      private:
+        using Builder = std::function<Stage(concord::Datum &)>;
+
+        /// instantiate the stages for a source around `datum`, leaving `datum` at the output's
+        std::vector<Stage> build(concord::Datum &datum) const {
+            std::vector<Stage> stages;
+            stages.reserve(builders_.size());
+            for (auto const &b : builders_)
+                stages.push_back(b(datum));
+            return stages;
+        }
+
+        /// the calling thread reads raw batches and consumes finished ones in order; decoding, the stages
+        /// and finish() run as one job per batch on the executor
+        template <typename Out, typename Finish, typename Consume>
+        void run(FeatureReader &reader, std::vector<Stage> const &stages, Finish finish, Consume consume) {
+            CollectionHeader const &header = reader.header();
+            ReadOptions const &read = read_;
+            std::deque<op::Job<Out>> inflight;
+            auto consumeOldest = [&] {
+                Out out = inflight.front().get();
+                inflight.pop_front();
+                consume(out);
+            };
+            try {
+                bool more = true;
+                while (more) {
+                    std::vector<nlohmann::json> batch;
+                    batch.reserve(batchSize_);
+                    {
+                        GEOSON_TRACE_SCOPE("pipeline/read");
+                        nlohmann::json feat;
+                        while (batch.size() < batchSize_ && reader.nextJson(feat))
+                            batch.push_back(std::move(feat));
+                    }
+                    more = batch.size() == batchSize_;
+                    if (batch.empty())
+                        break;
+                    if (inflight.size() == inFlight_)
+                        consumeOldest();
+                    inflight.emplace_back(executor_, [&header, &read, &stages, &finish,
+                                                      batch = std::move(batch)]() -> Out {
+                        GEOSON_TRACE_SCOPE("pipeline/stages");
+                        std::vector<Feature> features, parsed;
+                        for (auto const &raw : batch) {
+                            parsed.clear();
+                            parseFeature(raw, header, parsed, read);
+                            for (auto &f : parsed) {
+                                bool keep = true;
+                                for (auto const &stage : stages)
+                                    if (!(keep = stage(f)))
+                                        break;
+                                if (keep)
+                                    features.push_back(std::move(f));
+                            }
+                        }
+                        return finish(features);
+                    });
+                }
+                while (!inflight.empty())
+                    consumeOldest();
+            } catch (...) {
+                // the jobs refer to this frame: let them finish before unwinding
+                for (auto &job : inflight) {
+                    try {
+                        job.get();
+                    } catch (...) {
+                    }
+                }
+                throw;
+            }
+        }
+
+        std::filesystem::path source_;
+        ReadOptions read_;
+        std::vector<Builder> builders_;
+        Executor *executor_ = nullptr;
+        size_t batchSize_ = 256;
+        size_t inFlight_ = 4;
+    };
+
+    /// start a pipeline reading `source`
+    inline Pipeline pipeline(std::filesystem::path source, ReadOptions opts = {}) {
+        return Pipeline(std::move(source), opts);
+    }
+
+} // namespace geoson
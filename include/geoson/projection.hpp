@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <optional>
+
+#include "concord/concord.hpp"
+#include "geoson/geometry.hpp"
+
+// Fast WGS ↔ ENU conversion for field-scale data. The exact conversion goes through ECEF and costs a
+// dozen transcendental calls per vertex (plus an iteration back to geodetic); around a fixed datum the
+// same mapping is well approximated by its second-order Taylor series, whose coefficients depend on the
+// datum only. Evaluated per vertex that is a handful of multiply-adds.
+
+namespace geoson {
+
+    /// how WGS ↔ ENU conversions are evaluated
+    enum class ConversionMode {
+        Exact,       // full ellipsoidal conversion through ECEF
+        LocalTangent // second-order series around the datum, exact beyond LocalTangentPlane::radius()
+    };
+
+    /// second-order expansion of the WGS84 geodetic ↔ ENU mapping around a datum
+    class LocalTangentPlane {
+      public:
+        /// horizontal distance from the datum (metres) up to which the series is used by default; the
+        /// a-priori error there is about a millimetre at mid latitudes
+        static constexpr double kDefaultRadius = 3000.0;
+
+        explicit LocalTangentPlane(concord::Datum const &datum, double radius = kDefaultRadius)
+            : datum_(datum), radius2_(radius * radius) {
+            double phi = datum.lat * kDegToRad;
+            sin_ = std::sin(phi);
+            cos_ = std::cos(phi);
+            double w2 = 1.0 - kE2 * sin_ * sin_;
+            double w = std::sqrt(w2);
+            double n = kA / w;                      // prime vertical radius of curvature
+            double m = kA * (1.0 - kE2) / (w2 * w); // meridian radius of curvature
+            mh_ = m + datum.alt;
+            nh_ = n + datum.alt;
+            dm_ = 3.0 * m * kE2 * sin_ * cos_ / w2; // dM/dphi
+        }
+
+        concord::Datum const &datum() const { return datum_; }
+        double radius() const { return std::sqrt(radius2_); }
+
+        /// A-priori bound (metres) on the error of the series for a point `distance` metres from the
+        /// datum, horizontally, within a few hundred metres of its altitude. The truncated terms are third
+        /// order in distance / earth radius and grow towards the poles as 1 / cos²(lat); the constant term
+        /// covers floating-point rounding.
+        double errorBound(double distance) const {
+            double d = std::abs(distance) / kA;
+            return 0.5 * kA * d * d * d / (cos_ * cos_) + 1e-6;
+        }
+
+        /// worst-case error of converting points up to `distance` away: the series inside radius(),
+        /// exact conversion beyond
+        double maxError(double distance) const { return errorBound(std::min(std::abs(distance), radius())); }
+
+        /// geodetic (degrees, metres) → local x (east), y (north), z (up)
+        std::array<double, 3> toENU(double lat, double lon, double alt) const {
+            double dphi = (lat - datum_.lat) * kDegToRad;
+            double dlon = lon - datum_.lon;
+            if (dlon > 180.0)
+                dlon -= 360.0;
+            else if (dlon < -180.0)
+                dlon += 360.0;
+            double dlam = dlon * kDegToRad;
+            double dh = alt - datum_.alt;
+            double x = nh_ * cos_ * dlam;
+            double y = mh_ * dphi;
+            if (x * x + y * y > radius2_) {
+                auto enu = concord::WGS{lat, lon, alt}.toENU(datum_);
+                return {enu.x, enu.y, enu.z};
+            }
+            return {x + (cos_ * dh - mh_ * sin_ * dphi) * dlam,
+                    y + (0.5 * dm_ * dphi + dh) * dphi + 0.5 * nh_ * sin_ * cos_ * dlam * dlam,
+                    dh - 0.5 * (mh_ * dphi * dphi + nh_ * cos_ * cos_ * dlam * dlam)};
+        }
+
+        /// local x, y, z → geodetic {lat, lon, alt} (degrees, metres)
+        std::array<double, 3> toWGS(double x, double y, double z) const {
+            if (x * x + y * y > radius2_) {
+                auto wgs = concord::ENU{concord::Point{x, y, z}, datum_}.toWGS();
+                return {wgs.lat, wgs.lon, wgs.alt};
+            }
+            // first-order inverse, then one substitution into the second-order terms
+            double dlam = x / (nh_ * cos_);
+            double dphi = y / mh_;
+            double dh = z;
+            double dh2 = z + 0.5 * (mh_ * dphi * dphi + nh_ * cos_ * cos_ * dlam * dlam);
+            double dphi2 = (y - (0.5 * dm_ * dphi + dh) * dphi - 0.5 * nh_ * sin_ * cos_ * dlam * dlam) / mh_;
+            double dlam2 = (x - (cos_ * dh - mh_ * sin_ * dphi) * dlam) / (nh_ * cos_);
+            return {datum_.lat + dphi2 / kDegToRad, datum_.lon + dlam2 / kDegToRad, datum_.alt + dh2};
+        }
+
+        bool sameDatum(concord::Datum const &d) const {
+            return d.lat == datum_.lat && d.lon == datum_.lon && d.alt == datum_.alt;
+        }
+
+      private:
+        static constexpr double kA = 6378137.0;
+        static constexpr double kF = 1.0 / 298.257223563;
+        static constexpr double kE2 = kF * (2.0 - kF);
+        static constexpr double kDegToRad = std::numbers::pi / 180.0;
+
+        concord::Datum datum_;
+        double radius2_;
+        double sin_ = 0.0, cos_ = 1.0;
+        double mh_ = 0.0, nh_ = 0.0, dm_ = 0.0;
+    };
+
+    namespace op {
+        inline bool sameDatum(concord::Datum const &a, concord::Datum const &b) {
+            return a.lat == b.lat && a.lon == b.lon && a.alt == b.alt;
+        }
+
+        /// the plane of the last datum converted on this thread; rebuilt only when the datum changes, so
+        /// per-vertex callers need not hold on to one
+        inline LocalTangentPlane const &tangentPlane(concord::Datum const &datum) {
+            thread_local LocalTangentPlane plane{datum};
+            if (!plane.sameDatum(datum))
+                plane = LocalTangentPlane{datum};
+            return plane;
+        }
+    } // namespace op
+
+    /// geodetic → ENU with the chosen mode
+    inline std::array<double, 3> toENU(double lat, double lon, double alt, concord::Datum const &datum,
+                                       ConversionMode mode) {
+        if (mode == ConversionMode::LocalTangent)
+            return op::tangentPlane(datum).toENU(lat, lon, alt);
+        auto enu = concord::WGS{lat, lon, alt}.toENU(datum);
+        return {enu.x, enu.y, enu.z};
+    }
+
+    /// ENU → geodetic {lat, lon, alt} with the chosen mode
+    inline std::array<double, 3> toWGS(double x, double y, double z, concord::Datum const &datum,
+                                       ConversionMode mode) {
+        if (mode == ConversionMode::LocalTangent)
+            return op::tangentPlane(datum).toWGS(x, y, z);
+        auto wgs = concord::ENU{concord::Point{x, y, z}, datum}.toWGS();
+        return {wgs.lat, wgs.lon, wgs.alt};
+    }
+
+    /// A-priori error (metres) of converting `fc` between WGS and ENU with `mode`, from its extent: zero
+    /// for exact conversion, otherwise the series bound at the vertex farthest from the datum
+    inline double conversionErrorBound(FeatureCollection const &fc, ConversionMode mode) {
+        if (mode == ConversionMode::Exact)
+            return 0.0;
+        double far2 = 0.0;
+        for (auto const &f : fc.features)
+            forEachVertex(f.geometry, [&](concord::Point const &p) { far2 = std::max(far2, p.x * p.x + p.y * p.y); });
+        return op::tangentPlane(fc.datum).maxError(std::sqrt(far2));
+    }
+
+    namespace op {
+        /// maps internal ENU points around one datum to the same ground positions around another
+        class DatumShift {
+          public:
+            DatumShift(concord::Datum const &from, concord::Datum const &to,
+                       ConversionMode mode = ConversionMode::Exact)
+                : from_(from), to_(to), identity_(sameDatum(from, to)) {
+                // one plane per side: the thread's cached plane would be rebuilt on every switch of datum
+                if (mode == ConversionMode::LocalTangent && !identity_) {
+                    fromPlane_.emplace(from);
+                    toPlane_.emplace(to);
+                }
+            }
+
+            bool identity() const { return identity_; }
+
+            concord::Point operator()(concord::Point const &p) const {
+                if (identity_)
+                    return p;
+                auto wgs = fromPlane_ ? fromPlane_->toWGS(p.x, p.y, p.z)
+                                      : toWGS(p.x, p.y, p.z, from_, ConversionMode::Exact);
+                auto enu = toPlane_ ? toPlane_->toENU(wgs[0], wgs[1], wgs[2])
+                                    : toENU(wgs[0], wgs[1], wgs[2], to_, ConversionMode::Exact);
+                return concord::Point{enu[0], enu[1], enu[2]};
+            }
+
+          private:
+            concord::Datum from_, to_;
+            bool identity_;
+            std::optional<LocalTangentPlane> fromPlane_, toPlane_;
+        };
+    } // namespace op
+
+    /// Re-anchor the ENU coordinates of `fc` around another datum; positions on the ground do not change
+    inline void rebase(FeatureCollection &fc, concord::Datum const &datum,
+                       ConversionMode mode = ConversionMode::Exact) {
+        op::DatumShift shift(fc.datum, datum, mode);
+        if (shift.identity())
+            return;
+        for (auto &f : fc.features)
+            f.geometry = mapVertices(f.geometry, shift);
+        fc.datum = datum;
+    }
+
+} // namespace geoson
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "geoson/executor.hpp"
+#include "geoson/geoson.hpp"
+#include "geoson/projection.hpp"
+#include "geoson/trace.hpp"
+
+// Loading a directory of per-field GeoJSON files. Every file is read and parsed as its own task on an
+// Executor, so with a pool of several threads one file's disk reads overlap another's parsing instead of
+// the whole set loading one file after the other.
+
+namespace geoson {
+
+    struct ReadAllOptions {
+        /// applied to every file
+        ReadOptions read;
+        /// where the files are read and parsed; null uses defaultExecutor()
+        Executor *executor = nullptr;
+        /// re-anchor every collection's ENU coordinates around this datum; unset keeps each file's own
+        std::optional<concord::Datum> datum;
+        /// readAllMerged(): property set on every feature to the stem of the file it came from; empty sets none
+        std::string sourceProperty;
+    };
+
+    namespace op {
+        /// the .geojson / .json files directly inside `dir`, sorted by name
+        inline std::vector<std::filesystem::path> geojsonFiles(const std::filesystem::path &dir) {
+            if (!std::filesystem::is_directory(dir))
+                throw std::runtime_error("geoson::readAll(): not a directory: " + dir.string());
+            std::vector<std::filesystem::path> files;
+            for (auto const &entry : std::filesystem::directory_iterator(dir)) {
+                auto ext = entry.path().extension();
+                if (entry.is_regular_file() && (ext == ".geojson" || ext == ".json"))
+                    files.push_back(entry.path());
+            }
+            std::sort(files.begin(), files.end());
+            return files;
+        }
+    } // namespace op
+
+    /// Read several files concurrently; the result holds one collection per file, in the order given. A
+    /// failure names the file it happened in.
+    inline std::vector<FeatureCollection> readAll(std::vector<std::filesystem::path> const &files,
+                                                  ReadAllOptions const &opts = {}) {
+        GEOSON_TRACE_SCOPE("readAll");
+        std::vector<FeatureCollection> out(files.size());
+        Executor &executor = opts.executor ? *opts.executor : defaultExecutor();
+        op::parallelFor(&executor, files.size(), 1, [&](size_t i, size_t, size_t) {
+            GEOSON_TRACE_SCOPE("readAll/file");
+            try {
+                out[i] = read(files[i], opts.read);
+                if (opts.datum)
+                    rebase(out[i], *opts.datum, opts.read.conversion);
+            } catch (std::exception const &e) {
+                throw std::runtime_error("geoson::readAll(): " + files[i].string() + ": " + e.what());
+            }
+        });
+        return out;
+    }
+
+    /// every .geojson / .json file directly inside `dir`, in name order
+    inline std::vector<FeatureCollection> readAll(const std::filesystem::path &dir, ReadAllOptions const &opts = {}) {
+        return readAll(op::geojsonFiles(dir), opts);
+    }
+
+    /// Read several files concurrently into one collection around opts.datum (default: the first file's),
+    /// with the heading and global properties of the first file. Feature order follows the file order.
+    inline FeatureCollection readAllMerged(std::vector<std::filesystem::path> const &files,
+                                           ReadAllOptions const &opts = {}) {
+        auto parts = readAll(files, opts);
+        if (parts.empty())
+            return {};
+
+        FeatureCollection merged{parts[0].datum, parts[0].heading, {}, parts[0].global_properties};
+        if (!opts.datum) {
+            Executor &executor = opts.executor ? *opts.executor : defaultExecutor();
+            op::parallelFor(&executor, parts.size(), 1, [&](size_t i, size_t, size_t) {
+                rebase(parts[i], merged.datum, opts.read.conversion);
+            });
+        }
+        size_t total = 0;
+        for (auto const &part : parts)
+            total += part.features.size();
+        merged.features.reserve(total);
+        for (size_t i = 0; i < parts.size(); ++i) {
+            auto stem = files[i].stem().string();
+            for (auto &f : parts[i].features) {
+                if (!opts.sourceProperty.empty())
+                    f.properties[opts.sourceProperty] = stem;
+                merged.features.push_back(std::move(f));
+            }
+        }
+        return merged;
+    }
+
+    inline FeatureCollection readAllMerged(const std::filesystem::path &dir, ReadAllOptions const &opts = {}) {
+        return readAllMerged(op::geojsonFiles(dir), opts);
+    }
+
+} // namespace geoson
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geoson/geometry.hpp"
+#include "geoson/vector.hpp"
+
+// Compact binary encoding of Elements and Vector headers, shared by the persistent store (geoson/store.hpp)
+// and the mutation journal (geoson/journal.hpp). Records are not meant to be portable across byte orders.
+
+namespace geoson {
+
+    namespace op {
+        /// append-only binary encoding of records (native byte order)
+        struct RecordEncoder {
+            std::string out;
+
+            template <typename T> void put(T v) { out.append(reinterpret_cast<const char *>(&v), sizeof v); }
+            void putString(std::string const &s) {
+                put(static_cast<uint32_t>(s.size()));
+                out += s;
+            }
+            void putPoints(std::vector<concord::Point> const &pts) {
+                put(static_cast<uint32_t>(pts.size()));
+                for (auto const &p : pts) {
+                    put(p.x);
+                    put(p.y);
+                    put(p.z);
+                }
+            }
+            void putProperties(std::unordered_map<std::string, std::string> const &props) {
+                put(static_cast<uint32_t>(props.size()));
+                for (auto const &[key, value] : props) {
+                    putString(key);
+                    putString(value);
+                }
+            }
+        };
+
+        struct RecordDecoder {
+            const char *p;
+            const char *end;
+
+            void need(size_t n) const {
+                if (static_cast<size_t>(end - p) < n)
+                    throw std::runtime_error("geoson: truncated binary record");
+            }
+            template <typename T> T get() {
+                need(sizeof(T));
+                T v;
+                std::memcpy(&v, p, sizeof v);
+                p += sizeof v;
+                return v;
+            }
+            std::string getString() {
+                auto n = get<uint32_t>();
+                need(n);
+                std::string s(p, n);
+                p += n;
+                return s;
+            }
+            std::vector<concord::Point> getPoints() {
+                auto n = get<uint32_t>();
+                need(size_t(n) * 3 * sizeof(double));
+                std::vector<concord::Point> pts;
+                pts.reserve(n);
+                for (uint32_t i = 0; i < n; ++i) {
+                    double x = get<double>(), y = get<double>(), z = get<double>();
+                    pts.emplace_back(x, y, z);
+                }
+                return pts;
+            }
+            std::unordered_map<std::string, std::string> getProperties() {
+                auto n = get<uint32_t>();
+                std::unordered_map<std::string, std::string> props;
+                props.reserve(n);
+                for (uint32_t i = 0; i < n; ++i) {
+                    auto key = getString();
+                    props[std::move(key)] = getString();
+                }
+                return props;
+            }
+        };
+
+        inline std::string encodeElement(Element const &e) {
+            RecordEncoder enc;
+            enc.put(static_cast<uint32_t>(e.geometry.index()));
+            enc.putPoints(vertices(e.geometry));
+            enc.putString(e.type);
+            enc.putProperties(e.properties);
+            return std::move(enc.out);
+        }
+
+        inline Element decodeElement(std::string_view record) {
+            RecordDecoder dec{record.data(), record.data() + record.size()};
+            auto kind = dec.get<uint32_t>();
+            auto pts = dec.getPoints();
+            Geometry geom;
+            if (kind == 0 && pts.size() == 1)
+                geom = pts[0];
+            else if (kind == 1 && pts.size() == 2)
+                geom = concord::Line{pts[0], pts[1]};
+            else if (kind == 2)
+                geom = concord::Path{pts};
+            else if (kind == 3)
+                geom = concord::Polygon{pts};
+            else
+                throw std::runtime_error("geoson: bad geometry record");
+            auto type = dec.getString();
+            return Element(geom, dec.getProperties(), type);
+        }
+
+        /// everything of a Vector but its elements
+        inline std::string encodeVectorHeader(Vector const &v) {
+            RecordEncoder enc;
+            enc.put(v.getDatum().lat);
+            enc.put(v.getDatum().lon);
+            enc.put(v.getDatum().alt);
+            enc.put(v.getHeading().roll);
+            enc.put(v.getHeading().pitch);
+            enc.put(v.getHeading().yaw);
+            enc.put(static_cast<uint32_t>(v.getCRS()));
+            enc.putPoints(v.getFieldBoundary().getPoints());
+            enc.putProperties(v.getFieldProperties());
+            enc.putProperties(v.getGlobalProperties());
+            return std::move(enc.out);
+        }
+
+        inline Vector decodeVectorHeader(std::string_view record) {
+            RecordDecoder dec{record.data(), record.data() + record.size()};
+            concord::Datum datum;
+            datum.lat = dec.get<double>();
+            datum.lon = dec.get<double>();
+            datum.alt = dec.get<double>();
+            concord::Euler heading;
+            heading.roll = dec.get<double>();
+            heading.pitch = dec.get<double>();
+            heading.yaw = dec.get<double>();
+            auto crs = static_cast<CRS>(dec.get<uint32_t>());
+            Vector v(concord::Polygon{dec.getPoints()}, datum, heading, crs);
+            for (auto const &[key, value] : dec.getProperties())
+                v.setFieldProperty(key, value);
+            for (auto const &[key, value] : dec.getProperties())
+                v.setGlobalProperty(key, value);
+            return v;
+        }
+    } // namespace op
+
+} // namespace geoson
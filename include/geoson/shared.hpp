@@ -0,0 +1,517 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "geoson/geometry.hpp"
+#include "geoson/vector.hpp"
+
+// Publishing a Vector to other processes on the same machine through POSIX shared memory. The publisher
+// lays a snapshot out in one segment per version, pointer-free (every reference is an offset from the
+// segment start), then bumps a generation counter in a small control segment. Readers map the current
+// version read-only and query it in place through a VectorView; a view keeps its version mapped for as long
+// as it lives, so publishing never disturbs a reader, which switches to the new version by opening a new view.
+//
+// Segments: "/<name>" holds the control block, "/<name>.<generation>" the snapshots. Layout (native byte
+// order): SharedHeader, then the element table, property table, coordinates and string pool.
+
+namespace geoson {
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    namespace op {
+        inline constexpr uint64_t kSharedMagic = 0x5348'4e4f'5345'4547ull; // "GEOSONSH"
+        inline constexpr uint32_t kSharedVersion = 1;
+
+        struct SharedControl {
+            uint64_t magic;
+            uint32_t version;
+            std::atomic<uint32_t> retired;    // set when the publisher goes away: its views are all stale
+            std::atomic<uint64_t> generation; // 0: nothing published yet
+        };
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                      "the control block must be address-free");
+
+        struct SharedString {
+            uint64_t offset; // into the string pool
+            uint64_t length;
+        };
+
+        struct SharedRange {
+            uint64_t first;
+            uint64_t count;
+        };
+
+        struct SharedProperty {
+            SharedString key;
+            SharedString value;
+        };
+
+        struct SharedElement {
+            uint32_t kind; // Geometry::index()
+            uint32_t reserved;
+            SharedRange points;
+            SharedRange properties;
+            SharedString type;
+        };
+
+        struct SharedHeader {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t crs;
+            uint64_t generation;
+            uint64_t bytes; // whole segment
+            double datum[3];
+            double heading[3]; // roll, pitch, yaw
+            SharedRange boundary;
+            SharedRange fieldProperties;
+            SharedRange globalProperties;
+            SharedRange elements;   // byte offset of the element table, element count
+            SharedRange properties; // byte offset of the property table, entry count
+            SharedRange points;     // byte offset of the coordinates, point count
+            SharedRange strings;    // byte offset of the string pool, byte count
+        };
+
+        inline std::string segmentName(std::string const &name) { return name.starts_with('/') ? name : '/' + name; }
+
+        inline std::string snapshotName(std::string const &name, uint64_t generation) {
+            return segmentName(name) + '.' + std::to_string(generation);
+        }
+
+        /// a read-only or read-write mapping of a whole shared-memory segment
+        class SharedMapping {
+          public:
+            SharedMapping() = default;
+            SharedMapping(SharedMapping &&o) noexcept
+                : data_(std::exchange(o.data_, nullptr)), size_(std::exchange(o.size_, 0)) {}
+            SharedMapping &operator=(SharedMapping &&o) noexcept {
+                std::swap(data_, o.data_);
+                std::swap(size_, o.size_);
+                return *this;
+            }
+            ~SharedMapping() {
+                if (data_)
+                    ::munmap(data_, size_);
+            }
+
+            /// map segment `name` read-only (read-write with `writable`); with `create`, replace it by a new
+            /// read-write one of `size` bytes (a fresh object: processes still mapping a previous one keep it
+            /// intact)
+            static std::optional<SharedMapping> open(std::string const &name, bool create, size_t size = 0,
+                                                     bool writable = false) {
+                if (create)
+                    ::shm_unlink(name.c_str());
+                writable = writable || create;
+                int fd = create ? ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644)
+                                : ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+                if (fd < 0) {
+                    if (!create && errno == ENOENT)
+                        return std::nullopt;
+                    throw std::runtime_error("geoson: cannot open shared memory " + name + ": " +
+                                             std::strerror(errno));
+                }
+                struct stat st;
+                bool ok = create ? ::ftruncate(fd, static_cast<off_t>(size)) == 0 : ::fstat(fd, &st) == 0;
+                if (ok && !create)
+                    size = static_cast<size_t>(st.st_size);
+                int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+                void *p = ok && size ? ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0) : MAP_FAILED;
+                int err = errno;
+                ::close(fd);
+                if (p == MAP_FAILED)
+                    throw std::runtime_error("geoson: cannot map shared memory " + name + ": " + std::strerror(err));
+                SharedMapping m;
+                m.data_ = static_cast<char *>(p);
+                m.size_ = size;
+                return m;
+            }
+
+            char *data() const { return data_; }
+            size_t size() const { return size_; }
+
+          private:
+            char *data_ = nullptr;
+            size_t size_ = 0;
+        };
+
+        /// the sections of a snapshot, built in memory before being copied into its segment
+        class SharedLayout {
+          public:
+            explicit SharedLayout(Vector const &v) {
+                header_.boundary = addPoints(v.getFieldBoundary().getPoints());
+                header_.fieldProperties = addProperties(v.getFieldProperties());
+                header_.globalProperties = addProperties(v.getGlobalProperties());
+                elements_.reserve(v.elementCount());
+                for (auto const &e : v) {
+                    SharedElement se{};
+                    se.kind = static_cast<uint32_t>(e.geometry.index());
+                    se.points = addPoints(vertices(e.geometry));
+                    se.properties = addProperties(e.properties);
+                    se.type = intern(e.type);
+                    elements_.push_back(se);
+                }
+                header_.magic = kSharedMagic;
+                header_.version = kSharedVersion;
+                header_.crs = static_cast<uint32_t>(v.getCRS());
+                auto const &d = v.getDatum();
+                auto const &h = v.getHeading();
+                header_.datum[0] = d.lat;
+                header_.datum[1] = d.lon;
+                header_.datum[2] = d.alt;
+                header_.heading[0] = h.roll;
+                header_.heading[1] = h.pitch;
+                header_.heading[2] = h.yaw;
+
+                uint64_t at = sizeof(SharedHeader);
+                auto section = [&](size_t count, size_t unit) {
+                    SharedRange r{at, count};
+                    at += (count * unit + 7) & ~uint64_t(7);
+                    return r;
+                };
+                header_.elements = section(elements_.size(), sizeof(SharedElement));
+                header_.properties = section(properties_.size(), sizeof(SharedProperty));
+                header_.points = section(points_.size() / 3, 3 * sizeof(double));
+                header_.strings = section(strings_.size(), 1);
+                header_.bytes = std::max<uint64_t>(at, 8);
+            }
+
+            uint64_t bytes() const { return header_.bytes; }
+
+            void write(char *base, uint64_t generation) const {
+                SharedHeader h = header_;
+                h.generation = generation;
+                std::memcpy(base, &h, sizeof h);
+                std::memcpy(base + h.elements.first, elements_.data(), elements_.size() * sizeof(SharedElement));
+                std::memcpy(base + h.properties.first, properties_.data(),
+                            properties_.size() * sizeof(SharedProperty));
+                std::memcpy(base + h.points.first, points_.data(), points_.size() * sizeof(double));
+                std::memcpy(base + h.strings.first, strings_.data(), strings_.size());
+            }
+
+          private:
+            SharedRange addPoints(std::vector<concord::Point> const &pts) {
+                SharedRange r{points_.size() / 3, pts.size()};
+                for (auto const &p : pts)
+                    points_.insert(points_.end(), {p.x, p.y, p.z});
+                return r;
+            }
+
+            SharedRange addProperties(std::unordered_map<std::string, std::string> const &props) {
+                SharedRange r{properties_.size(), props.size()};
+                for (auto const &[key, value] : props)
+                    properties_.push_back({intern(key), intern(value)});
+                return r;
+            }
+
+            /// keys and type names repeat across elements: store each distinct string once
+            SharedString intern(std::string const &s) {
+                auto [it, inserted] = interned_.try_emplace(s, SharedString{strings_.size(), s.size()});
+                if (inserted)
+                    strings_ += s;
+                return it->second;
+            }
+
+            SharedHeader header_{};
+            std::vector<SharedElement> elements_;
+            std::vector<SharedProperty> properties_;
+            std::vector<double> points_;
+            std::string strings_;
+            std::unordered_map<std::string, SharedString> interned_;
+        };
+    } // namespace op
+
+    /// a vertex as stored in shared memory
+    struct SharedPoint {
+        double x, y, z;
+    };
+    static_assert(sizeof(SharedPoint) == 3 * sizeof(double));
+
+    /// Read-only, zero-copy view of a Vector published with VectorPublisher. Accessors return spans and
+    /// string_views into the mapping, valid while the view lives.
+    class VectorView {
+      public:
+        /// one element of the view
+        class ElementRef {
+          public:
+            /// the Geometry alternative the element holds (0 Point, 1 Line, 2 Path, 3 Polygon)
+            size_t kind() const { return e_->kind; }
+            std::span<const SharedPoint> points() const { return view_->points(e_->points); }
+            std::string_view type() const { return view_->string(e_->type); }
+            std::optional<std::string_view> property(std::string_view key) const {
+                return view_->find(e_->properties, key);
+            }
+            /// fn(std::string_view key, std::string_view value) for each property
+            template <typename Fn> void forEachProperty(Fn &&fn) const { view_->forEach(e_->properties, fn); }
+
+            Geometry geometry() const {
+                std::vector<concord::Point> pts;
+                for (auto const &p : points())
+                    pts.emplace_back(p.x, p.y, p.z);
+                switch (e_->kind) {
+                case 0:
+                    return pts.at(0);
+                case 1:
+                    return concord::Line{pts.at(0), pts.at(1)};
+                case 2:
+                    return concord::Path{pts};
+                case 3:
+                    return concord::Polygon{pts};
+                }
+                throw std::runtime_error("geoson::VectorView(): bad geometry kind");
+            }
+
+            /// a copy as a regular Element
+            Element toElement() const {
+                std::unordered_map<std::string, std::string> props;
+                forEachProperty([&](std::string_view k, std::string_view v) { props.emplace(k, v); });
+                return Element(geometry(), props, std::string(type()));
+            }
+
+          private:
+            friend class VectorView;
+            ElementRef(VectorView const *view, op::SharedElement const *e) : view_(view), e_(e) {}
+            VectorView const *view_;
+            op::SharedElement const *e_;
+        };
+
+        /// map the latest version published under `name`; throws if none has been published
+        static VectorView open(std::string const &name) {
+            auto control = op::SharedMapping::open(op::segmentName(name), false);
+            if (!control || control->size() < sizeof(op::SharedControl))
+                throw std::runtime_error("geoson::VectorView(): nothing published as " + name);
+            auto const *c = reinterpret_cast<op::SharedControl const *>(control->data());
+            if (c->magic != op::kSharedMagic || c->version != op::kSharedVersion)
+                throw std::runtime_error("geoson::VectorView(): " + name + " is not a published vector");
+            // the publisher removes old versions: if ours vanished before we mapped it, take the next one
+            for (int attempt = 0; attempt < 16; ++attempt) {
+                uint64_t generation = c->generation.load(std::memory_order_acquire);
+                if (generation == 0)
+                    break;
+                if (auto data = op::SharedMapping::open(op::snapshotName(name, generation), false))
+                    return VectorView(std::move(*control), std::move(*data), generation);
+            }
+            throw std::runtime_error("geoson::VectorView(): nothing published as " + name);
+        }
+
+        uint64_t generation() const { return generation_; }
+        /// whether a newer version has been published since this view was opened, or its publisher is gone
+        /// (a new publisher under the same name starts a control segment this view does not see)
+        bool stale() const {
+            return control()->retired.load(std::memory_order_acquire) ||
+                   control()->generation.load(std::memory_order_acquire) != generation_;
+        }
+
+        size_t elementCount() const { return header()->elements.count; }
+        ElementRef element(size_t i) const {
+            if (i >= elementCount())
+                throw std::out_of_range("Element index out of range");
+            return ElementRef(this, elements() + i);
+        }
+
+        concord::Datum datum() const {
+            concord::Datum d;
+            d.lat = header()->datum[0];
+            d.lon = header()->datum[1];
+            d.alt = header()->datum[2];
+            return d;
+        }
+        concord::Euler heading() const {
+            concord::Euler h;
+            h.roll = header()->heading[0];
+            h.pitch = header()->heading[1];
+            h.yaw = header()->heading[2];
+            return h;
+        }
+        CRS crs() const { return static_cast<CRS>(header()->crs); }
+        std::span<const SharedPoint> fieldBoundary() const { return points(header()->boundary); }
+        std::optional<std::string_view> fieldProperty(std::string_view key) const {
+            return find(header()->fieldProperties, key);
+        }
+        std::optional<std::string_view> globalProperty(std::string_view key) const {
+            return find(header()->globalProperties, key);
+        }
+
+        /// indices of the elements of the given type
+        std::vector<size_t> elementsOfType(std::string_view type) const {
+            std::vector<size_t> out;
+            for (size_t i = 0; i < elementCount(); ++i)
+                if (string(elements()[i].type) == type)
+                    out.push_back(i);
+            return out;
+        }
+
+        /// a regular Vector copy of the view
+        Vector toVector() const {
+            std::vector<concord::Point> boundary;
+            for (auto const &p : fieldBoundary())
+                boundary.emplace_back(p.x, p.y, p.z);
+            Vector v(concord::Polygon{boundary}, datum(), heading(), crs());
+            forEach(header()->fieldProperties, [&](std::string_view k, std::string_view val) {
+                v.setFieldProperty(std::string(k), std::string(val));
+            });
+            forEach(header()->globalProperties, [&](std::string_view k, std::string_view val) {
+                v.setGlobalProperty(std::string(k), std::string(val));
+            });
+            for (size_t i = 0; i < elementCount(); ++i)
+                v.appendElement(element(i).toElement());
+            return v;
+        }
+
+      private:
+        VectorView(op::SharedMapping control, op::SharedMapping data, uint64_t generation)
+            : control_(std::move(control)), data_(std::move(data)), generation_(generation) {
+            auto const *h = header();
+            auto within = [&](op::SharedRange r, size_t unit) {
+                return r.first <= data_.size() && r.count <= (data_.size() - r.first) / unit;
+            };
+            if (data_.size() < sizeof(op::SharedHeader) || h->magic != op::kSharedMagic ||
+                h->version != op::kSharedVersion || h->generation != generation || h->bytes > data_.size() ||
+                !within(h->elements, sizeof(op::SharedElement)) ||
+                !within(h->properties, sizeof(op::SharedProperty)) || !within(h->points, sizeof(SharedPoint)) ||
+                !within(h->strings, 1))
+                throw std::runtime_error("geoson::VectorView(): malformed snapshot");
+        }
+
+        op::SharedControl const *control() const {
+            return reinterpret_cast<op::SharedControl const *>(control_.data());
+        }
+        op::SharedHeader const *header() const { return reinterpret_cast<op::SharedHeader const *>(data_.data()); }
+        op::SharedElement const *elements() const {
+            return reinterpret_cast<op::SharedElement const *>(data_.data() + header()->elements.first);
+        }
+
+        // ranges inside the segment are bounds-checked on access: the header was checked on open
+        std::span<const SharedPoint> points(op::SharedRange r) const {
+            if (r.first > header()->points.count || r.count > header()->points.count - r.first)
+                throw std::runtime_error("geoson::VectorView(): malformed snapshot");
+            auto const *base = reinterpret_cast<SharedPoint const *>(data_.data() + header()->points.first);
+            return {base + r.first, r.count};
+        }
+        std::string_view string(op::SharedString s) const {
+            if (s.offset > header()->strings.count || s.length > header()->strings.count - s.offset)
+                throw std::runtime_error("geoson::VectorView(): malformed snapshot");
+            return {data_.data() + header()->strings.first + s.offset, s.length};
+        }
+        template <typename Fn> void forEach(op::SharedRange r, Fn &&fn) const {
+            if (r.first > header()->properties.count || r.count > header()->properties.count - r.first)
+                throw std::runtime_error("geoson::VectorView(): malformed snapshot");
+            auto const *props =
+                reinterpret_cast<op::SharedProperty const *>(data_.data() + header()->properties.first);
+            for (uint64_t i = r.first; i < r.first + r.count; ++i)
+                fn(string(props[i].key), string(props[i].value));
+        }
+        std::optional<std::string_view> find(op::SharedRange r, std::string_view key) const {
+            std::optional<std::string_view> found;
+            forEach(r, [&](std::string_view k, std::string_view v) {
+                if (!found && k == key)
+                    found = v;
+            });
+            return found;
+        }
+
+        op::SharedMapping control_;
+        op::SharedMapping data_;
+        uint64_t generation_;
+    };
+
+    /// Publishes versions of a Vector under a shared-memory name, one publisher per name. Owns the segments:
+    /// they are removed when the publisher is destroyed (views already open keep their mapping and turn stale;
+    /// reopening them finds the next publisher's versions).
+    class VectorPublisher {
+      public:
+        /// `keep` previous versions stay available to readers that are about to map them
+        explicit VectorPublisher(std::string name, size_t keep = 1) : name_(std::move(name)), keep_(keep) {
+            if (resume())
+                return;
+            auto control = op::SharedMapping::open(op::segmentName(name_), true, sizeof(op::SharedControl));
+            control_ = std::move(*control);
+            auto *c = new (control_.data()) op::SharedControl{op::kSharedMagic, op::kSharedVersion, {0}, {0}};
+            c->generation.store(0, std::memory_order_release);
+        }
+
+        VectorPublisher(VectorPublisher const &) = delete;
+        VectorPublisher &operator=(VectorPublisher const &) = delete;
+
+        ~VectorPublisher() {
+            control()->retired.store(1, std::memory_order_release);
+            for (uint64_t g : live_)
+                ::shm_unlink(op::snapshotName(name_, g).c_str());
+            ::shm_unlink(op::segmentName(name_).c_str());
+        }
+
+        /// write `v` as a new version and make it the current one; returns its generation
+        uint64_t publish(Vector const &v) {
+            op::SharedLayout layout(v);
+            uint64_t generation = generation_ + 1;
+            {
+                auto data = op::SharedMapping::open(op::snapshotName(name_, generation), true, layout.bytes());
+                layout.write(data->data(), generation);
+            } // the segment outlives our mapping
+            control()->generation.store(generation, std::memory_order_release);
+            generation_ = generation;
+            live_.push_back(generation);
+            while (live_.size() > keep_ + 1) {
+                ::shm_unlink(op::snapshotName(name_, live_.front()).c_str());
+                live_.erase(live_.begin());
+            }
+            return generation;
+        }
+
+        uint64_t generation() const { return generation_; }
+        std::string const &name() const { return name_; }
+
+      private:
+        op::SharedControl *control() const { return reinterpret_cast<op::SharedControl *>(control_.data()); }
+
+        /// Take over the control segment of a publisher that died without retiring it, continuing its
+        /// generations: replacing the segment would leave the views of it never going stale. Its versions
+        /// stay readable until ours push them out. False if there is none to take over.
+        bool resume() {
+            std::optional<op::SharedMapping> control;
+            try {
+                control = op::SharedMapping::open(op::segmentName(name_), false, 0, true);
+            } catch (std::runtime_error const &) {
+                return false; // e.g. empty: its creator died before sizing it
+            }
+            if (!control || control->size() < sizeof(op::SharedControl))
+                return false;
+            auto const *c = reinterpret_cast<op::SharedControl const *>(control->data());
+            if (c->magic != op::kSharedMagic || c->version != op::kSharedVersion ||
+                c->retired.load(std::memory_order_acquire))
+                return false;
+            control_ = std::move(*control);
+            generation_ = c->generation.load(std::memory_order_acquire);
+            for (uint64_t g = generation_ > keep_ ? generation_ - keep_ : 1; g <= generation_; ++g)
+                live_.push_back(g); // what it kept; unlinking one that is already gone is harmless
+            return true;
+        }
+
+        std::string name_;
+        size_t keep_;
+        op::SharedMapping control_;
+        uint64_t generation_ = 0;
+        std::vector<uint64_t> live_;
+    };
+
+#endif
+
+} // namespace geoson
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "geoson/types.hpp"
+
+namespace geoson {
+
+    namespace op {
+        /// planar (x,y) distance from p to the segment a-b, in the internal ENU frame (metres)
+        inline double segmentDistance(concord::Point const &p, concord::Point const &a, concord::Point const &b) {
+            double dx = b.x - a.x, dy = b.y - a.y;
+            double len2 = dx * dx + dy * dy;
+            double t = len2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0.0;
+            t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+            double ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+            return std::sqrt(ex * ex + ey * ey);
+        }
+
+        /// mark the vertices of pts[first..last] that Douglas-Peucker keeps (endpoints are assumed kept)
+        inline void douglasPeucker(std::vector<concord::Point> const &pts, size_t first, size_t last, double tolerance,
+                                   std::vector<bool> &keep) {
+            // explicit stack: long recorded trajectories would otherwise recurse very deep
+            std::vector<std::pair<size_t, size_t>> stack{{first, last}};
+            while (!stack.empty()) {
+                auto [lo, hi] = stack.back();
+                stack.pop_back();
+                double maxDist = 0.0;
+                size_t index = lo;
+                for (size_t i = lo + 1; i < hi; ++i) {
+                    double d = segmentDistance(pts[i], pts[lo], pts[hi]);
+                    if (d > maxDist) {
+                        maxDist = d;
+                        index = i;
+                    }
+                }
+                if (maxDist > tolerance) {
+                    keep[index] = true;
+                    stack.emplace_back(lo, index);
+                    stack.emplace_back(index, hi);
+                }
+            }
+        }
+    } // namespace op
+
+    /// Douglas-Peucker simplification of a vertex sequence; first and last vertex are always kept
+    inline std::vector<concord::Point> douglasPeucker(std::vector<concord::Point> const &pts, double tolerance) {
+        if (pts.size() < 3 || tolerance <= 0.0)
+            return pts;
+        std::vector<bool> keep(pts.size(), false);
+        keep.front() = keep.back() = true;
+        op::douglasPeucker(pts, 0, pts.size() - 1, tolerance, keep);
+        std::vector<concord::Point> out;
+        for (size_t i = 0; i < pts.size(); ++i)
+            if (keep[i])
+                out.push_back(pts[i]);
+        return out;
+    }
+
+    /// simplified copy of a geometry; Points and Lines are returned unchanged
+    inline Geometry simplify(Geometry const &geom, double tolerance) {
+        if (auto *path = std::get_if<concord::Path>(&geom)) {
+            auto pts = douglasPeucker(path->getPoints(), tolerance);
+            if (pts.size() == 2)
+                return concord::Line{pts[0], pts[1]};
+            return concord::Path{pts};
+        }
+        if (auto *poly = std::get_if<concord::Polygon>(&geom)) {
+            auto pts = douglasPeucker(poly->getPoints(), tolerance);
+            if (pts.size() < 4) // keep at least a triangle (plus closing vertex when closed)
+                return geom;
+            return concord::Polygon{pts};
+        }
+        return geom;
+    }
+
+    /// Streaming Douglas-Peucker: vertices are pushed one by one and only a bounded window of them is
+    /// held at a time. Each full window is simplified and flushed, its last vertex becoming the anchor
+    /// of the next, so every dropped vertex stays within `tolerance` of the output polyline.
+    class StreamingSimplifier {
+      public:
+        static constexpr size_t kWindow = 256;
+
+        StreamingSimplifier(std::vector<concord::Point> &out, double tolerance) : out_(out), tolerance_(tolerance) {
+            window_.reserve(kWindow);
+        }
+
+        void push(concord::Point const &p) {
+            if (tolerance_ <= 0.0) {
+                out_.push_back(p);
+                return;
+            }
+            window_.push_back(p);
+            if (window_.size() == kWindow)
+                flush(false);
+        }
+
+        /// emit whatever is buffered; call once after the last vertex
+        void finish() {
+            if (!window_.empty())
+                flush(true);
+        }
+
+      private:
+        std::vector<concord::Point> &out_;
+        double tolerance_;
+        std::vector<concord::Point> window_;
+        bool started_ = false;
+
+        void flush(bool last) {
+            // window_[0] is the anchor already emitted by the previous flush (except for the first one)
+            bool anchored = started_;
+            std::vector<bool> keep(window_.size(), false);
+            keep.front() = keep.back() = true;
+            if (window_.size() > 2)
+                op::douglasPeucker(window_, 0, window_.size() - 1, tolerance_, keep);
+            for (size_t i = anchored ? 1 : 0; i < window_.size(); ++i)
+                if (keep[i])
+                    out_.push_back(window_[i]);
+            started_ = true;
+            if (!last) {
+                auto anchor = window_.back();
+                window_.clear();
+                window_.push_back(anchor);
+            } else {
+                window_.clear();
+            }
+        }
+    };
+
+} // namespace geoson
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "geoson/memory.hpp"
+
+// Optional per-phase instrumentation of reads and writes. Everything below is compiled in only when
+// GEOSON_ENABLE_STATS is defined to a non-zero value (CMake option of the same name); otherwise the
+// GEOSON_STATS(...) hooks expand to nothing and the stats structs are simply never filled.
+// The per-phase allocation counts additionally need GEOSON_INSTALL_ALLOCATION_HOOKS() (memory.hpp).
+
+#if defined(GEOSON_ENABLE_STATS) && GEOSON_ENABLE_STATS
+#define GEOSON_STATS(...) __VA_ARGS__
+#else
+#define GEOSON_STATS(...)
+#endif
+
+namespace geoson {
+
+    /// heap allocations made during one phase (zero unless the allocation hooks are installed)
+    struct PhaseAllocations {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+
+        PhaseAllocations &operator+=(PhaseAllocations const &o) {
+            count += o.count;
+            bytes += o.bytes;
+            return *this;
+        }
+    };
+
+    /// what a read spent its time on; counters are added to, so one instance can span several reads
+    struct ParseStats {
+        uint64_t bytes = 0;      // input file size
+        uint64_t features = 0;   // geoson Features produced (Multi* geometries count once per part)
+        uint64_t vertices = 0;   // positions decoded
+        uint64_t properties = 0; // feature property entries copied
+
+        uint64_t tokenizeNs = 0;   // reading the file and tokenizing it into a JSON DOM
+        uint64_t geometryNs = 0;   // decoding geometries, excluding conversionNs
+        uint64_t conversionNs = 0; // WGS → ENU (toENU) per vertex
+        uint64_t propertiesNs = 0; // copying feature properties
+        uint64_t buildNs = 0;      // header and assembling the FeatureCollection
+
+        PhaseAllocations tokenizeAlloc;
+        PhaseAllocations geometryAlloc; // including conversion
+        PhaseAllocations propertiesAlloc;
+        PhaseAllocations buildAlloc;
+
+        uint64_t totalNs() const { return tokenizeNs + geometryNs + conversionNs + propertiesNs + buildNs; }
+
+        /// fold in the counters of another read, e.g. one chunk of a parallel read
+        ParseStats &operator+=(ParseStats const &o) {
+            bytes += o.bytes;
+            features += o.features;
+            vertices += o.vertices;
+            properties += o.properties;
+            tokenizeNs += o.tokenizeNs;
+            geometryNs += o.geometryNs;
+            conversionNs += o.conversionNs;
+            propertiesNs += o.propertiesNs;
+            buildNs += o.buildNs;
+            tokenizeAlloc += o.tokenizeAlloc;
+            geometryAlloc += o.geometryAlloc;
+            propertiesAlloc += o.propertiesAlloc;
+            buildAlloc += o.buildAlloc;
+            return *this;
+        }
+    };
+
+    /// what a write spent its time on; counters are added to
+    struct WriteStats {
+        uint64_t bytes = 0; // serialized size
+        uint64_t features = 0;
+        uint64_t vertices = 0;
+        uint64_t properties = 0;
+
+        uint64_t geometryNs = 0;   // building coordinate arrays, excluding conversionNs
+        uint64_t conversionNs = 0; // ENU → WGS (toWGS) per vertex
+        uint64_t propertiesNs = 0; // copying feature properties
+        uint64_t serializeNs = 0;  // JSON DOM → text
+        uint64_t ioNs = 0;         // writing the text to disk
+
+        PhaseAllocations geometryAlloc; // including conversion
+        PhaseAllocations propertiesAlloc;
+        PhaseAllocations serializeAlloc;
+        PhaseAllocations ioAlloc;
+
+        uint64_t totalNs() const { return geometryNs + conversionNs + propertiesNs + serializeNs + ioNs; }
+
+        /// fold in the counters of another write
+        WriteStats &operator+=(WriteStats const &o) {
+            bytes += o.bytes;
+            features += o.features;
+            vertices += o.vertices;
+            properties += o.properties;
+            geometryNs += o.geometryNs;
+            conversionNs += o.conversionNs;
+            propertiesNs += o.propertiesNs;
+            serializeNs += o.serializeNs;
+            ioNs += o.ioNs;
+            geometryAlloc += o.geometryAlloc;
+            propertiesAlloc += o.propertiesAlloc;
+            serializeAlloc += o.serializeAlloc;
+            ioAlloc += o.ioAlloc;
+            return *this;
+        }
+    };
+
+    /// true when the library was built with GEOSON_ENABLE_STATS and stats out-parameters get filled
+#if defined(GEOSON_ENABLE_STATS) && GEOSON_ENABLE_STATS
+    inline constexpr bool statsEnabled = true;
+#else
+    inline constexpr bool statsEnabled = false;
+#endif
+
+    namespace op {
+        /// stats of the read/write in progress on this thread, so deep helpers (parsePoint, outputCoords)
+        /// can record without threading a pointer through every signature
+        inline thread_local ParseStats *activeParseStats = nullptr;
+        inline thread_local WriteStats *activeWriteStats = nullptr;
+
+        inline uint64_t nowNs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+        }
+
+        /// adds the lifetime of the scope to *sink and this thread's allocations during it to *allocs;
+        /// does nothing (not even read the clock) for null sinks
+        class PhaseTimer {
+          public:
+            explicit PhaseTimer(uint64_t *sink, PhaseAllocations *allocs = nullptr)
+                : sink_(sink), allocs_(allocs), start_(sink ? nowNs() : 0),
+                  allocStart_(allocs ? alloc::current() : alloc::Counters{}) {}
+            PhaseTimer(PhaseTimer const &) = delete;
+            PhaseTimer &operator=(PhaseTimer const &) = delete;
+            ~PhaseTimer() {
+                if (sink_)
+                    *sink_ += nowNs() - start_;
+                if (allocs_) {
+                    auto now = alloc::current();
+                    allocs_->count += now.allocations - allocStart_.allocations;
+                    allocs_->bytes += now.bytes - allocStart_.bytes;
+                }
+            }
+
+          private:
+            uint64_t *sink_;
+            PhaseAllocations *allocs_;
+            uint64_t start_;
+            alloc::Counters allocStart_;
+        };
+
+        template <typename T> T *parsePhase(T ParseStats::*field) {
+            return activeParseStats ? &(activeParseStats->*field) : nullptr;
+        }
+        template <typename T> T *writePhase(T WriteStats::*field) {
+            return activeWriteStats ? &(activeWriteStats->*field) : nullptr;
+        }
+
+        /// makes `stats` the active sink of this thread for the scope (a null `stats` leaves it unchanged)
+        template <typename Stats> class StatsScope {
+          public:
+            StatsScope(Stats *&active, Stats *stats) : active_(active), previous_(active) {
+                if (stats)
+                    active_ = stats;
+            }
+            StatsScope(StatsScope const &) = delete;
+            StatsScope &operator=(StatsScope const &) = delete;
+            ~StatsScope() { active_ = previous_; }
+
+          private:
+            Stats *&active_;
+            Stats *previous_;
+        };
+    } // namespace op
+
+} // namespace geoson
@@ -0,0 +1,459 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "geoson/record.hpp"
+#include "geoson/summary.hpp"
+#include "geoson/vector.hpp"
+
+// A Vector persisted in a memory-mapped file, mutated in place. Elements are stored one per block and
+// addressed by a stable id; updating an element writes a new block and repoints its id, so nothing is
+// re-serialized but the element itself. Opening a cleanly closed store only validates its header, whatever
+// its size; after a crash the blocks are walked once to rebuild the free lists.
+//
+// File layout (native byte order):
+//   [0, 4096)   two header copies, 512 bytes apart, written alternately with a sequence number and checksum
+//   [4096, end) blocks of 2^k bytes, each a 32-byte block header and a payload: one element, the vector's
+//               header (datum, heading, CRS, field boundary and properties) or the id → block slot table.
+//               Freed blocks are chained in one free list per size class, once no durable header or slot
+//               table refers to them.
+
+namespace geoson {
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    enum class SyncPolicy {
+        /// msync every mutation before it returns: after a crash, every completed mutation is there
+        EveryWrite,
+        /// msync on flush() and on close only: a crash may lose the mutations since the last flush()
+        Manual,
+    };
+
+    struct StoreOptions {
+        SyncPolicy sync = SyncPolicy::Manual;
+    };
+
+    /// A Vector kept in a memory-mapped file. Elements are addressed by ids that stay valid until the element
+    /// is removed (removed ids are reused); mutations go straight to the mapping and are made durable
+    /// according to StoreOptions::sync. One process at a time may have a store open (it is flock()ed), and
+    /// a store is not thread-safe: guard it like a Vector.
+    class VectorStore {
+      public:
+        /// create (or overwrite) `file` holding `vector`
+        static VectorStore create(const std::filesystem::path &file, Vector const &vector, StoreOptions opts = {}) {
+            VectorStore store(file, opts, true);
+            store.h_.end = kDataStart;
+            store.h_.slots = store.allocate(kSlotTag, 0, std::string(8 * 1024, '\0'));
+            store.h_.meta = store.allocate(kMetaTag, 0, op::encodeVectorHeader(vector));
+            auto sync = store.opts_.sync;
+            store.opts_.sync = SyncPolicy::Manual; // one msync for the whole import
+            for (auto const &e : vector)
+                store.add(e);
+            store.opts_.sync = sync;
+            store.flush();
+            return store;
+        }
+
+        /// open an existing store; recovers it first if it was not closed cleanly
+        static VectorStore open(const std::filesystem::path &file, StoreOptions opts = {}) {
+            return VectorStore(file, opts, false);
+        }
+
+        VectorStore(VectorStore &&o) noexcept
+            : path_(std::move(o.path_)), opts_(o.opts_), fd_(std::exchange(o.fd_, -1)),
+              base_(std::exchange(o.base_, nullptr)), size_(o.size_), h_(o.h_), pending_(std::move(o.pending_)),
+              recovered_(o.recovered_) {}
+        VectorStore &operator=(VectorStore &&) = delete;
+        VectorStore(VectorStore const &) = delete;
+        VectorStore &operator=(VectorStore const &) = delete;
+
+        ~VectorStore() {
+            if (base_) {
+                try {
+                    h_.clean = 1;
+                    flush();
+                } catch (...) {
+                }
+                ::munmap(base_, size_);
+            }
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        /// live elements
+        size_t size() const { return h_.live; }
+        /// ids handed out so far are below this
+        uint64_t idLimit() const { return h_.slotCount; }
+        bool contains(uint64_t id) const { return id < h_.slotCount && isBlock(slots()[id]); }
+
+        Element get(uint64_t id) const { return op::decodeElement(payload(blockOf(id))); }
+
+        uint64_t add(Element const &e) {
+            auto record = op::encodeElement(e);
+            uint64_t id = takeId();
+            uint64_t off = allocate(kElementTag, id, record);
+            persist(off, blockSize(off));
+            slots()[id] = off;
+            persist(h_.slots + sizeof(Block) + id * 8, 8);
+            ++h_.live;
+            return id;
+        }
+
+        void update(uint64_t id, Element const &e) {
+            uint64_t old = blockOf(id);
+            uint64_t off = allocate(kElementTag, id, op::encodeElement(e));
+            persist(off, blockSize(off));
+            slots()[id] = off;
+            persist(h_.slots + sizeof(Block) + id * 8, 8);
+            retire(old);
+        }
+
+        void remove(uint64_t id) {
+            uint64_t old = blockOf(id);
+            slots()[id] = (h_.freeId << 1) | 1;
+            h_.freeId = id + 1;
+            persist(h_.slots + sizeof(Block) + id * 8, 8);
+            retire(old);
+            --h_.live;
+        }
+
+        /// fn(id, Element const &) for every live element, in id order
+        template <typename Fn> void forEach(Fn &&fn) const {
+            for (uint64_t id = 0; id < h_.slotCount; ++id)
+                if (isBlock(slots()[id]))
+                    fn(id, op::decodeElement(payload(slots()[id])));
+        }
+
+        /// the stored vector, elements in id order
+        Vector load() const {
+            Vector v = header();
+            forEach([&](uint64_t, Element e) { v.appendElement(std::move(e)); });
+            return v;
+        }
+
+        /// datum, heading, CRS, field boundary and properties (without elements)
+        Vector header() const { return op::decodeVectorHeader(payload(h_.meta)); }
+
+        /// replace the stored header with that of `v` (its elements are ignored)
+        void setHeader(Vector const &v) {
+            uint64_t off = allocate(kMetaTag, 0, op::encodeVectorHeader(v));
+            persist(off, blockSize(off));
+            pending_.push_back(h_.meta);
+            h_.meta = off;
+            if (opts_.sync == SyncPolicy::EveryWrite)
+                commit();
+        }
+
+        /// make every mutation so far durable
+        void flush() {
+            sync(0, h_.end);
+            commit();
+        }
+
+        /// whether open() found the store not cleanly closed and rebuilt it
+        bool recovered() const { return recovered_; }
+        /// bytes of the file in use (the file itself grows in larger steps)
+        uint64_t bytesUsed() const { return h_.end; }
+        const std::filesystem::path &path() const { return path_; }
+
+      private:
+        static constexpr uint64_t kMagic = 0x5356'4e4f'5345'4547ull; // "GEOSONVS"
+        static constexpr uint32_t kVersion = 1;
+        static constexpr uint64_t kHeaderSlot = 512;
+        static constexpr uint64_t kDataStart = 4096;
+        static constexpr uint32_t kMinClass = 6; // 64-byte blocks
+        static constexpr uint32_t kClasses = 48;
+        static constexpr uint32_t kFreeTag = 0xB10C'0F00, kElementTag = 0xB10C'0001, kMetaTag = 0xB10C'0002,
+                                  kSlotTag = 0xB10C'0003;
+
+        struct Block {
+            uint32_t tag;
+            uint32_t sizeClass; // the block spans 2^sizeClass bytes
+            uint64_t used;      // payload bytes
+            uint64_t owner;     // element id
+            uint32_t checksum;  // of the payload; slot tables are not checksummed
+            uint32_t reserved;
+        };
+        static_assert(sizeof(Block) == 32);
+
+        struct Header {
+            uint64_t magic = kMagic;
+            uint32_t version = kVersion;
+            uint32_t clean = 0;
+            uint64_t seq = 0;
+            uint64_t end = 0;       // first byte past the last block
+            uint64_t slots = 0;     // slot table block: per id, its block, (next free id + 1) << 1 | 1, or 0
+            uint64_t slotCount = 0; // ids handed out
+            uint64_t meta = 0;      // vector header block
+            uint64_t live = 0;
+            uint64_t freeId = 0; // first reusable id + 1
+            std::array<uint64_t, kClasses> freeBlocks{};
+            uint64_t checksum = 0;
+        };
+        static_assert(sizeof(Header) <= kHeaderSlot);
+
+        VectorStore(const std::filesystem::path &file, StoreOptions opts, bool create) : path_(file), opts_(opts) {
+            fd_ = ::open(file.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+            if (fd_ < 0)
+                fail("cannot open " + file.string());
+            if (::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+                ::close(fd_);
+                fd_ = -1;
+                throw std::runtime_error("geoson::VectorStore(): " + file.string() + " is open elsewhere");
+            }
+            if (create) {
+                if (::ftruncate(fd_, 0) != 0)
+                    fail("cannot truncate " + file.string());
+                grow(size_t(1) << 20);
+                return;
+            }
+            struct stat st;
+            if (::fstat(fd_, &st) != 0)
+                fail("cannot stat " + file.string());
+            size_ = static_cast<uint64_t>(st.st_size);
+            if (size_ < kDataStart)
+                throw std::runtime_error("geoson::VectorStore(): " + file.string() + " is not a vector store");
+            map();
+            try {
+                Header const *best = nullptr;
+                for (uint64_t at : {uint64_t(0), kHeaderSlot}) {
+                    auto const *h = reinterpret_cast<Header const *>(base_ + at);
+                    if (h->magic == kMagic && h->version == kVersion && h->checksum == headerChecksum(*h) &&
+                        (!best || h->seq > best->seq))
+                        best = h;
+                }
+                if (!best)
+                    throw std::runtime_error("geoson::VectorStore(): " + file.string() + " is not a vector store");
+                h_ = *best;
+                if (!validBlock(h_.slots, kSlotTag) || !validBlock(h_.meta, kMetaTag))
+                    throw std::runtime_error("geoson::VectorStore(): " + file.string() + " is corrupt");
+                if (!h_.clean)
+                    recover();
+                h_.clean = 0; // a crash from here on is detected on the next open
+                commit();
+            } catch (...) {
+                ::munmap(base_, size_);
+                base_ = nullptr;
+                ::close(fd_);
+                fd_ = -1;
+                throw;
+            }
+        }
+
+        [[noreturn]] void fail(std::string const &what) {
+            auto err = std::string(std::strerror(errno));
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = -1;
+            throw std::runtime_error("geoson::VectorStore(): " + what + ": " + err);
+        }
+
+        void map() {
+            void *p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (p == MAP_FAILED)
+                fail("cannot map " + path_.string());
+            base_ = static_cast<char *>(p);
+        }
+
+        /// make the file at least `bytes` long, doubling it
+        void grow(uint64_t bytes) {
+            uint64_t size = std::max<uint64_t>(size_, uint64_t(1) << 20);
+            while (size < bytes)
+                size *= 2;
+            if (size == size_ && base_)
+                return;
+            if (base_)
+                ::munmap(base_, size_);
+            base_ = nullptr;
+            if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+                fail("cannot grow " + path_.string());
+            size_ = size;
+            map();
+        }
+
+        static uint64_t headerChecksum(Header const &h) {
+            return hash64(std::string_view(reinterpret_cast<const char *>(&h), offsetof(Header, checksum)));
+        }
+        static uint32_t payloadChecksum(std::string_view payload) { return static_cast<uint32_t>(hash64(payload)); }
+
+        Block *block(uint64_t off) const { return reinterpret_cast<Block *>(base_ + off); }
+        std::string_view payload(uint64_t off) const { return {base_ + off + sizeof(Block), block(off)->used}; }
+        uint64_t blockSize(uint64_t off) const { return uint64_t(1) << block(off)->sizeClass; }
+        uint64_t *slots() const { return reinterpret_cast<uint64_t *>(base_ + h_.slots + sizeof(Block)); }
+        uint64_t slotCapacity() const { return block(h_.slots)->used / 8; }
+        static bool isBlock(uint64_t slot) { return slot && !(slot & 1); }
+
+        bool validBlock(uint64_t off, uint32_t tag) const {
+            if (off < kDataStart || off % 64 || off + sizeof(Block) > size_)
+                return false;
+            auto const *b = block(off);
+            return b->tag == tag && b->sizeClass >= kMinClass && b->sizeClass < kClasses &&
+                   off + (uint64_t(1) << b->sizeClass) <= size_ && sizeof(Block) + b->used <= blockSize(off);
+        }
+
+        uint64_t blockOf(uint64_t id) const {
+            if (!contains(id))
+                throw std::out_of_range("VectorStore element id out of range");
+            return slots()[id];
+        }
+
+        /// a block holding `data`, from the free list of its size class or the end of the file
+        uint64_t allocate(uint32_t tag, uint64_t owner, std::string_view data) {
+            uint32_t cls = kMinClass;
+            while ((uint64_t(1) << cls) < sizeof(Block) + data.size())
+                ++cls;
+            if (cls >= kClasses)
+                throw std::runtime_error("geoson::VectorStore(): record too large");
+            uint64_t off = h_.freeBlocks[cls];
+            if (off) {
+                h_.freeBlocks[cls] = block(off)->owner; // free blocks chain through `owner`
+            } else {
+                off = h_.end;
+                if (off + (uint64_t(1) << cls) > size_)
+                    grow(off + (uint64_t(1) << cls));
+                h_.end += uint64_t(1) << cls;
+            }
+            std::memcpy(base_ + off + sizeof(Block), data.data(), data.size());
+            *block(off) = Block{tag, cls, data.size(), owner, tag == kSlotTag ? 0u : payloadChecksum(data), 0};
+            return off;
+        }
+
+        void release(uint64_t off) {
+            auto *b = block(off);
+            b->tag = kFreeTag;
+            b->owner = h_.freeBlocks[b->sizeClass];
+            h_.freeBlocks[b->sizeClass] = off;
+        }
+
+        /// Free the block of a replaced or removed element. Until the slot pointing away from it is durable,
+        /// the slot table on disk may still refer to it, so under Manual it is only reused after commit()
+        void retire(uint64_t off) {
+            if (opts_.sync == SyncPolicy::EveryWrite)
+                release(off);
+            else
+                pending_.push_back(off);
+        }
+
+        uint64_t takeId() {
+            if (h_.freeId) {
+                uint64_t id = h_.freeId - 1;
+                h_.freeId = slots()[id] >> 1;
+                return id;
+            }
+            if (h_.slotCount == slotCapacity()) {
+                // double the slot table; the old one stays intact until a header no longer points to it
+                std::string table(block(h_.slots)->used * 2, '\0');
+                std::memcpy(table.data(), slots(), block(h_.slots)->used);
+                uint64_t off = allocate(kSlotTag, 0, table);
+                persist(off, blockSize(off));
+                pending_.push_back(h_.slots);
+                h_.slots = off;
+                if (opts_.sync == SyncPolicy::EveryWrite)
+                    commit();
+            }
+            return h_.slotCount++;
+        }
+
+        void sync(uint64_t off, uint64_t len) {
+            static const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+            uint64_t start = off & ~(page - 1);
+            if (::msync(base_ + start, off + len - start, MS_SYNC) != 0)
+                throw std::runtime_error("geoson::VectorStore(): msync failed: " + std::string(std::strerror(errno)));
+        }
+
+        void persist(uint64_t off, uint64_t len) {
+            if (opts_.sync == SyncPolicy::EveryWrite)
+                sync(off, len);
+        }
+
+        /// write the header over the older of its two copies; blocks the previous header still referred to
+        /// become reusable once the new one is durable
+        void commit() {
+            ++h_.seq;
+            h_.checksum = headerChecksum(h_);
+            std::memcpy(base_ + (h_.seq & 1) * kHeaderSlot, &h_, sizeof h_);
+            sync(0, kDataStart);
+            for (uint64_t off : pending_)
+                release(off);
+            pending_.clear();
+        }
+
+        /// Rebuild the free lists, live count and free ids after a crash. An element survives when its block
+        /// is intact and its id's slot points to it; blocks of unfinished mutations are freed.
+        void recover() {
+            recovered_ = true;
+            h_.freeBlocks = {};
+            uint64_t capacity = slotCapacity();
+            uint64_t off = kDataStart;
+            while (off + sizeof(Block) <= size_) {
+                auto *b = block(off);
+                bool known = b->tag == kFreeTag || b->tag == kElementTag || b->tag == kMetaTag || b->tag == kSlotTag;
+                if (!known || !validBlock(off, b->tag))
+                    break;
+                bool keep = off == h_.slots || off == h_.meta;
+                if (b->tag == kElementTag && b->owner < capacity && slots()[b->owner] == off &&
+                    b->checksum == payloadChecksum(payload(off)))
+                    keep = true;
+                uint64_t next = off + blockSize(off);
+                if (!keep)
+                    release(off);
+                off = next;
+            }
+            if (off < std::max(h_.slots, h_.meta) + sizeof(Block))
+                throw std::runtime_error("geoson::VectorStore(): " + path_.string() + " is corrupt");
+            if (off + sizeof(Block) <= size_ && block(off)->tag != 0)
+                std::memset(base_ + off, 0, size_ - off); // torn tail: later walks must stop here too
+            h_.end = off;
+
+            h_.live = 0;
+            h_.slotCount = 0;
+            for (uint64_t id = 0; id < capacity; ++id) {
+                uint64_t s = slots()[id];
+                if (isBlock(s) && s < off && block(s)->tag == kElementTag && block(s)->owner == id) {
+                    ++h_.live;
+                    h_.slotCount = id + 1;
+                } else {
+                    slots()[id] = 0;
+                }
+            }
+            h_.freeId = 0;
+            for (uint64_t id = h_.slotCount; id-- > 0;)
+                if (!slots()[id]) {
+                    slots()[id] = (h_.freeId << 1) | 1;
+                    h_.freeId = id + 1;
+                }
+            sync(0, h_.end);
+        }
+
+        std::filesystem::path path_;
+        StoreOptions opts_;
+        int fd_ = -1;
+        char *base_ = nullptr;
+        uint64_t size_ = 0;
+        Header h_;
+        std::vector<uint64_t> pending_;
+        bool recovered_ = false;
+    };
+
+#endif
+
+} // namespace geoson
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "geoson/json.hpp"
+#include "geoson/parser.hpp"
+#include "geoson/writter.hpp"
+
+// Streaming access to the features of a GeoJSON FeatureCollection: the file is scanned byte-wise and
+// only one feature's JSON is materialized at a time, so memory stays bounded by the largest feature.
+// FeatureWriter is the counterpart that appends features to a file as they are produced.
+
+namespace geoson {
+
+    namespace op {
+
+        /// buffered forward scanner over a JSON file that can skip or capture whole values
+        class JsonScanner {
+          public:
+            explicit JsonScanner(const std::filesystem::path &file) : in_(file, std::ios::binary), buf_(1 << 16) {
+                if (!in_)
+                    throw std::runtime_error("geoson::FeatureReader(): cannot open \"" + file.string() + '\"');
+                in_.seekg(0, std::ios::end);
+                size_ = static_cast<uint64_t>(in_.tellg());
+                in_.seekg(0);
+            }
+
+            uint64_t size() const { return size_; }
+            uint64_t offset() const { return base_ + pos_; }
+
+            /// called before each block of the file is read; may throw to abort the scan
+            std::function<void()> interrupt;
+
+            void seek(uint64_t off) {
+                in_.clear();
+                in_.seekg(static_cast<std::streamoff>(off));
+                base_ = off;
+                pos_ = len_ = 0;
+            }
+
+            /// next non-whitespace character without consuming it; -1 at end of file
+            int peek() {
+                while (true) {
+                    if (pos_ == len_ && !fill())
+                        return -1;
+                    char c = buf_[pos_];
+                    if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+                        return static_cast<unsigned char>(c);
+                    ++pos_;
+                }
+            }
+
+            void expect(char c) {
+                if (peek() != static_cast<unsigned char>(c))
+                    fail(std::string("expected '") + c + "'");
+                ++pos_;
+            }
+
+            /// consume c if it is the next token
+            bool accept(char c) {
+                if (peek() != static_cast<unsigned char>(c))
+                    return false;
+                ++pos_;
+                return true;
+            }
+
+            /// read a string token and return its decoded value
+            std::string string() {
+                std::string raw;
+                if (peek() != '"')
+                    fail("expected string");
+                value(&raw);
+                if (raw.find('\\') == std::string::npos)
+                    return raw.substr(1, raw.size() - 2);
+                return nlohmann::json::parse(raw).get<std::string>();
+            }
+
+            /// skip one JSON value, appending its raw text to `capture` when given
+            void value(std::string *capture) {
+                int first = peek();
+                if (first < 0)
+                    fail("unexpected end of file");
+                int depth = 0;
+                bool inString = false, escaped = false;
+                bool scalar = first != '{' && first != '[' && first != '"';
+                while (true) {
+                    if (pos_ == len_ && !fill()) {
+                        if (scalar && depth == 0)
+                            return;
+                        fail("unexpected end of file");
+                    }
+                    size_t start = pos_;
+                    bool done = false;
+                    for (; pos_ < len_; ++pos_) {
+                        char c = buf_[pos_];
+                        if (inString) {
+                            if (escaped)
+                                escaped = false;
+                            else if (c == '\\')
+                                escaped = true;
+                            else if (c == '"') {
+                                inString = false;
+                                if (depth == 0) {
+                                    ++pos_;
+                                    done = true;
+                                    break;
+                                }
+                            }
+                        } else if (scalar) {
+                            if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                                done = true;
+                                break;
+                            }
+                        } else if (c == '"') {
+                            inString = true;
+                        } else if (c == '{' || c == '[') {
+                            ++depth;
+                        } else if (c == '}' || c == ']') {
+                            if (--depth == 0) {
+                                ++pos_;
+                                done = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (capture)
+                        capture->append(buf_.data() + start, pos_ - start);
+                    if (done)
+                        return;
+                }
+            }
+
+            [[noreturn]] void fail(std::string const &what) const {
+                throw std::runtime_error("geoson::FeatureReader(): " + what + " at byte " +
+                                         std::to_string(offset()));
+            }
+
+          private:
+            std::ifstream in_;
+            std::vector<char> buf_;
+            uint64_t size_ = 0, base_ = 0;
+            size_t pos_ = 0, len_ = 0;
+
+            bool fill() {
+                if (interrupt)
+                    interrupt();
+                base_ += len_;
+                pos_ = 0;
+                in_.read(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+                len_ = static_cast<size_t>(in_.gcount());
+                return len_ > 0;
+            }
+        };
+
+    } // namespace op
+
+    /// Reads a FeatureCollection one feature at a time. The header ('properties') is located first, in
+    /// whatever position it has in the file, then features are streamed from the 'features' array.
+    /// A reader can also be restricted to a byte range returned by shards() to process a file in parallel.
+    class FeatureReader {
+      public:
+        /// `interrupt`, if given, is called before each 64 KiB block of the file is read, including while the
+        /// header is searched (a full pass over the features when they come first); throwing from it aborts
+        explicit FeatureReader(const std::filesystem::path &file, ReadOptions opts = {},
+                               std::function<void()> interrupt = {})
+            : file_(file), opts_(opts), scan_(file) {
+            scan_.interrupt = std::move(interrupt);
+            scan_.expect('{');
+            std::optional<uint64_t> featuresAt;
+            bool haveHeader = false;
+            std::string raw;
+            if (scan_.peek() != '}') {
+                do {
+                    auto key = scan_.string();
+                    scan_.expect(':');
+                    if (key == "type") {
+                        raw.clear();
+                        scan_.value(&raw);
+                        auto type = nlohmann::json::parse(raw);
+                        if (!type.is_string())
+                            throw std::runtime_error(
+                                "geoson::ReadFeatureCollection(): top-level object has no string 'type' field");
+                        // a bare Feature/geometry has no collection header, exactly as in ReadFeatureCollection()
+                        if (type.get<std::string>() != "FeatureCollection")
+                            throw std::runtime_error("missing top-level 'properties'");
+                    } else if (key == "properties") {
+                        raw.clear();
+                        scan_.value(&raw);
+                        header_ = parseHeader(nlohmann::json::parse(raw));
+                        haveHeader = true;
+                    } else if (key == "features" && scan_.peek() == '[') {
+                        featuresAt = scan_.offset();
+                        if (haveHeader)
+                            break; // header already known: stream from here
+                        scan_.value(nullptr);
+                    } else {
+                        scan_.value(nullptr);
+                    }
+                } while (scan_.accept(','));
+            }
+            if (!haveHeader)
+                throw std::runtime_error("missing top-level 'properties'");
+
+            if (featuresAt) {
+                scan_.seek(*featuresAt);
+                scan_.expect('[');
+                begin_ = scan_.offset();
+                end_ = scan_.size();
+            } else {
+                begin_ = end_ = scan_.offset();
+                finished_ = true;
+            }
+        }
+
+        /// reader over the features starting in [begin, end) of a file whose header is already known
+        FeatureReader(const std::filesystem::path &file, CollectionHeader header, uint64_t begin, uint64_t end,
+                      ReadOptions opts = {})
+            : file_(file), opts_(opts), scan_(file), header_(std::move(header)), begin_(begin), end_(end) {
+            scan_.seek(begin);
+        }
+
+        CollectionHeader const &header() const { return header_; }
+
+        /// bytes of the file consumed so far and total size, e.g. for progress reporting
+        uint64_t offset() const { return scan_.offset(); }
+        uint64_t size() const { return scan_.size(); }
+
+        /// next raw GeoJSON Feature object; false once the features are exhausted
+        bool nextJson(nlohmann::json &feature) {
+            if (finished_)
+                return false;
+            scan_.accept(','); // separator left over from the previous feature
+            int c = scan_.peek();
+            if (c == ']' || c < 0 || scan_.offset() >= end_) {
+                finished_ = true;
+                return false;
+            }
+            raw_.clear();
+            scan_.value(&raw_);
+            feature = nlohmann::json::parse(raw_);
+            return true;
+        }
+
+        /// next feature parsed into geoson Features (Multi* geometries yield several); `out` is cleared
+        /// first and may end up empty for features without geometry
+        bool next(std::vector<Feature> &out) {
+            out.clear();
+            if (!nextJson(json_))
+                return false;
+            parseFeature(json_, header_, out, opts_);
+            return true;
+        }
+
+        /// split the remaining features into at most k byte ranges of similar size; returns the k'+1
+        /// boundaries (feature start offsets plus the end of the array) for the range constructor
+        std::vector<uint64_t> shards(size_t k) {
+            std::vector<uint64_t> cuts;
+            if (finished_ || k == 0)
+                return cuts;
+            op::JsonScanner probe(file_);
+            probe.seek(scan_.offset());
+            uint64_t span = end_ > probe.offset() ? end_ - probe.offset() : 0;
+            uint64_t start = probe.offset();
+            size_t shard = 0;
+            while (true) {
+                probe.accept(',');
+                int c = probe.peek();
+                if (c == ']' || c < 0 || probe.offset() >= end_)
+                    break;
+                if (probe.offset() >= start + span * shard / k) {
+                    cuts.push_back(probe.offset());
+                    ++shard;
+                }
+                probe.value(nullptr);
+            }
+            cuts.push_back(probe.offset());
+            return cuts;
+        }
+
+      private:
+        std::filesystem::path file_;
+        ReadOptions opts_;
+        op::JsonScanner scan_;
+        CollectionHeader header_;
+        uint64_t begin_ = 0, end_ = 0;
+        bool finished_ = false;
+        std::string raw_;
+        nlohmann::json json_;
+    };
+
+    namespace op {
+        inline FeatureCollection readStreamed(const std::filesystem::path &file, ReadOptions const &opts) {
+            FeatureReader reader(file, opts);
+            auto const &h = reader.header();
+            FeatureCollection fc{h.datum, h.heading, {}, h.global_properties};
+            // raw features are decoded a batch at a time (in parallel, with an executor) and then dropped
+            size_t batchSize = opts.executor ? 64 * kFeatureChunk : 1;
+            std::vector<nlohmann::json> batch;
+            nlohmann::json feature;
+            bool more = true;
+            while (more) {
+                {
+                    GEOSON_STATS(PhaseTimer timer(parsePhase(&ParseStats::tokenizeNs),
+                                                  parsePhase(&ParseStats::tokenizeAlloc));)
+                    more = reader.nextJson(feature);
+                }
+                if (more)
+                    batch.push_back(std::move(feature));
+                if (batch.size() >= batchSize || (!more && !batch.empty())) {
+                    parseFeatures(batch, h, fc.features, opts);
+                    batch.clear();
+                }
+            }
+            return fc;
+        }
+    } // namespace op
+
+    /// Writes a FeatureCollection incrementally: the header goes out on construction, features are appended
+    /// one per line, and close() (or the destructor) terminates the array. The header is written before
+    /// the features so the output can itself be streamed back without a second pass.
+    class FeatureWriter {
+      public:
+        FeatureWriter(const std::filesystem::path &file, CollectionHeader const &header, geoson::CRS outputCrs,
+                      ConversionMode conversion = ConversionMode::Exact)
+            : out_(file, std::ios::binary), datum_(header.datum), crs_(outputCrs), conversion_(conversion),
+              quant_(header.quantization) {
+            if (!out_)
+                throw std::runtime_error("Cannot open for write: " + file.string());
+            FeatureCollection meta{header.datum, header.heading, {}, header.global_properties};
+            auto props = headerToJson(meta, outputCrs);
+            if (quant_)
+                props["transform"] = {{"scale", quant_->scale}, {"translate", quant_->translate}};
+            out_ << R"({"type":"FeatureCollection","properties":)" << props.dump() << R"(,"features":[)";
+        }
+
+        FeatureWriter(FeatureWriter const &) = delete;
+        FeatureWriter &operator=(FeatureWriter const &) = delete;
+
+        ~FeatureWriter() {
+            try {
+                close();
+            } catch (...) {
+            }
+        }
+
+        /// append a Feature, converting its geometry to the output CRS (and quantizing it when the header
+        /// carries a compact-profile transform)
+        void write(Feature const &f) {
+            writeJson(featureToJson(f, datum_, crs_, quant_ ? &*quant_ : nullptr, conversion_).dump());
+        }
+
+        /// append an already serialized GeoJSON Feature object (coordinates in the output CRS)
+        void writeJson(std::string_view feature) {
+            out_ << (count_++ ? ",\n" : "\n") << feature;
+        }
+
+        uint64_t count() const { return count_; }
+
+        void close() {
+            if (!out_.is_open())
+                return;
+            out_ << "\n]}\n";
+            out_.close();
+            if (out_.fail())
+                throw std::runtime_error("geoson::FeatureWriter(): write failed");
+        }
+
+      private:
+        std::ofstream out_;
+        concord::Datum datum_;
+        geoson::CRS crs_;
+        ConversionMode conversion_;
+        std::optional<Quantization> quant_;
+        uint64_t count_ = 0;
+    };
+
+    /// stream every feature of a file through fn(std::vector<Feature> &) without loading the collection
+    template <typename Fn>
+    CollectionHeader forEachFeature(const std::filesystem::path &file, Fn &&fn, ReadOptions const &opts = {}) {
+        FeatureReader reader(file, opts);
+        std::vector<Feature> batch;
+        while (reader.next(batch))
+            if (!batch.empty())
+                fn(batch);
+        return reader.header();
+    }
+
+} // namespace geoson
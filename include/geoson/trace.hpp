@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "geoson/config.hpp"
+
+#if defined(GEOSON_COMPILED_LIBRARY)
+#include <nlohmann/json_fwd.hpp>
+#else
+#include "geoson/json.hpp"
+#endif
+
+// Scoped trace spans exported as Chrome trace-event JSON (loadable in Perfetto / chrome://tracing).
+// Tracing is off by default and toggled at runtime with trace::enable(); a disabled span costs one
+// relaxed atomic load. Each thread records into its own fixed-size ring buffer without locking, the
+// oldest events being overwritten once it is full.
+
+namespace geoson::trace {
+
+    namespace op {
+        inline std::atomic<bool> &enabledFlag() {
+            static std::atomic<bool> flag{false};
+            return flag;
+        }
+
+        inline uint64_t nowNs() {
+            static const auto epoch = std::chrono::steady_clock::now();
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch)
+                    .count());
+        }
+
+        /// one complete ("X") event; fields are relaxed atomics so an export may run concurrently
+        struct Slot {
+            std::atomic<const char *> name{nullptr};
+            std::atomic<const char *> category{nullptr};
+            std::atomic<uint64_t> start{0};
+            std::atomic<uint64_t> duration{0};
+            std::atomic<uint32_t> tid{0};
+        };
+
+        /// single-producer ring: only the owning thread writes head_, export() reads and validates, clear()
+        /// raises the floor below which events are no longer reported
+        class ThreadBuffer {
+          public:
+            static constexpr size_t kCapacity = size_t(1) << 14;
+
+            void record(const char *name, const char *category, uint64_t start, uint64_t duration, uint32_t tid) {
+                uint64_t h = head_.load(std::memory_order_relaxed);
+                Slot &s = slots_[h % kCapacity];
+                s.name.store(name, std::memory_order_relaxed);
+                s.category.store(category, std::memory_order_relaxed);
+                s.start.store(start, std::memory_order_relaxed);
+                s.duration.store(duration, std::memory_order_relaxed);
+                s.tid.store(tid, std::memory_order_relaxed);
+                head_.store(h + 1, std::memory_order_release);
+            }
+
+            /// events still in the ring; entries the producer may have overwritten meanwhile are dropped
+            template <typename Fn> void forEach(Fn &&fn) const {
+                uint64_t floor = floor_.load(std::memory_order_acquire); // at most head_, which only grows
+                uint64_t end = head_.load(std::memory_order_acquire);
+                uint64_t begin = std::max(end > kCapacity ? end - kCapacity : 0, floor);
+                struct Copy {
+                    const char *name, *category;
+                    uint64_t start, duration;
+                    uint32_t tid;
+                };
+                std::vector<Copy> copies;
+                copies.reserve(end - begin);
+                for (uint64_t i = begin; i < end; ++i) {
+                    Slot const &s = slots_[i % kCapacity];
+                    copies.push_back({s.name.load(std::memory_order_relaxed),
+                                      s.category.load(std::memory_order_relaxed),
+                                      s.start.load(std::memory_order_relaxed),
+                                      s.duration.load(std::memory_order_relaxed),
+                                      s.tid.load(std::memory_order_relaxed)});
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                uint64_t now = head_.load(std::memory_order_relaxed);
+                // the producer may be writing index `now`, which shares a slot with now - kCapacity
+                uint64_t safe = now >= kCapacity ? now - kCapacity + 1 : 0;
+                for (uint64_t i = begin; i < end; ++i)
+                    if (i >= safe) {
+                        auto const &c = copies[i - begin];
+                        fn(c.name, c.category, c.start, c.duration, c.tid);
+                    }
+            }
+
+            void clear() { floor_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+            std::atomic<bool> inUse{true};
+
+          private:
+            std::array<Slot, kCapacity> slots_;
+            std::atomic<uint64_t> head_{0};
+            std::atomic<uint64_t> floor_{0};
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            std::vector<std::pair<uint32_t, std::string>> threadNames;
+            uint32_t nextTid = 1;
+        };
+
+        inline Registry &registry() {
+            static Registry r;
+            return r;
+        }
+
+        /// this thread's buffer and trace tid, registered on first use; a buffer released by an exited
+        /// thread is reused so short-lived workers do not grow the registry
+        struct ThreadState {
+            std::shared_ptr<ThreadBuffer> buffer;
+            uint32_t tid = 0;
+
+            ThreadState() {
+                auto &r = registry();
+                std::lock_guard lock(r.mutex);
+                tid = r.nextTid++;
+                for (auto &b : r.buffers)
+                    if (!b->inUse.load()) {
+                        b->inUse = true;
+                        buffer = b;
+                        return;
+                    }
+                buffer = std::make_shared<ThreadBuffer>();
+                r.buffers.push_back(buffer);
+            }
+            ~ThreadState() { buffer->inUse = false; }
+        };
+
+        inline ThreadState &threadState() {
+            thread_local ThreadState state;
+            return state;
+        }
+    } // namespace op
+
+    inline void enable(bool on = true) { op::enabledFlag().store(on, std::memory_order_relaxed); }
+    inline bool enabled() { return op::enabledFlag().load(std::memory_order_relaxed); }
+
+    /// label the calling thread in the exported trace
+    inline void setThreadName(std::string name) {
+        auto tid = op::threadState().tid;
+        auto &r = op::registry();
+        std::lock_guard lock(r.mutex);
+        r.threadNames.emplace_back(tid, std::move(name));
+    }
+
+    /// RAII span; `name` and `category` must outlive the trace (string literals)
+    class Span {
+      public:
+        explicit Span(const char *name, const char *category = "geoson") {
+            if (enabled()) {
+                name_ = name;
+                category_ = category;
+                start_ = op::nowNs();
+            }
+        }
+        Span(Span const &) = delete;
+        Span &operator=(Span const &) = delete;
+        ~Span() {
+            if (name_) {
+                auto &t = op::threadState();
+                t.buffer->record(name_, category_, start_, op::nowNs() - start_, t.tid);
+            }
+        }
+
+      private:
+        const char *name_ = nullptr;
+        const char *category_ = nullptr;
+        uint64_t start_ = 0;
+    };
+
+    /// drop every recorded event
+    inline void clear() {
+        auto &r = op::registry();
+        std::lock_guard lock(r.mutex);
+        for (auto &b : r.buffers)
+            b->clear();
+    }
+
+    /// recorded events as a trace-event JSON object ({"traceEvents": [...]}); timestamps in microseconds
+    GEOSON_API nlohmann::json toJson();
+
+    /// write the trace to a file for Perfetto (ui.perfetto.dev) or chrome://tracing
+    GEOSON_API void write(const std::filesystem::path &path);
+
+} // namespace geoson::trace
+
+#define GEOSON_TRACE_CONCAT_(a, b) a##b
+#define GEOSON_TRACE_CONCAT(a, b) GEOSON_TRACE_CONCAT_(a, b)
+
+/// GEOSON_TRACE_SCOPE("read") traces the enclosing scope
+#define GEOSON_TRACE_SCOPE(...) ::geoson::trace::Span GEOSON_TRACE_CONCAT(geoson_trace_span_, __LINE__)(__VA_ARGS__)
+
+#if !defined(GEOSON_COMPILED_LIBRARY)
+#include "geoson/impl/trace.ipp"
+#endif
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "geoson/executor.hpp"
+#include "geoson/json.hpp"
+#include "geoson/trace.hpp"
+#include "geoson/stream.hpp"
+
+namespace geoson {
+
+    struct TranscodeOptions {
+        /// datum of the output; defaults to the input's. ENU output is re-anchored around it
+        std::optional<concord::Datum> datum;
+        /// features handed from one pipeline stage to the next at a time
+        size_t batchSize = 256;
+        /// batches being converted at once; together with batchSize this bounds memory
+        size_t queueDepth = 4;
+        /// how positions are converted between WGS and ENU (see geoson/projection.hpp)
+        ConversionMode conversion = ConversionMode::Exact;
+        /// where batches are converted and serialized; null uses defaultExecutor()
+        Executor *executor = nullptr;
+    };
+
+    namespace op {
+
+        /// maps raw file positions (x,y,z for ENU, lon,lat,alt for WGS) from one frame to another
+        class CoordinateTransform {
+          public:
+            CoordinateTransform(geoson::CRS from, concord::Datum const &fromDatum, geoson::CRS to,
+                                concord::Datum const &toDatum, ConversionMode mode = ConversionMode::Exact)
+                : from_(from), to_(to), fromDatum_(fromDatum), toDatum_(toDatum) {
+                // one plane per side: the thread's cached plane would be rebuilt on every switch of datum
+                if (mode == ConversionMode::LocalTangent) {
+                    fromPlane_.emplace(fromDatum);
+                    toPlane_.emplace(toDatum);
+                }
+            }
+
+            /// WGS→WGS, and ENU→ENU around the same datum, leave positions untouched
+            bool identity() const {
+                return from_ == to_ && (from_ == geoson::CRS::WGS || sameDatum(fromDatum_, toDatum_));
+            }
+
+            /// convert a batch of positions in place
+            void apply(std::vector<std::array<double, 3>> &pts) const {
+                if (identity())
+                    return;
+                for (auto &p : pts) {
+                    // {lat, lon, alt}
+                    std::array<double, 3> wgs{p[1], p[0], p[2]};
+                    if (from_ == geoson::CRS::ENU) {
+                        if (fromPlane_)
+                            wgs = fromPlane_->toWGS(p[0], p[1], p[2]);
+                        else
+                            wgs = toWGS(p[0], p[1], p[2], fromDatum_, ConversionMode::Exact);
+                    }
+                    if (to_ == geoson::CRS::WGS)
+                        p = {wgs[1], wgs[0], wgs[2]};
+                    else if (toPlane_)
+                        p = toPlane_->toENU(wgs[0], wgs[1], wgs[2]);
+                    else
+                        p = toENU(wgs[0], wgs[1], wgs[2], toDatum_, ConversionMode::Exact);
+                }
+            }
+
+          private:
+            geoson::CRS from_, to_;
+            concord::Datum fromDatum_, toDatum_;
+            std::optional<LocalTangentPlane> fromPlane_, toPlane_;
+        };
+
+        /// collect pointers to every position array of a raw GeoJSON geometry
+        inline void collectPositions(nlohmann::json &geom, std::vector<nlohmann::json *> &out) {
+            if (geom.is_null())
+                return;
+            if (geom.value("type", "") == "GeometryCollection") {
+                for (auto &sub : geom.at("geometries"))
+                    collectPositions(sub, out);
+                return;
+            }
+            auto walk = [&](auto &self, nlohmann::json &c) -> void {
+                if (!c.is_array() || c.empty())
+                    return;
+                if (!c.at(0).is_array()) { // a position; malformed ones fail on conversion
+                    out.push_back(&c);
+                    return;
+                }
+                for (auto &sub : c)
+                    self(self, sub);
+            };
+            walk(walk, geom.at("coordinates"));
+        }
+
+        /// convert every coordinate of a batch of raw features: gather all positions, transform them in
+        /// one tight loop, scatter them back
+        inline void transformBatch(std::vector<nlohmann::json> &features, CollectionHeader const &header,
+                                   CoordinateTransform const &xf) {
+            std::vector<nlohmann::json *> refs;
+            for (auto &feat : features) {
+                auto it = feat.find("geometry");
+                if (it == feat.end() || it->is_null())
+                    continue;
+                if (header.quantization)
+                    *it = dequantizeGeometry(*it, *header.quantization);
+                collectPositions(*it, refs);
+            }
+            if (xf.identity() && !header.quantization)
+                return;
+
+            std::vector<std::array<double, 3>> pts(refs.size());
+            for (size_t i = 0; i < refs.size(); ++i) {
+                auto const &c = *refs[i];
+                pts[i] = {c.at(0).get<double>(), c.at(1).get<double>(), c.size() > 2 ? c.at(2).get<double>() : 0.0};
+            }
+            xf.apply(pts);
+            for (size_t i = 0; i < refs.size(); ++i)
+                *refs[i] = nlohmann::json::array({pts[i][0], pts[i][1], pts[i][2]});
+        }
+
+    } // namespace op
+
+    /// Convert a GeoJSON FeatureCollection to another CRS (and/or datum) without loading it: the calling
+    /// thread parses batches of features and writes finished ones out in order, while up to queueDepth
+    /// batches are converted and serialized on the executor, so memory stays at a few batches whatever the
+    /// file size. Properties and feature order are preserved; compact-profile input is written out plain.
+    /// Returns the number of features written. On error the partial output file is removed.
+    inline uint64_t transcode(const std::filesystem::path &in, const std::filesystem::path &out,
+                              geoson::CRS targetCrs, TranscodeOptions const &opts = {}) {
+        GEOSON_TRACE_SCOPE("transcode");
+        FeatureReader reader(in);
+        CollectionHeader const &source = reader.header();
+        CollectionHeader target = source;
+        target.crs = targetCrs;
+        target.quantization.reset();
+        if (opts.datum)
+            target.datum = *opts.datum;
+        op::CoordinateTransform xf(source.crs, source.datum, targetCrs, target.datum, opts.conversion);
+
+        using Batch = std::vector<nlohmann::json>;
+        using Text = std::vector<std::string>;
+        size_t batchSize = opts.batchSize ? opts.batchSize : 1;
+        size_t depth = opts.queueDepth ? opts.queueDepth : 1;
+        std::deque<op::Job<Text>> inflight;
+
+        std::optional<FeatureWriter> writer(std::in_place, out, target, targetCrs);
+        auto writeOldest = [&] {
+            Text text = inflight.front().get();
+            inflight.pop_front();
+            GEOSON_TRACE_SCOPE("transcode/write");
+            for (auto const &feat : text)
+                writer->writeJson(feat);
+        };
+
+        try {
+            bool more = true;
+            while (more) {
+                Batch batch;
+                batch.reserve(batchSize);
+                {
+                    GEOSON_TRACE_SCOPE("transcode/parse");
+                    nlohmann::json feat;
+                    while (batch.size() < batchSize && reader.nextJson(feat))
+                        batch.push_back(std::move(feat));
+                }
+                more = batch.size() == batchSize;
+                if (batch.empty())
+                    break;
+                if (inflight.size() == depth)
+                    writeOldest();
+                inflight.emplace_back(opts.executor, [&source, &xf, batch = std::move(batch)]() mutable {
+                    {
+                        GEOSON_TRACE_SCOPE("transcode/convert");
+                        op::transformBatch(batch, source, xf);
+                    }
+                    GEOSON_TRACE_SCOPE("transcode/serialize");
+                    Text text;
+                    text.reserve(batch.size());
+                    for (auto const &feat : batch)
+                        text.push_back(feat.dump());
+                    return text;
+                });
+            }
+            while (!inflight.empty())
+                writeOldest();
+            writer->close();
+        } catch (...) {
+            // the jobs refer to `source` and `xf`: let them finish before unwinding
+            for (auto &job : inflight) {
+                try {
+                    job.get();
+                } catch (...) {
+                }
+            }
+            writer.reset();
+            std::error_code ec;
+            std::filesystem::remove(out, ec);
+            throw;
+        }
+        return writer->count();
+    }
+
+} // namespace geoson
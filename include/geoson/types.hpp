@@ -2,7 +2,12 @@
 
 #include "concord/concord.hpp" // for Datum, Euler, geometric types
 
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -15,16 +20,94 @@ namespace geoson {
     // Simple CRS representation - used for input parsing and output formatting
     enum class CRS { WGS, ENU };
 
+    // Quantization transform of the compact profile (TopoJSON-style): coordinate = q * scale + translate,
+    // expressed in the file's CRS (x,y,z for ENU, lon,lat,alt for WGS)
+    struct Quantization {
+        std::array<double, 3> scale{0.0, 0.0, 0.0};
+        std::array<double, 3> translate{0.0, 0.0, 0.0};
+    };
+
     struct Feature {
         Geometry geometry;
         std::unordered_map<std::string, std::string> properties;
     };
 
+    /// estimated heap and object bytes held by a loaded collection, by category
+    struct MemoryUsage {
+        size_t coordinates = 0;    // vertex storage of Paths and Polygons (including spare capacity)
+        size_t geometry = 0;       // the geometry variants themselves (Points and Lines live inline)
+        size_t propertyKeys = 0;   // key strings: object plus heap beyond the small-string buffer
+        size_t propertyValues = 0; // value strings, likewise
+        size_t properties = 0;     // hash-table structure: buckets and node overhead
+        size_t indices = 0;        // spatial / attribute indices
+        size_t caches = 0;         // derived data kept for fast queries
+        size_t other = 0;          // containers, spare capacity and bookkeeping
+
+        size_t total() const {
+            return coordinates + geometry + propertyKeys + propertyValues + properties + indices + caches + other;
+        }
+
+        MemoryUsage &operator+=(MemoryUsage const &o) {
+            coordinates += o.coordinates;
+            geometry += o.geometry;
+            propertyKeys += o.propertyKeys;
+            propertyValues += o.propertyValues;
+            properties += o.properties;
+            indices += o.indices;
+            caches += o.caches;
+            other += o.other;
+            return *this;
+        }
+    };
+
+    namespace op {
+        /// heap bytes of a string beyond its inline small-string buffer
+        inline size_t heapBytes(std::string const &s) {
+            static const size_t inlineCapacity = std::string().capacity();
+            return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+        }
+
+        /// account a string-to-string map (not the map object itself, which its owner counts)
+        inline void addMemoryUsage(MemoryUsage &m, std::unordered_map<std::string, std::string> const &props) {
+            // libstdc++-style node: next pointer + cached hash + the pair
+            m.properties += props.bucket_count() * sizeof(void *) + props.size() * (sizeof(void *) + sizeof(size_t));
+            for (auto const &[k, v] : props) {
+                m.propertyKeys += sizeof(std::string) + heapBytes(k);
+                m.propertyValues += sizeof(std::string) + heapBytes(v);
+            }
+        }
+
+        /// account the heap owned by a geometry (the variant object is counted by its owner)
+        inline void addMemoryUsage(MemoryUsage &m, Geometry const &geom) {
+            std::visit(
+                [&](auto const &shape) {
+                    using T = std::decay_t<decltype(shape)>;
+                    if constexpr (std::is_same_v<T, concord::Path> || std::is_same_v<T, concord::Polygon>)
+                        m.coordinates += shape.getPoints().capacity() * sizeof(concord::Point);
+                },
+                geom);
+        }
+    } // namespace op
+
     struct FeatureCollection {
         concord::Datum datum;
         concord::Euler heading;
         std::vector<Feature> features; // All geometries stored in Point (ENU/local) coordinates
         std::unordered_map<std::string, std::string> global_properties; // Global properties for the collection
+
+        /// estimated memory held by the collection, broken down by category
+        MemoryUsage memoryUsage() const {
+            MemoryUsage m;
+            m.other += sizeof(FeatureCollection) + (features.capacity() - features.size()) * sizeof(Feature);
+            for (auto const &f : features) {
+                m.geometry += sizeof(Geometry);
+                m.other += sizeof(Feature) - sizeof(Geometry);
+                op::addMemoryUsage(m, f.geometry);
+                op::addMemoryUsage(m, f.properties);
+            }
+            op::addMemoryUsage(m, global_properties);
+            return m;
+        }
     };
 
 } // namespace geoson
@@ -1,10 +1,21 @@
 #pragma once
 
+#include "config.hpp"
+#include "executor.hpp"
 #include "geoson.hpp"
+#include "geometry.hpp"
+#include "trace.hpp"
 #include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <limits>
+#include <map>
 #include <optional>
+#include <span>
 #include <stdexcept>
+#include <utility>
+#include <variant>
 
 namespace geoson {
 
@@ -18,11 +29,220 @@ namespace geoson {
             : geometry(geom), properties(props), type(elem_type) {}
     };
 
+    class Vector;
+
+    enum class ChangeKind { Added, Removed, GeometryChanged, PropertiesChanged };
+
+    /// one change reported to a Vector's observers
+    struct ElementChange {
+        ChangeKind kind;
+        /// stable element id (see Vector::elementId())
+        uint64_t id;
+        /// Removed, GeometryChanged: bounds before the change (before the batch, if coalesced)
+        BoundingBox oldBox;
+        /// PropertiesChanged: keys set, changed or removed, sorted; "type" also covers Element::type
+        std::vector<std::string> keys;
+    };
+
+    using ChangeObserver = std::function<void(Vector const &, std::span<const ElementChange>)>;
+
+    namespace op {
+        /// Observers of a Vector and the changes of its open batch. Copies and moves start without either;
+        /// assigning a Vector keeps the target's (Vector::operator= reports the replaced elements).
+        struct ChangeLog {
+            struct Pending {
+                uint64_t id;
+                bool added = false, removed = false, geometry = false;
+                BoundingBox oldBox;
+                std::vector<std::string> keys;
+            };
+
+            std::map<size_t, ChangeObserver> observers;
+            size_t nextObserver = 0;
+            int depth = 0;
+            std::vector<Pending> pending;
+            std::unordered_map<uint64_t, size_t> slot; // id -> index into pending
+
+            ChangeLog() = default;
+            ChangeLog(ChangeLog const &) {}
+            ChangeLog &operator=(ChangeLog const &) { return *this; }
+
+            Pending &at(uint64_t id) {
+                auto [it, fresh] = slot.try_emplace(id, pending.size());
+                if (fresh)
+                    pending.push_back(Pending{id});
+                return pending[it->second];
+            }
+
+            void geometryChanged(uint64_t id, BoundingBox const &old) {
+                auto &p = at(id);
+                if (!p.geometry && !p.added)
+                    p.oldBox = old;
+                p.geometry = true;
+            }
+
+            void keyChanged(uint64_t id, std::string const &key) {
+                auto &p = at(id);
+                if (std::find(p.keys.begin(), p.keys.end(), key) == p.keys.end())
+                    p.keys.push_back(key);
+            }
+
+            /// the coalesced changes, in the order elements were first touched; clears the batch
+            std::vector<ElementChange> take() {
+                std::vector<ElementChange> out;
+                for (auto &p : pending) {
+                    if (p.added && p.removed)
+                        continue;
+                    if (p.added) {
+                        out.push_back({ChangeKind::Added, p.id, {}, {}});
+                    } else if (p.removed) {
+                        out.push_back({ChangeKind::Removed, p.id, p.oldBox, {}});
+                    } else {
+                        if (p.geometry)
+                            out.push_back({ChangeKind::GeometryChanged, p.id, p.oldBox, {}});
+                        if (!p.keys.empty()) {
+                            std::sort(p.keys.begin(), p.keys.end());
+                            out.push_back({ChangeKind::PropertiesChanged, p.id, {}, std::move(p.keys)});
+                        }
+                    }
+                }
+                pending.clear();
+                slot.clear();
+                return out;
+            }
+        };
+
+        // Inverses of the recorded mutations: applying one undoes the mutation it was recorded for.
+        // Elements are addressed by stable id; only an insertion needs the index the element had.
+        struct UndoAdd {
+            uint64_t id;
+        };
+        struct UndoRemove {
+            size_t index;
+            uint64_t id;
+            Element element;
+        };
+        struct UndoReplace {
+            uint64_t id;
+            Element element;
+        };
+        struct UndoGeometry {
+            uint64_t id;
+            Geometry geometry;
+        };
+        /// `value` is the previous one; empty if the key was absent
+        struct UndoProperty {
+            uint64_t id;
+            std::string key;
+            std::optional<std::string> value;
+        };
+        struct UndoFieldProperty {
+            std::string key;
+            std::optional<std::string> value;
+        };
+        struct UndoGlobalProperty {
+            std::string key;
+            std::optional<std::string> value;
+        };
+        struct UndoFieldBoundary {
+            concord::Polygon boundary;
+        };
+        struct UndoDatum {
+            concord::Datum datum;
+        };
+        struct UndoHeading {
+            concord::Euler heading;
+        };
+        struct UndoCRS {
+            CRS crs;
+        };
+        using UndoStep = std::variant<UndoAdd, UndoRemove, UndoReplace, UndoGeometry, UndoProperty, UndoFieldProperty,
+                                      UndoGlobalProperty, UndoFieldBoundary, UndoDatum, UndoHeading,
+                                      UndoCRS>;
+
+        /// one committed edit: the inverse steps in the order their mutations were made
+        struct Edit {
+            std::string label;
+            std::vector<UndoStep> steps;
+            size_t bytes = 0;
+        };
+
+        inline std::optional<std::string> valueOf(std::unordered_map<std::string, std::string> const &map,
+                                                  std::string const &key) {
+            auto it = map.find(key);
+            if (it == map.end())
+                return std::nullopt;
+            return it->second;
+        }
+
+        /// heap held by an edit, estimated like Vector::memoryUsage()
+        inline size_t editBytes(Edit const &edit) {
+            MemoryUsage m;
+            m.other += sizeof(Edit) + heapBytes(edit.label) + edit.steps.capacity() * sizeof(UndoStep);
+            for (auto const &step : edit.steps)
+                std::visit(
+                    [&](auto const &s) {
+                        using T = std::decay_t<decltype(s)>;
+                        if constexpr (std::is_same_v<T, UndoRemove> || std::is_same_v<T, UndoReplace>) {
+                            addMemoryUsage(m, s.element.geometry);
+                            addMemoryUsage(m, s.element.properties);
+                            m.other += heapBytes(s.element.type);
+                        } else if constexpr (std::is_same_v<T, UndoGeometry>) {
+                            addMemoryUsage(m, s.geometry);
+                        } else if constexpr (std::is_same_v<T, UndoProperty> || std::is_same_v<T, UndoFieldProperty> ||
+                                             std::is_same_v<T, UndoGlobalProperty>) {
+                            m.propertyKeys += heapBytes(s.key);
+                            m.propertyValues += s.value ? heapBytes(*s.value) : 0;
+                        } else if constexpr (std::is_same_v<T, UndoFieldBoundary>) {
+                            m.coordinates += s.boundary.getPoints().capacity() * sizeof(concord::Point);
+                        }
+                    },
+                    step);
+            return m.total();
+        }
+
+        /// Undo and redo stacks of a Vector and its open edit. Copies and moves start without them, and
+        /// assignment drops the target's: its steps address elements by ids the new contents do not share.
+        struct EditHistory {
+            std::optional<Edit> open;
+            std::deque<Edit> undo;
+            std::vector<Edit> redo;
+            size_t bytes = 0; // of undo and redo
+            size_t limit = std::numeric_limits<size_t>::max();
+
+            EditHistory() = default;
+            EditHistory(EditHistory const &) {}
+            EditHistory &operator=(EditHistory const &) {
+                open.reset();
+                clear();
+                return *this;
+            }
+
+            bool empty() const { return undo.empty() && redo.empty(); }
+            void clear() {
+                undo.clear();
+                redo.clear();
+                bytes = 0;
+            }
+            /// drop the oldest edits beyond the byte limit, always keeping the newest
+            void trim() {
+                while (bytes > limit && undo.size() > 1) {
+                    bytes -= undo.front().bytes;
+                    undo.pop_front();
+                }
+            }
+        };
+    } // namespace op
+
     class Vector {
       private:
         concord::Polygon field_boundary_;
         std::unordered_map<std::string, std::string> field_properties_;
         std::vector<Element> elements_;
+        std::vector<uint64_t> ids_; // parallel to elements_, ascending
+        uint64_t nextId_ = 0;
+        op::ChangeLog changes_;
+        op::EditHistory history_;
 
         concord::Datum datum_;
         concord::Euler heading_;
@@ -31,98 +251,191 @@ namespace geoson {
         // Global properties for the entire vector collection
         std::unordered_map<std::string, std::string> global_properties_;
 
-      public:
-        Vector() = delete;
+        bool observed() const { return !changes_.observers.empty(); }
+        bool recording() const { return history_.open.has_value(); }
 
-        explicit Vector(const concord::Polygon &field_boundary,
-                        const concord::Datum &datum = concord::Datum{0.001, 0.001, 1.0},
-                        const concord::Euler &heading = concord::Euler{0, 0, 0}, CRS crs = CRS::ENU)
-            : field_boundary_(field_boundary), datum_(datum), heading_(heading), crs_(crs) {}
+        /// Add the step `make()` builds to the open edit. A mutation outside an edit cannot be undone, and
+        /// the history recorded before it no longer applies, so it is dropped.
+        template <typename Make> void record(Make &&make) {
+            if (history_.open)
+                history_.open->steps.emplace_back(make());
+            else if (!history_.empty())
+                history_.clear();
+        }
 
-        static Vector fromFile(const std::filesystem::path &path) {
-            auto fc = geoson::read(path);
+        /// apply the inverse steps of `edit`, newest first, returning the edit that reverts them in turn
+        op::Edit replay(op::Edit edit);
+        void undoStep(op::UndoStep &&step);
+        size_t indexOfRecorded(uint64_t id) const;
+        void insertElement(size_t index, uint64_t id, Element element);
 
-            if (fc.features.empty()) {
-                throw std::runtime_error("Vector::fromFile: No features found in file");
-            }
+        void assignIds() {
+            while (ids_.size() < elements_.size())
+                ids_.push_back(nextId_++);
+        }
 
-            std::optional<std::pair<concord::Polygon, std::unordered_map<std::string, std::string>>> field_data;
+        void noteRemoved(size_t index) {
+            auto &p = changes_.at(ids_[index]);
+            if (!p.geometry && !p.added)
+                p.oldBox = boundingBox(elements_[index].geometry);
+            p.removed = true;
+        }
 
-            // First, look for a feature explicitly marked as "field"
-            for (const auto &feature : fc.features) {
-                if (std::holds_alternative<concord::Polygon>(feature.geometry)) {
-                    auto it = feature.properties.find("type");
-                    if (it != feature.properties.end() && it->second == "field") {
-                        field_data = std::make_pair(std::get<concord::Polygon>(feature.geometry), feature.properties);
-                        break;
-                    }
-                }
+        void noteReplaced(size_t index, Element const &before) {
+            Element const &after = elements_[index];
+            uint64_t id = ids_[index];
+            auto va = vertices(before.geometry), vb = vertices(after.geometry);
+            bool same = before.geometry.index() == after.geometry.index() &&
+                        std::equal(va.begin(), va.end(), vb.begin(), vb.end(), [](auto const &p, auto const &q) {
+                            return p.x == q.x && p.y == q.y && p.z == q.z;
+                        });
+            if (!same)
+                changes_.geometryChanged(id, boundingBox(before.geometry));
+            for (auto const &[key, value] : before.properties) {
+                auto it = after.properties.find(key);
+                if (it == after.properties.end() || it->second != value)
+                    changes_.keyChanged(id, key);
             }
+            for (auto const &[key, value] : after.properties)
+                if (!before.properties.count(key))
+                    changes_.keyChanged(id, key);
+            if (before.type != after.type)
+                changes_.keyChanged(id, "type");
+        }
 
-            // If no explicit field found, use the first polygon
-            if (!field_data) {
-                for (const auto &feature : fc.features) {
-                    if (std::holds_alternative<concord::Polygon>(feature.geometry)) {
-                        field_data = std::make_pair(std::get<concord::Polygon>(feature.geometry), feature.properties);
-                        break;
-                    }
-                }
-            }
+        /// deliver the pending changes unless a batch is open
+        void notify() {
+            if (changes_.depth > 0 || changes_.pending.empty())
+                return;
+            auto changes = changes_.take();
+            if (changes.empty())
+                return;
+            auto observers = changes_.observers; // observers may unsubscribe or edit from the callback
+            for (auto const &[handle, fn] : observers)
+                fn(*this, changes);
+        }
 
-            if (!field_data) {
-                throw std::runtime_error("Vector::fromFile: No polygon found to use as field boundary");
+      public:
+        /// Coalesces the changes made while it is alive into one notification, delivered when the outermost
+        /// batch ends. Obtained from Vector::batch().
+        class Batch {
+          public:
+            explicit Batch(Vector &v) : vector_(&v) { ++v.changes_.depth; }
+            Batch(Batch &&o) noexcept : vector_(std::exchange(o.vector_, nullptr)) {}
+            Batch(Batch const &) = delete;
+            Batch &operator=(Batch const &) = delete;
+            Batch &operator=(Batch &&) = delete;
+            ~Batch() {
+                if (vector_ && --vector_->changes_.depth == 0)
+                    vector_->notify();
             }
 
-            Vector vector(field_data->first, fc.datum, fc.heading);
-            vector.field_properties_ = field_data->second;
-            vector.global_properties_ = fc.global_properties;
-
-            // Add all other features as elements (exclude the field boundary)
-            for (const auto &feature : fc.features) {
-                // Skip features that are explicitly marked as "field" type
-                auto type_it = feature.properties.find("type");
-                bool isExplicitField = (type_it != feature.properties.end() && type_it->second == "field");
+          private:
+            Vector *vector_;
+        };
 
-                if (!isExplicitField) {
-                    std::string elem_type = "unknown";
-                    if (type_it != feature.properties.end()) {
-                        elem_type = type_it->second;
-                    }
-
-                    vector.elements_.emplace_back(feature.geometry, feature.properties, elem_type);
-                }
-            }
-
-            return vector;
-        }
+        Vector() = delete;
 
-        void toFile(const std::filesystem::path &path, CRS outputCrs = CRS::ENU) const {
-            FeatureCollection fc;
-            fc.datum = datum_;
-            fc.heading = heading_;
-            fc.global_properties = global_properties_;
+        explicit Vector(const concord::Polygon &field_boundary,
+                        const concord::Datum &datum = concord::Datum{0.001, 0.001, 1.0},
+                        const concord::Euler &heading = concord::Euler{0, 0, 0}, CRS crs = CRS::ENU)
+            : field_boundary_(field_boundary), datum_(datum), heading_(heading), crs_(crs) {}
 
-            auto field_props = field_properties_;
-            field_props["type"] = "field";
-            fc.features.emplace_back(Feature{field_boundary_, field_props});
+        Vector(Vector const &) = default;
+        Vector(Vector &&) = default;
+        /// Replace the contents with those of `other`. The target keeps its observers, which are told that
+        /// each old element was Removed and each new one Added; the new elements get fresh ids above any
+        /// either vector has handed out.
+        Vector &operator=(Vector const &other);
+        Vector &operator=(Vector &&other);
 
-            for (const auto &element : elements_) {
-                fc.features.emplace_back(Feature{element.geometry, element.properties});
-            }
+        static Vector fromFile(const std::filesystem::path &path);
 
-            geoson::write(fc, path, outputCrs);
-        }
+        void toFile(const std::filesystem::path &path, CRS outputCrs = CRS::ENU) const;
 
         const concord::Polygon &getFieldBoundary() const { return field_boundary_; }
-        void setFieldBoundary(const concord::Polygon &boundary) { field_boundary_ = boundary; }
+        void setFieldBoundary(const concord::Polygon &boundary) {
+            record([&] { return op::UndoFieldBoundary{field_boundary_}; });
+            field_boundary_ = boundary;
+        }
 
         const std::unordered_map<std::string, std::string> &getFieldProperties() const { return field_properties_; }
-        void setFieldProperty(const std::string &key, const std::string &value) { field_properties_[key] = value; }
-        void removeFieldProperty(const std::string &key) { field_properties_.erase(key); }
+        void setFieldProperty(const std::string &key, const std::string &value) {
+            record([&] { return op::UndoFieldProperty{key, op::valueOf(field_properties_, key)}; });
+            field_properties_[key] = value;
+        }
+        void removeFieldProperty(const std::string &key) {
+            record([&] { return op::UndoFieldProperty{key, op::valueOf(field_properties_, key)}; });
+            field_properties_.erase(key);
+        }
 
         size_t elementCount() const { return elements_.size(); }
         bool hasElements() const { return !elements_.empty(); }
-        void clearElements() { elements_.clear(); }
+        void clearElements() {
+            if (observed())
+                for (size_t i = 0; i < elements_.size(); ++i)
+                    noteRemoved(i);
+            for (size_t i = elements_.size(); i-- > 0;) // as if removed back to front
+                record([&] { return op::UndoRemove{i, ids_[i], std::move(elements_[i])}; });
+            elements_.clear();
+            ids_.clear();
+            notify();
+        }
+
+        /// Stable id of the element at `index`: assigned when the element is added, kept while it moves down
+        /// as earlier elements are removed, never reused. Ids ascend with the index.
+        uint64_t elementId(size_t index) const {
+            if (index >= ids_.size())
+                throw std::out_of_range("Element index out of range");
+            return ids_[index];
+        }
+        /// current index of the element with `id`, if it is still there
+        std::optional<size_t> indexOf(uint64_t id) const {
+            auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+            if (it == ids_.end() || *it != id)
+                return std::nullopt;
+            return static_cast<size_t>(it - ids_.begin());
+        }
+
+        /// Subscribe to element changes: `fn` is called on the mutating thread after each observed mutation,
+        /// or once at the end of a batch(), with the changes since the last call. Changes made through the
+        /// references returned by getElement() or the iterators are not seen; use replaceElement(),
+        /// editElement() and the setters below instead. Returns a handle for unsubscribe().
+        size_t subscribe(ChangeObserver fn) {
+            changes_.observers[++changes_.nextObserver] = std::move(fn);
+            return changes_.nextObserver;
+        }
+        void unsubscribe(size_t handle) { changes_.observers.erase(handle); }
+
+        /// hold to coalesce a series of edits into one notification
+        [[nodiscard]] Batch batch() { return Batch(*this); }
+
+        /// Start recording an undoable edit. The mutations until commit() are undone and redone together and
+        /// reach the observers as one batch. Throws std::logic_error if an edit is already open.
+        void beginEdit(std::string label = "");
+        /// close the open edit and push it on the undo stack; clears the redo stack
+        void commit();
+        /// revert the mutations of the open edit and close it
+        void rollback();
+        bool editing() const { return recording(); }
+
+        /// revert the newest committed edit; false if there is none
+        bool undo();
+        /// reapply the newest undone edit; false if there is none
+        bool redo();
+        bool canUndo() const { return !history_.undo.empty(); }
+        bool canRedo() const { return !history_.redo.empty(); }
+        /// labels of the edits undo() and redo() would apply ("" if none)
+        std::string undoLabel() const { return canUndo() ? history_.undo.back().label : ""; }
+        std::string redoLabel() const { return canRedo() ? history_.redo.back().label : ""; }
+        /// memory held by the undo and redo stacks
+        size_t historyBytes() const { return history_.bytes; }
+        /// Cap historyBytes(): the oldest edits are forgotten beyond it, though the newest is always kept
+        void setHistoryLimit(size_t bytes) {
+            history_.limit = bytes;
+            history_.trim();
+        }
+        void clearHistory() { history_.clear(); }
 
         const Element &getElement(size_t index) const {
             if (index >= elements_.size())
@@ -142,15 +455,88 @@ namespace geoson {
             if (!type.empty()) {
                 props["type"] = type;
             }
-            elements_.emplace_back(geometry, props, type);
+            appendElement(Element(geometry, props, type));
+        }
+
+        /// append `element` as it is: unlike addElement(), its type is not copied into its properties
+        void appendElement(Element element) {
+            elements_.push_back(std::move(element));
+            ids_.push_back(nextId_++);
+            record([&] { return op::UndoAdd{ids_.back()}; });
+            if (observed()) {
+                changes_.at(ids_.back()).added = true;
+                notify();
+            }
         }
 
         void removeElement(size_t index) {
             if (index < elements_.size()) {
+                if (observed())
+                    noteRemoved(index);
+                record([&] { return op::UndoRemove{index, ids_[index], std::move(elements_[index])}; });
                 elements_.erase(elements_.begin() + index);
+                ids_.erase(ids_.begin() + index);
+                notify();
             }
         }
 
+        /// replace the element at `index`, keeping its id
+        void replaceElement(size_t index, Element element) {
+            Element before = std::exchange(getElement(index), std::move(element));
+            if (observed())
+                noteReplaced(index, before);
+            record([&] { return op::UndoReplace{ids_[index], std::move(before)}; });
+            notify();
+        }
+
+        /// edit the element at `index` in place through `fn(Element &)`; the observers are told what differs
+        template <typename Fn> void editElement(size_t index, Fn &&fn) {
+            Element &e = getElement(index);
+            if (!observed() && !recording()) {
+                history_.clear(); // not recording, so the history no longer applies
+                fn(e);
+                return;
+            }
+            Element before = e;
+            fn(e);
+            if (observed())
+                noteReplaced(index, before);
+            record([&] { return op::UndoReplace{ids_[index], std::move(before)}; });
+            notify();
+        }
+
+        void setElementGeometry(size_t index, const Geometry &geometry) {
+            Element &e = getElement(index);
+            if (observed())
+                changes_.geometryChanged(ids_[index], boundingBox(e.geometry));
+            record([&] { return op::UndoGeometry{ids_[index], std::move(e.geometry)}; });
+            e.geometry = geometry;
+            notify();
+        }
+
+        void setElementProperty(size_t index, const std::string &key, const std::string &value) {
+            auto &props = getElement(index).properties;
+            auto it = props.find(key);
+            if (it != props.end() && it->second == value)
+                return;
+            record([&] { return op::UndoProperty{ids_[index], key, op::valueOf(props, key)}; });
+            props[key] = value;
+            if (observed())
+                changes_.keyChanged(ids_[index], key);
+            notify();
+        }
+
+        void removeElementProperty(size_t index, const std::string &key) {
+            auto &props = getElement(index).properties;
+            if (!props.count(key))
+                return;
+            record([&] { return op::UndoProperty{ids_[index], key, op::valueOf(props, key)}; });
+            props.erase(key);
+            if (observed())
+                changes_.keyChanged(ids_[index], key);
+            notify();
+        }
+
         void addPoint(const concord::Point &point, const std::string &type = "point",
                       const std::unordered_map<std::string, std::string> &properties = {}) {
             addElement(point, type, properties);
@@ -171,84 +557,54 @@ namespace geoson {
             addElement(polygon, type, properties);
         }
 
-        std::vector<Element> getElementsByType(const std::string &type) const {
-            std::vector<Element> result;
-            for (const auto &element : elements_) {
-                if (element.type == type) {
-                    result.push_back(element);
-                }
-            }
-            return result;
-        }
-
-        std::vector<Element> getPoints() const {
-            std::vector<Element> result;
-            for (const auto &element : elements_) {
-                if (std::holds_alternative<concord::Point>(element.geometry)) {
-                    result.push_back(element);
-                }
-            }
-            return result;
-        }
-
-        std::vector<Element> getLines() const {
-            std::vector<Element> result;
-            for (const auto &element : elements_) {
-                if (std::holds_alternative<concord::Line>(element.geometry)) {
-                    result.push_back(element);
-                }
-            }
-            return result;
-        }
-
-        std::vector<Element> getPaths() const {
-            std::vector<Element> result;
-            for (const auto &element : elements_) {
-                if (std::holds_alternative<concord::Path>(element.geometry)) {
-                    result.push_back(element);
-                }
-            }
-            return result;
-        }
-
-        std::vector<Element> getPolygons() const {
-            std::vector<Element> result;
-            for (const auto &element : elements_) {
-                if (std::holds_alternative<concord::Polygon>(element.geometry)) {
-                    result.push_back(element);
-                }
-            }
-            return result;
-        }
-
-        std::vector<Element> filterByProperty(const std::string &key, const std::string &value) const {
-            std::vector<Element> result;
-            for (const auto &element : elements_) {
-                auto it = element.properties.find(key);
-                if (it != element.properties.end() && it->second == value) {
-                    result.push_back(element);
-                }
-            }
-            return result;
-        }
+        // Queries taking an Executor scan the elements in chunks on it (null: on the calling thread);
+        // results keep element order either way.
+        std::vector<Element> getElementsByType(const std::string &type, Executor *executor = nullptr) const;
+        std::vector<Element> getPoints() const;
+        std::vector<Element> getLines() const;
+        std::vector<Element> getPaths() const;
+        std::vector<Element> getPolygons() const;
+        std::vector<Element> filterByProperty(const std::string &key, const std::string &value,
+                                              Executor *executor = nullptr) const;
+        /// copies of the elements for which `pred` holds; `pred` must be safe to call concurrently
+        std::vector<Element> filter(const std::function<bool(const Element &)> &pred,
+                                    Executor *executor = nullptr) const;
 
         const concord::Datum &getDatum() const { return datum_; }
-        void setDatum(const concord::Datum &datum) { datum_ = datum; }
+        void setDatum(const concord::Datum &datum) {
+            record([&] { return op::UndoDatum{datum_}; });
+            datum_ = datum;
+        }
 
         const concord::Euler &getHeading() const { return heading_; }
-        void setHeading(const concord::Euler &heading) { heading_ = heading; }
+        void setHeading(const concord::Euler &heading) {
+            record([&] { return op::UndoHeading{heading_}; });
+            heading_ = heading;
+        }
 
         CRS getCRS() const { return crs_; }
-        void setCRS(CRS crs) { crs_ = crs; }
+        void setCRS(CRS crs) {
+            record([&] { return op::UndoCRS{crs_}; });
+            crs_ = crs;
+        }
 
         // Global properties management
-        void setGlobalProperty(const std::string &key, const std::string &value) { global_properties_[key] = value; }
+        void setGlobalProperty(const std::string &key, const std::string &value) {
+            record([&] { return op::UndoGlobalProperty{key, op::valueOf(global_properties_, key)}; });
+            global_properties_[key] = value;
+        }
         std::string getGlobalProperty(const std::string &key, const std::string &default_value = "") const {
             auto it = global_properties_.find(key);
             return (it != global_properties_.end()) ? it->second : default_value;
         }
         const std::unordered_map<std::string, std::string> &getGlobalProperties() const { return global_properties_; }
-        void removeGlobalProperty(const std::string &key) { global_properties_.erase(key); }
+        void removeGlobalProperty(const std::string &key) {
+            record([&] { return op::UndoGlobalProperty{key, op::valueOf(global_properties_, key)}; });
+            global_properties_.erase(key);
+        }
+
+        /// estimated memory held by the vector, broken down by category
+        MemoryUsage memoryUsage() const;
 
         auto begin() { return elements_.begin(); }
         auto end() { return elements_.end(); }
@@ -259,3 +615,7 @@ namespace geoson {
     };
 
 } // namespace geoson
+
+#if !defined(GEOSON_COMPILED_LIBRARY)
+#include "geoson/impl/vector.ipp"
+#endif
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "geoson/geometry.hpp"
+#include "geoson/vector.hpp"
+
+// Keeping a loaded Vector in step with its file while it is being edited. applyUpdate() matches the
+// elements of a fresh parse against the current ones by id (or by content) and changes only what differs;
+// VectorWatcher (Linux, inotify) calls it whenever the file settles after a write and tells subscribers
+// what changed.
+
+namespace geoson {
+
+    /// what applyUpdate() changed. `removed` indexes the vector as it was; `changed` and `added` index it
+    /// as it is now (removals shift later elements down, additions are appended)
+    struct VectorDiff {
+        std::vector<size_t> removed;
+        std::vector<size_t> changed;
+        std::vector<size_t> added;
+        /// field boundary, field or global properties, datum or heading differ
+        bool headerChanged = false;
+
+        bool empty() const { return removed.empty() && changed.empty() && added.empty() && !headerChanged; }
+    };
+
+    namespace op {
+        inline void hashBytes(uint64_t &h, const void *data, size_t n) {
+            auto const *p = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < n; ++i) {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+        }
+
+        /// content hash of an element: geometry kind and coordinates, type and properties (order-independent)
+        inline uint64_t hashElement(Element const &e) {
+            uint64_t h = 1469598103934665603ull;
+            size_t kind = e.geometry.index();
+            hashBytes(h, &kind, sizeof kind);
+            forEachVertex(e.geometry, [&](concord::Point const &p) {
+                double xyz[3] = {p.x, p.y, p.z};
+                hashBytes(h, xyz, sizeof xyz);
+            });
+            hashBytes(h, e.type.data(), e.type.size());
+            uint64_t props = 0;
+            for (auto const &[key, value] : e.properties) {
+                uint64_t kv = 1469598103934665603ull;
+                hashBytes(kv, key.data(), key.size());
+                hashBytes(kv, "=", 1);
+                hashBytes(kv, value.data(), value.size());
+                props += kv; // commutative: unordered_map iteration order is arbitrary
+            }
+            hashBytes(h, &props, sizeof props);
+            return h;
+        }
+
+        inline bool samePoints(std::vector<concord::Point> const &a, std::vector<concord::Point> const &b) {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto const &p, auto const &q) {
+                return p.x == q.x && p.y == q.y && p.z == q.z;
+            });
+        }
+    } // namespace op
+
+    /// Bring `target` in line with `updated` (typically a fresh Vector::fromFile() of the same file) while
+    /// touching only what differs. Elements are matched by the `idProperty` property when they have one, by
+    /// content otherwise; a matched element whose content differs is replaced in place. Unmatched elements
+    /// of `target` are removed and unmatched ones of `updated` appended, in file order.
+    inline VectorDiff applyUpdate(Vector &target, Vector const &updated, std::string const &idProperty = "id") {
+        auto keyOf = [&](Element const &e, uint64_t hash) {
+            if (!idProperty.empty())
+                if (auto it = e.properties.find(idProperty); it != e.properties.end())
+                    return "id:" + it->second;
+            return "hash:" + std::to_string(hash);
+        };
+
+        // unmatched old elements by key, in order
+        std::unordered_map<std::string, std::vector<size_t>> pool;
+        std::vector<uint64_t> oldHash(target.elementCount());
+        for (size_t i = target.elementCount(); i-- > 0;) {
+            oldHash[i] = op::hashElement(target.getElement(i));
+            pool[keyOf(target.getElement(i), oldHash[i])].push_back(i); // reversed: back() is the first
+        }
+
+        std::vector<std::pair<size_t, size_t>> changed; // old index, updated index
+        std::vector<size_t> added;                      // updated index
+        std::vector<bool> kept(target.elementCount(), false);
+        for (size_t j = 0; j < updated.elementCount(); ++j) {
+            auto const &e = updated.getElement(j);
+            uint64_t h = op::hashElement(e);
+            auto it = pool.find(keyOf(e, h));
+            if (it == pool.end() || it->second.empty()) {
+                added.push_back(j);
+                continue;
+            }
+            size_t i = it->second.back();
+            it->second.pop_back();
+            kept[i] = true;
+            if (oldHash[i] != h)
+                changed.emplace_back(i, j);
+        }
+
+        VectorDiff diff;
+        for (size_t i = 0; i < kept.size(); ++i)
+            if (!kept[i])
+                diff.removed.push_back(i);
+
+        // replace in place, then remove back to front, then append; the target's observers hear of it once
+        auto batch = target.batch();
+        for (auto [i, j] : changed)
+            target.replaceElement(i, updated.getElement(j));
+        for (auto it = diff.removed.rbegin(); it != diff.removed.rend(); ++it)
+            target.removeElement(*it);
+        for (auto [i, j] : changed)
+            diff.changed.push_back(i - (std::lower_bound(diff.removed.begin(), diff.removed.end(), i) -
+                                        diff.removed.begin()));
+        std::sort(diff.changed.begin(), diff.changed.end());
+        for (size_t j : added) {
+            diff.added.push_back(target.elementCount());
+            target.appendElement(updated.getElement(j));
+        }
+
+        auto const &d0 = target.getDatum(), &d1 = updated.getDatum();
+        diff.headerChanged = !op::samePoints(target.getFieldBoundary().getPoints(),
+                                             updated.getFieldBoundary().getPoints()) ||
+                             target.getFieldProperties() != updated.getFieldProperties() ||
+                             target.getGlobalProperties() != updated.getGlobalProperties() || d0.lat != d1.lat ||
+                             d0.lon != d1.lon || d0.alt != d1.alt ||
+                             target.getHeading().yaw != updated.getHeading().yaw;
+        if (diff.headerChanged) {
+            auto stale = [](auto const &from, auto const &to) {
+                std::vector<std::string> keys;
+                for (auto const &[key, value] : from)
+                    if (!to.count(key))
+                        keys.push_back(key);
+                return keys;
+            };
+            target.setFieldBoundary(updated.getFieldBoundary());
+            for (auto const &key : stale(target.getFieldProperties(), updated.getFieldProperties()))
+                target.removeFieldProperty(key);
+            for (auto const &[key, value] : updated.getFieldProperties())
+                target.setFieldProperty(key, value);
+            for (auto const &key : stale(target.getGlobalProperties(), updated.getGlobalProperties()))
+                target.removeGlobalProperty(key);
+            for (auto const &[key, value] : updated.getGlobalProperties())
+                target.setGlobalProperty(key, value);
+            target.setDatum(updated.getDatum());
+            target.setHeading(updated.getHeading());
+        }
+        return diff;
+    }
+
+#if defined(__linux__)
+
+    struct WatchOptions {
+        /// quiet time after the last write before the file is re-read, so a save in several writes (or a
+        /// write-to-temp-and-rename) is picked up once, complete
+        std::chrono::milliseconds debounce{200};
+        /// property identifying an element across versions of the file (see applyUpdate())
+        std::string idProperty = "id";
+        /// called on the watcher thread when a reload fails (e.g. the file is not valid yet); the vector
+        /// keeps its previous state. Also called, with a std::system_error, when waiting for events fails:
+        /// the watcher then stops and no further reloads happen
+        std::function<void(std::exception_ptr)> onError;
+    };
+
+    /// Watches a file with inotify and applies its changes to a Vector on a background thread. Subscribers
+    /// are called on that thread, with the vector locked, after each reload that changed something; other
+    /// threads reading the vector meanwhile should hold lock().
+    class VectorWatcher {
+      public:
+        using Callback = std::function<void(Vector const &, VectorDiff const &)>;
+
+        VectorWatcher(std::filesystem::path file, Vector &vector, WatchOptions opts = {})
+            : file_(std::filesystem::absolute(std::move(file))), vector_(vector), opts_(std::move(opts)) {
+            inotify_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+            wake_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (inotify_ < 0 || wake_ < 0) {
+                closeFds();
+                throw std::runtime_error("geoson::VectorWatcher(): " + std::string(std::strerror(errno)));
+            }
+            // watch the directory: editors often save by writing a temporary file and renaming it over
+            auto dir = file_.parent_path();
+            if (inotify_add_watch(inotify_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY) < 0) {
+                auto err = std::string(std::strerror(errno));
+                closeFds();
+                throw std::runtime_error("geoson::VectorWatcher(): cannot watch " + dir.string() + ": " + err);
+            }
+            thread_ = std::thread([this] { run(); });
+        }
+
+        VectorWatcher(VectorWatcher const &) = delete;
+        VectorWatcher &operator=(VectorWatcher const &) = delete;
+
+        ~VectorWatcher() {
+            uint64_t one = 1;
+            [[maybe_unused]] auto n = ::write(wake_, &one, sizeof one);
+            thread_.join();
+            closeFds();
+        }
+
+        /// returns an id for unsubscribe()
+        size_t subscribe(Callback cb) {
+            std::lock_guard lock(mutex_);
+            callbacks_[++nextId_] = std::move(cb);
+            return nextId_;
+        }
+        void unsubscribe(size_t id) {
+            std::lock_guard lock(mutex_);
+            callbacks_.erase(id);
+        }
+
+        /// hold while reading the vector from another thread
+        std::unique_lock<std::recursive_mutex> lock() { return std::unique_lock(mutex_); }
+
+        /// re-read the file now and apply its changes; throws if it cannot be parsed
+        VectorDiff reload() {
+            auto updated = Vector::fromFile(file_); // parsed outside the lock
+            std::lock_guard lock(mutex_);
+            auto diff = applyUpdate(vector_, updated, opts_.idProperty);
+            ++reloads_;
+            if (!diff.empty())
+                for (auto const &[id, cb] : callbacks_)
+                    cb(vector_, diff);
+            return diff;
+        }
+
+        /// reloads performed so far
+        uint64_t reloads() const { return reloads_; }
+
+      private:
+        void closeFds() {
+            if (inotify_ >= 0)
+                ::close(inotify_);
+            if (wake_ >= 0)
+                ::close(wake_);
+            inotify_ = wake_ = -1;
+        }
+
+        /// drain pending events; true if one concerns the watched file or the kernel dropped events (queue
+        /// overflow), in which case the file may have changed unseen
+        bool drain() {
+            bool relevant = false;
+            alignas(inotify_event) char buf[4096];
+            ssize_t n;
+            while ((n = ::read(inotify_, buf, sizeof buf)) > 0) {
+                for (char *p = buf; p < buf + n;) {
+                    auto const *ev = reinterpret_cast<inotify_event const *>(p);
+                    if ((ev->mask & IN_Q_OVERFLOW) || (ev->len && file_.filename() == ev->name))
+                        relevant = true;
+                    p += sizeof(inotify_event) + ev->len;
+                }
+            }
+            return relevant;
+        }
+
+        void run() {
+            using Clock = std::chrono::steady_clock;
+            pollfd fds[2] = {{inotify_, POLLIN, 0}, {wake_, POLLIN, 0}};
+            // set while a change of the watched file is pending: reload once it has been quiet until then.
+            // Events for other files in the directory neither set nor postpone it
+            std::optional<Clock::time_point> deadline;
+            while (true) {
+                int timeout = -1;
+                if (deadline) {
+                    auto left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - Clock::now());
+                    timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(left.count(), 0));
+                }
+                int ready = ::poll(fds, 2, timeout);
+                if (ready < 0 && errno != EINTR) {
+                    if (opts_.onError)
+                        opts_.onError(std::make_exception_ptr(
+                            std::system_error(errno, std::generic_category(), "geoson::VectorWatcher: poll")));
+                    return;
+                }
+                if (fds[1].revents & POLLIN)
+                    return;
+                if (ready > 0 && (fds[0].revents & POLLIN) && drain())
+                    deadline = Clock::now() + opts_.debounce;
+                if (deadline && Clock::now() >= *deadline) {
+                    deadline.reset();
+                    try {
+                        reload();
+                    } catch (...) {
+                        if (opts_.onError)
+                            opts_.onError(std::current_exception());
+                    }
+                }
+            }
+        }
+
+        std::filesystem::path file_;
+        Vector &vector_;
+        WatchOptions opts_;
+        int inotify_ = -1, wake_ = -1;
+        std::recursive_mutex mutex_;
+        std::map<size_t, Callback> callbacks_;
+        size_t nextId_ = 0;
+        std::atomic<uint64_t> reloads_{0};
+        std::thread thread_;
+    };
+
+#endif
+
+} // namespace geoson
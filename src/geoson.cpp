@@ -0,0 +1,12 @@
+// The compiled half of the `geoson_static` library: every out-of-line implementation, built once with
+// GEOSON_COMPILED_LIBRARY defined, plus the single instantiation of nlohmann::json the headers declare
+// extern in that mode.
+
+#include "geoson/json.hpp"
+
+template class nlohmann::basic_json<>;
+
+#include "geoson/impl/parser.ipp"
+#include "geoson/impl/trace.ipp"
+#include "geoson/impl/vector.ipp"
+#include "geoson/impl/writter.ipp"
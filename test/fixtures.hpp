@@ -0,0 +1,48 @@
+#pragma once
+
+// Collections and Vectors shared by the tests. Shapes specific to one test stay in that test.
+
+#include "geoson/generate.hpp"
+#include "geoson/vector.hpp"
+#include <string>
+
+namespace fixtures {
+
+    inline const concord::Datum kDatum{52.0, 5.0, 2.0};
+
+    /// `n` seeded features from geoson::generate() around kDatum: points, paths and polygons of up to 8
+    /// vertices, each with "id" (its index) and one 24-byte "p0" (longer than the small-string buffer)
+    inline geoson::FeatureCollection makeCollection(size_t n, uint64_t seed = 1) {
+        geoson::GeneratorOptions opts;
+        opts.seed = seed;
+        opts.features = n;
+        opts.mix.lines = 0.0;
+        opts.maxVertices = 8;
+        opts.properties = 1;
+        opts.propertyBytes = 24;
+        opts.extent = 200.0;
+        opts.datum = kDatum;
+        return geoson::generate(opts);
+    }
+
+    /// A field around kDatum with a field and a global property and `n` elements, in turn a "tree" Point
+    /// at (i, 1, 0.5) with id "t<i>", a "row" Path from x = i with id "r<i>" and a "zone" Polygon without id.
+    inline geoson::Vector makeVector(size_t n) {
+        geoson::Vector v(concord::Polygon{{{0, 0, 0}, {100, 0, 0}, {100, 100, 0}, {0, 0, 0}}}, kDatum,
+                         concord::Euler{0, 0, 0.5});
+        v.setFieldProperty("crop", "wheat");
+        v.setGlobalProperty("revision", "1");
+        for (size_t i = 0; i < n; ++i) {
+            double x = static_cast<double>(i);
+            auto id = std::to_string(i);
+            if (i % 3 == 0)
+                v.addPoint(concord::Point{x, 1.0, 0.5}, "tree", {{"id", "t" + id}});
+            else if (i % 3 == 1)
+                v.addPath(concord::Path{{{x, 0, 0}, {x + 1, 1, 0}, {x + 2, 0, 0}}}, "row", {{"id", "r" + id}});
+            else
+                v.addPolygon(concord::Polygon{{{x, 0, 0}, {x + 1, 0, 0}, {x + 1, 1, 0}, {x, 0, 0}}}, "zone");
+        }
+        return v;
+    }
+
+} // namespace fixtures
@@ -0,0 +1,138 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/arrow.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    geoson::FeatureCollection makePolygons() {
+        geoson::FeatureCollection fc;
+        fc.datum = concord::Datum{52.0, 5.0, 0.0};
+        fc.heading = concord::Euler{0.0, 0.0, 0.5};
+        fc.global_properties["farm"] = "wur";
+        std::vector<concord::Point> a = {{0.0, 0.0, 0.0}, {10.0, 0.0, 0.0}, {10.0, 10.0, 0.0}, {0.0, 0.0, 0.0}};
+        std::vector<concord::Point> b = {{1.0, 1.0, 0.0}, {2.0, 1.0, 0.0}, {1.0, 1.0, 0.0}};
+        fc.features.push_back({concord::Polygon{a}, {{"id", "1"}, {"type", "field"}}});
+        fc.features.push_back({concord::Polygon{b}, {{"id", "2"}}});
+        return fc;
+    }
+} // namespace
+
+TEST_CASE("GeoArrow - geometry layouts") {
+    SUBCASE("Homogeneous polygons use geoarrow.polygon with interleaved coordinates") {
+        auto t = geoson::toGeoArrow(makePolygons());
+
+        CHECK(t.num_rows == 2);
+        REQUIRE(t.columns.size() == 3);
+        auto const &geom = t.columns[0];
+        CHECK(geom.metadata[0].second == "geoarrow.polygon");
+        CHECK(geom.type == geoson::arrow::Type::List);
+        CHECK(geom.offsets == std::vector<int32_t>{0, 1, 2});
+
+        auto const &rings = geom.children.at(0);
+        CHECK(rings.offsets == std::vector<int32_t>{0, 4, 7});
+
+        auto const &verts = rings.children.at(0);
+        CHECK(verts.type == geoson::arrow::Type::FixedSizeList);
+        CHECK(verts.list_size == 3);
+        CHECK(verts.children.at(0).values.size() == 21);
+        CHECK(verts.children.at(0).values[3] == doctest::Approx(10.0));
+    }
+
+    SUBCASE("Separated layout produces x/y/z columns") {
+        geoson::ArrowOptions opts;
+        opts.layout = geoson::CoordinateLayout::Separated;
+        auto t = geoson::toGeoArrow(makePolygons(), opts);
+
+        auto const &verts = t.columns[0].children.at(0).children.at(0);
+        CHECK(verts.type == geoson::arrow::Type::Struct);
+        REQUIRE(verts.children.size() == 3);
+        CHECK(verts.children[0].name == "x");
+        CHECK(verts.children[0].values[1] == doctest::Approx(10.0));
+        CHECK(verts.children[1].values[2] == doctest::Approx(10.0));
+    }
+
+    SUBCASE("Points and lines") {
+        geoson::FeatureCollection fc;
+        fc.features.push_back({concord::Point{1.0, 2.0, 3.0}, {}});
+        fc.features.push_back({concord::Point{4.0, 5.0, 6.0}, {}});
+        auto points = geoson::toGeoArrow(fc);
+        CHECK(points.columns[0].metadata[0].second == "geoarrow.point");
+        CHECK(points.columns[0].length == 2);
+
+        fc.features.clear();
+        fc.features.push_back({concord::Line{{0.0, 0.0, 0.0}, {1.0, 1.0, 0.0}}, {}});
+        fc.features.push_back({concord::Path{{{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {2.0, 0.0, 0.0}}}, {}});
+        auto lines = geoson::toGeoArrow(fc);
+        CHECK(lines.columns[0].metadata[0].second == "geoarrow.linestring");
+        CHECK(lines.columns[0].offsets == std::vector<int32_t>{0, 2, 5});
+    }
+
+    SUBCASE("Mixed geometry types fall back to WKB") {
+        auto fc = makePolygons();
+        fc.features.push_back({concord::Point{3.0, 4.0, 5.0}, {}});
+        auto t = geoson::toGeoArrow(fc);
+
+        auto const &geom = t.columns[0];
+        CHECK(geom.type == geoson::arrow::Type::Binary);
+        CHECK(geom.metadata[0].second == "geoarrow.wkb");
+        REQUIRE(geom.offsets.size() == 4);
+        // the trailing point is byte order + type + xyz
+        CHECK(geom.offsets[3] - geom.offsets[2] == 1 + 4 + 24);
+        uint32_t type = 0;
+        std::memcpy(&type, geom.data.data() + geom.offsets[2] + 1, 4);
+        CHECK(type == 1001);
+    }
+}
+
+TEST_CASE("GeoArrow - property columns and metadata") {
+    auto t = geoson::toGeoArrow(makePolygons());
+
+    auto const &id = t.columns[1];
+    CHECK(id.name == "id");
+    CHECK(id.null_count == 0);
+    CHECK(id.validity.empty());
+    CHECK(std::string(id.data.begin(), id.data.end()) == "12");
+
+    auto const &type = t.columns[2];
+    CHECK(type.name == "type");
+    CHECK(type.null_count == 1);
+    REQUIRE(type.validity.size() == 1);
+    CHECK(type.validity[0] == 0x01);
+    CHECK(type.offsets == std::vector<int32_t>{0, 5, 5});
+
+    REQUIRE(t.metadata.size() == 1);
+    auto header = nlohmann::json::parse(t.metadata[0].second);
+    CHECK(header["crs"] == "ENU");
+    CHECK(header["heading"].get<double>() == doctest::Approx(0.5));
+    CHECK(header["farm"] == "wur");
+}
+
+TEST_CASE("GeoArrow - IPC file") {
+    const std::filesystem::path out = "/tmp/geoson_test.arrow";
+    geoson::WriteGeoArrow(makePolygons(), out);
+
+    std::ifstream ifs(out, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    REQUIRE(bytes.size() > 16);
+    CHECK(std::string(bytes.data(), 6) == "ARROW1");
+    CHECK(std::string(bytes.data() + bytes.size() - 6, 6) == "ARROW1");
+
+    // schema message follows the 8-byte magic with a continuation marker
+    uint32_t cont = 0;
+    std::memcpy(&cont, bytes.data() + 8, 4);
+    CHECK(cont == 0xFFFFFFFFu);
+
+    int32_t footerLen = 0;
+    std::memcpy(&footerLen, bytes.data() + bytes.size() - 10, 4);
+    CHECK(footerLen > 0);
+    CHECK(static_cast<size_t>(footerLen) < bytes.size());
+
+    CHECK_THROWS_WITH(geoson::WriteGeoArrow(makePolygons(), "/nonexistent/directory/file.arrow"),
+                      doctest::Contains("Cannot open for write"));
+
+    std::filesystem::remove(out);
+}
@@ -0,0 +1,170 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/async.hpp"
+#include "geoson/geoson.hpp"
+#include <filesystem>
+#include <future>
+#include <thread>
+
+namespace {
+    /// minimal eagerly started, fire-and-forget coroutine, standing in for an event loop's task type
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    /// runs the one task it is given on a thread of its own, signalling when the task starts
+    struct SignallingExecutor final : geoson::Executor {
+        std::promise<void> started;
+        std::thread worker;
+
+        void submit(std::function<void()> task) override {
+            worker = std::thread([this, task = std::move(task)] {
+                started.set_value();
+                task();
+            });
+        }
+        size_t concurrency() const override { return 1; }
+        ~SignallingExecutor() override {
+            if (worker.joinable())
+                worker.join();
+        }
+    };
+
+    Detached countFeatures(std::filesystem::path file, std::promise<size_t> &out) {
+        try {
+            auto fc = co_await geoson::readAsync(file);
+            out.set_value(fc.features.size());
+        } catch (...) {
+            out.set_exception(std::current_exception());
+        }
+    }
+} // namespace
+
+TEST_CASE("Async - read and write") {
+    const std::filesystem::path file = "/tmp/async_test.geojson";
+    auto fc = fixtures::makeCollection(3000);
+    geoson::ThreadPool pool(2);
+
+    geoson::WriteOptions wopts;
+    wopts.outputCrs = geoson::CRS::WGS;
+    wopts.executor = &pool;
+    std::vector<uint64_t> written;
+    auto w = geoson::writeAsync(fc, file, wopts, {}, [&](uint64_t done, uint64_t total) {
+        CHECK(total == 3000);
+        written.push_back(done);
+    });
+    CHECK(w.get() == 3000);
+    REQUIRE(!written.empty());
+    CHECK(written.back() == 3000);
+    CHECK(std::is_sorted(written.begin(), written.end()));
+
+    SUBCASE("Same collection as read()") {
+        auto expected = geoson::read(file);
+        std::vector<uint64_t> seen;
+        geoson::ReadOptions ropts;
+        ropts.executor = &pool;
+        auto got = geoson::readAsync(file, ropts, {}, [&](uint64_t done, uint64_t) { seen.push_back(done); }).get();
+        REQUIRE(got.features.size() == expected.features.size());
+        CHECK(got.global_properties == expected.global_properties);
+        CHECK(got.features[2999].properties == expected.features[2999].properties);
+        auto a = geoson::vertices(got.features[17].geometry), b = geoson::vertices(expected.features[17].geometry);
+        REQUIRE(a.size() == b.size());
+        CHECK(a.back().y == b.back().y);
+        REQUIRE(seen.size() > 1);
+        CHECK(seen.back() == std::filesystem::file_size(file));
+    }
+
+    SUBCASE("co_await from a coroutine") {
+        std::promise<size_t> result;
+        countFeatures(file, result);
+        CHECK(result.get_future().get() == 3000);
+    }
+
+    SUBCASE("Quantized write") {
+        const std::filesystem::path compact = "/tmp/async_compact.geojson";
+        geoson::WriteOptions copts;
+        copts.quantum = 0.001;
+        CHECK(geoson::writeAsync(fc, compact, copts).get() == 3000);
+        auto back = geoson::read(compact);
+        auto p = geoson::vertices(back.features[10].geometry), q = geoson::vertices(fc.features[10].geometry);
+        REQUIRE(p.size() == q.size());
+        CHECK(std::abs(p.back().y - q.back().y) < 1e-3);
+        std::filesystem::remove(compact);
+    }
+
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Async - cancellation") {
+    const std::filesystem::path file = "/tmp/async_cancel.geojson";
+    auto fc = fixtures::makeCollection(5000);
+    geoson::write(fc, file);
+
+    SUBCASE("Stop requested before the read starts") {
+        std::stop_source stop;
+        stop.request_stop();
+        auto task = geoson::readAsync(file, {}, stop.get_token());
+        CHECK_THROWS_AS(task.get(), geoson::OperationCancelled);
+    }
+
+    SUBCASE("Stop requested mid-read ends it at the next chunk") {
+        std::stop_source stop;
+        int calls = 0;
+        auto task = geoson::readAsync(file, {}, stop.get_token(), [&](uint64_t, uint64_t) {
+            ++calls;
+            stop.request_stop();
+        });
+        CHECK_THROWS_AS(task.get(), geoson::OperationCancelled);
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("Stop requested while the header after the features is searched") {
+        // few large features: no chunk boundary is ever reached, and geoson::write() puts them before the
+        // header, so FeatureReader scans the whole array first
+        const std::filesystem::path large = "/tmp/async_cancel_large.geojson";
+        geoson::FeatureCollection big{fixtures::kDatum, {}, {}, {}};
+        for (int f = 0; f < 100; ++f) {
+            std::vector<concord::Point> pts;
+            for (int i = 0; i < 2000; ++i)
+                pts.emplace_back(f + i * 0.01, i * 0.02, 0.0);
+            big.features.push_back({concord::Path{pts}, {}});
+        }
+        geoson::write(big, large);
+
+        int blocks = 0;
+        CHECK_THROWS_AS(geoson::FeatureReader(large, {}, [&] {
+                            if (++blocks == 3)
+                                throw geoson::OperationCancelled("stop");
+                        }),
+                        geoson::OperationCancelled);
+        CHECK(blocks == 3);
+
+        std::stop_source stop;
+        geoson::ReadOptions ropts;
+        SignallingExecutor executor;
+        ropts.executor = &executor;
+        auto task = geoson::readAsync(large, ropts, stop.get_token());
+        executor.started.get_future().wait();
+        stop.request_stop();
+        CHECK_THROWS_AS(task.get(), geoson::OperationCancelled);
+        std::filesystem::remove(large);
+    }
+
+    SUBCASE("A cancelled write leaves no file behind") {
+        const std::filesystem::path out = "/tmp/async_cancel_out.geojson";
+        std::stop_source stop;
+        auto task = geoson::writeAsync(fc, out, {}, stop.get_token(), [&](uint64_t, uint64_t) { stop.request_stop(); });
+        CHECK_THROWS_AS(task.get(), geoson::OperationCancelled);
+        CHECK_FALSE(std::filesystem::exists(out));
+    }
+
+    std::filesystem::remove(file);
+}
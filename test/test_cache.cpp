@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/cache.hpp"
+#include <filesystem>
+#include <thread>
+
+TEST_CASE("Cache - shared collections") {
+    const std::filesystem::path a = "/tmp/cache_a.geojson";
+    const std::filesystem::path b = "/tmp/cache_b.geojson";
+    geoson::write(fixtures::makeCollection(100), a);
+    geoson::write(fixtures::makeCollection(200), b);
+    geoson::CollectionCache cache;
+
+    SUBCASE("Repeated reads share one parse") {
+        auto first = cache.get(a);
+        auto second = cache.get("/tmp/../tmp/cache_a.geojson");
+        CHECK(first == second);
+        CHECK(first->features.size() == 100);
+        CHECK(cache.stats().misses == 1);
+        CHECK(cache.stats().hits == 1);
+        CHECK(cache.bytes() == first->memoryUsage().total());
+
+        geoson::ReadOptions simplified;
+        simplified.simplifyTolerance = 0.5;
+        CHECK(cache.get(a, simplified) != first); // different options, separate entry
+        CHECK(cache.size() == 2);
+    }
+
+    SUBCASE("A changed file is reloaded") {
+        auto before = cache.get(a);
+        geoson::write(fixtures::makeCollection(150), a);
+        auto after = cache.get(a);
+        CHECK(after != before);
+        CHECK(after->features.size() == 150);
+        CHECK(before->features.size() == 100); // handles outlive their entry
+        CHECK(cache.size() == 1);
+    }
+
+    SUBCASE("LRU eviction under the budget") {
+        auto ha = cache.get(a);
+        auto hb = cache.get(b);
+        cache.get(a); // a is now the most recently used
+        cache.setBudget(ha->memoryUsage().total());
+        CHECK(cache.size() == 1);
+        CHECK(cache.stats().evictions == 1);
+        CHECK(cache.get(a) == ha);
+        CHECK(cache.get(b) != hb); // b was evicted and is parsed again
+    }
+
+    SUBCASE("Concurrent loads are coalesced") {
+        std::vector<geoson::CollectionCache::Handle> got(8);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < got.size(); ++i)
+            threads.emplace_back([&, i] { got[i] = cache.get(b); });
+        for (auto &t : threads)
+            t.join();
+        auto s = cache.stats();
+        CHECK(s.misses == 1);
+        CHECK(s.hits + s.coalesced == 7);
+        for (auto const &h : got)
+            CHECK(h == got[0]);
+    }
+
+    SUBCASE("Erase and failures") {
+        cache.get(a);
+        cache.erase(a);
+        CHECK(cache.size() == 0);
+        CHECK(cache.bytes() == 0);
+        CHECK_THROWS(cache.get("/tmp/cache_missing.geojson"));
+    }
+
+    std::filesystem::remove(a);
+    std::filesystem::remove(b);
+}
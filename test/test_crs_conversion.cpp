@@ -2,6 +2,7 @@
 #include "geoson/geoson.hpp"
 #include <filesystem>
 #include <fstream>
+#include <nlohmann/json.hpp>
 
 TEST_CASE("CRS conversion during output") {
     // Create a simple test GeoJSON with WGS coordinates
@@ -0,0 +1,109 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/executor.hpp"
+#include "geoson/summary.hpp"
+#include "geoson/transcode.hpp"
+#include "geoson/vector.hpp"
+#include <atomic>
+#include <filesystem>
+#include <stdexcept>
+
+TEST_CASE("Executor - thread pool and parallelFor") {
+    geoson::ThreadPool pool(3);
+    CHECK(pool.concurrency() == 3);
+
+    SUBCASE("Every chunk runs exactly once") {
+        std::vector<std::atomic<int>> hits(1000);
+        geoson::op::parallelFor(&pool, hits.size(), 7, [&](size_t, size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i)
+                ++hits[i];
+        });
+        for (auto const &h : hits)
+            CHECK(h == 1);
+    }
+
+    SUBCASE("Exceptions reach the caller") {
+        CHECK_THROWS_AS(geoson::op::parallelFor(&pool, 100, 1,
+                                                [](size_t c, size_t, size_t) {
+                                                    if (c == 42)
+                                                        throw std::runtime_error("chunk failed");
+                                                }),
+                        std::runtime_error);
+    }
+
+    SUBCASE("Nested use of a single worker does not deadlock") {
+        geoson::ThreadPool one(1);
+        std::atomic<int> total{0};
+        geoson::op::parallelFor(&one, 4, 1, [&](size_t, size_t, size_t) {
+            geoson::op::parallelFor(&one, 4, 1, [&](size_t, size_t, size_t) { ++total; });
+        });
+        CHECK(total == 16);
+    }
+
+    SUBCASE("Jobs") {
+        geoson::op::Job<int> job(&pool, [] { return 6 * 7; });
+        CHECK(job.get() == 42);
+        geoson::op::Job<int> failing(&pool, []() -> int { throw std::runtime_error("job failed"); });
+        CHECK_THROWS_AS(failing.get(), std::runtime_error);
+    }
+
+    SUBCASE("Queued tasks run before the pool is destroyed") {
+        std::atomic<int> ran{0};
+        {
+            geoson::ThreadPool local(2);
+            for (int i = 0; i < 100; ++i)
+                local.submit([&] { ++ran; });
+        }
+        CHECK(ran == 100);
+    }
+}
+
+TEST_CASE("Executor - library paths give the same results") {
+    const std::filesystem::path file = "/tmp/executor_test.geojson";
+    const std::filesystem::path out = "/tmp/executor_test_enu.geojson";
+    auto fc = fixtures::makeCollection(2000);
+    geoson::ThreadPool pool(4);
+
+    geoson::WriteOptions sequential, parallel;
+    sequential.outputCrs = parallel.outputCrs = geoson::CRS::WGS;
+    parallel.executor = &pool;
+    CHECK(geoson::toJson(fc, parallel) == geoson::toJson(fc, sequential));
+    geoson::write(fc, file, parallel);
+
+    geoson::ReadOptions ropts;
+    ropts.executor = &pool;
+    auto a = geoson::read(file);
+    auto b = geoson::read(file, ropts);
+    REQUIRE(a.features.size() == b.features.size());
+    for (size_t i = 0; i < a.features.size(); ++i) {
+        CHECK(a.features[i].properties == b.features[i].properties);
+        CHECK(a.features[i].geometry.index() == b.features[i].geometry.index());
+    }
+
+    geoson::SummaryOptions sopts;
+    sopts.threads = 4;
+    sopts.executor = &pool;
+    CHECK(geoson::summarize(file, sopts).features == 2000);
+
+    geoson::InlineExecutor sequentialExecutor;
+    for (geoson::Executor *executor : std::vector<geoson::Executor *>{&pool, &sequentialExecutor}) {
+        geoson::TranscodeOptions topts;
+        topts.batchSize = 100;
+        topts.executor = executor;
+        CHECK(geoson::transcode(file, out, geoson::CRS::ENU, topts) == 2000);
+        CHECK(geoson::read(out).features[1234].properties.at("id") == "1234");
+    }
+
+    geoson::Vector v(concord::Polygon{{{0, 0, 0}, {10, 0, 0}, {10, 10, 0}, {0, 0, 0}}});
+    for (int i = 0; i < 1000; ++i)
+        v.addElement(concord::Point{double(i), 0.0, 0.0}, i % 3 ? "tree" : "rock", {{"row", std::to_string(i % 10)}});
+    auto trees = v.getElementsByType("tree", &pool);
+    CHECK(trees.size() == v.getElementsByType("tree").size());
+    CHECK(std::get<concord::Point>(trees[1].geometry).x == 2.0);
+    CHECK(v.filterByProperty("row", "3", &pool).size() == 100);
+
+    std::filesystem::remove(file);
+    std::filesystem::remove(out);
+}
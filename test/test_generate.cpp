@@ -0,0 +1,88 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/generate.hpp"
+#include "geoson/geometry.hpp"
+#include "geoson/geoson.hpp"
+#include <filesystem>
+
+TEST_CASE("Generator - reproducible synthetic collections") {
+    geoson::GeneratorOptions opts;
+    opts.features = 400;
+    opts.seed = 7;
+
+    SUBCASE("Same seed, same collection; other seed, other collection") {
+        auto a = geoson::generate(opts);
+        auto b = geoson::generate(opts);
+        REQUIRE(a.features.size() == 400);
+        CHECK(geoson::toJson(a) == geoson::toJson(b));
+
+        opts.seed = 8;
+        CHECK(geoson::toJson(geoson::generate(opts)) != geoson::toJson(a));
+    }
+
+    SUBCASE("Features can be generated independently") {
+        auto fc = geoson::generate(opts);
+        auto f = geoson::generateFeature(opts, 123);
+        CHECK(geoson::toJson(geoson::FeatureCollection{fc.datum, fc.heading, {fc.features[123]}, {}}) ==
+              geoson::toJson(geoson::FeatureCollection{fc.datum, fc.heading, {f}, {}}));
+    }
+
+    SUBCASE("Mix, vertex range, properties and extent are honoured") {
+        opts.mix = {0.0, 0.0, 1.0, 3.0};
+        opts.minVertices = 10;
+        opts.maxVertices = 20;
+        opts.properties = 3;
+        opts.propertyBytes = 5;
+        opts.extent = 100.0;
+        auto fc = geoson::generate(opts);
+
+        size_t polygons = 0;
+        for (auto const &f : fc.features) {
+            CHECK_FALSE(std::holds_alternative<concord::Point>(f.geometry));
+            CHECK_FALSE(std::holds_alternative<concord::Line>(f.geometry));
+            size_t n = geoson::vertexCount(f.geometry);
+            if (std::holds_alternative<concord::Polygon>(f.geometry)) {
+                ++polygons;
+                CHECK(n >= 11);
+                CHECK(n <= 21);
+            } else {
+                CHECK(n >= 10);
+                CHECK(n <= 20);
+            }
+            CHECK(f.properties.size() == 4);
+            CHECK(f.properties.at("p2").size() == 5);
+            auto box = geoson::boundingBox(f.geometry);
+            CHECK(box.min[0] > -100.0);
+            CHECK(box.max[0] < 100.0);
+        }
+        CHECK(polygons > 250);
+        CHECK(polygons < 350);
+
+        opts.mix = {0.0, 0.0, 0.0, 0.0};
+        CHECK_THROWS_AS(geoson::generate(opts), std::invalid_argument);
+    }
+
+    SUBCASE("Streamed files read back as the in-memory collection") {
+        const std::filesystem::path file = "/tmp/generated.geojson";
+        opts.crs = geoson::CRS::WGS;
+        uint64_t reported = 0;
+        auto bytes = geoson::generate(file, opts, [&](uint64_t n) { reported = n; });
+        CHECK(bytes == std::filesystem::file_size(file));
+        CHECK(reported == opts.features);
+
+        auto back = geoson::read(file);
+        auto mem = geoson::generate(opts);
+        REQUIRE(back.features.size() == mem.features.size());
+        CHECK(back.global_properties.at("seed") == "7");
+        for (size_t i = 0; i < mem.features.size(); ++i) {
+            CHECK(back.features[i].properties == mem.features[i].properties);
+            auto a = geoson::vertices(back.features[i].geometry);
+            auto b = geoson::vertices(mem.features[i].geometry);
+            REQUIRE(a.size() == b.size());
+            CHECK(a.front().x == doctest::Approx(b.front().x).epsilon(1e-6));
+            CHECK(a.back().y == doctest::Approx(b.back().y).epsilon(1e-6));
+        }
+        std::filesystem::remove(file);
+    }
+}
@@ -0,0 +1,169 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/journal.hpp"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+    void edit(geoson::VectorJournal &j) {
+        j.addElement(concord::Path{{{0, 0, 0}, {5, 5, 0}, {10, 0, 0}}}, "row", {{"id", "r0"}});
+        j.removeElement(2);
+        j.setElementProperty(0, "height", "3.5");
+        j.removeElementProperty(1, "id");
+        j.replaceElement(3, geoson::Element(concord::Point{50, 50, 0}, {{"id", "moved"}}, "tree"));
+        j.setGlobalProperty("revision", "7");
+        j.setFieldProperty("crop", "barley");
+        j.setHeading(concord::Euler{0, 0, 1.25});
+    }
+
+    void checkEdited(geoson::Vector const &v) {
+        REQUIRE(v.elementCount() == 10);
+        CHECK(v.getElement(0).properties.at("height") == "3.5");
+        CHECK(v.getElement(1).properties.count("id") == 0);
+        CHECK(v.getElement(2).properties.at("id") == "t3"); // the zone before it was removed
+        CHECK(std::get<concord::Point>(v.getElement(3).geometry).x == 50.0);
+        CHECK(v.getElement(9).type == "row");
+        CHECK(v.getGlobalProperty("revision") == "7");
+        CHECK(v.getFieldProperties().at("crop") == "barley");
+        CHECK(v.getHeading().yaw == doctest::Approx(1.25));
+    }
+
+    void copyFiles(std::filesystem::path const &from, std::filesystem::path const &to) {
+        auto opt = std::filesystem::copy_options::overwrite_existing;
+        std::filesystem::copy_file(from, to, opt);
+        std::filesystem::copy_file(geoson::VectorJournal::logPath(from), geoson::VectorJournal::logPath(to), opt);
+    }
+} // namespace
+
+TEST_CASE("Journal - write-ahead log for Vector mutations") {
+    const std::filesystem::path file = "/tmp/journal_test.snap";
+    const std::filesystem::path crashed = "/tmp/journal_crashed.snap";
+    geoson::VectorJournal::create(file, fixtures::makeVector(10));
+    geoson::JournalOptions manual;
+    manual.groupSize = 1000;
+    manual.groupWindow = std::chrono::milliseconds(0);
+
+    SUBCASE("Edits are replayed on load") {
+        {
+            geoson::VectorJournal j(file, manual);
+            edit(j);
+            checkEdited(j.vector());
+        } // closing commits
+        geoson::VectorJournal j(file);
+        CHECK(j.replayed() == 8);
+        checkEdited(j.vector());
+        CHECK(geoson::VectorJournal::snapshot(file).elementCount() == 10); // the snapshot itself is untouched
+    }
+
+    SUBCASE("Only committed edits survive a crash, a torn tail is dropped") {
+        {
+            geoson::VectorJournal j(file, manual);
+            edit(j);
+            j.commit();
+            j.addElement(concord::Point{1, 1, 0}, "lost");
+            copyFiles(file, crashed); // as left by a process killed now
+        }
+        {
+            std::ofstream log(geoson::VectorJournal::logPath(crashed), std::ios::binary | std::ios::app);
+            log << std::string("\x20\0\0\0garbage", 11);
+        }
+        geoson::VectorJournal j(crashed, manual);
+        CHECK(j.replayed() == 8);
+        checkEdited(j.vector());
+        j.addElement(concord::Point{2, 2, 0}, "after");
+        j.commit();
+        CHECK(geoson::VectorJournal(crashed, manual).vector().elementCount() == 11);
+    }
+
+    SUBCASE("Compaction folds the log into the snapshot") {
+        auto staleLog = std::filesystem::path("/tmp/journal_stale.wal");
+        {
+            geoson::VectorJournal j(file, manual);
+            edit(j);
+            j.commit();
+            std::filesystem::copy_file(geoson::VectorJournal::logPath(file), staleLog,
+                                       std::filesystem::copy_options::overwrite_existing);
+            j.compact();
+            CHECK(j.logBytes() == 16);
+        }
+        checkEdited(geoson::VectorJournal::snapshot(file));
+
+        // compaction interrupted after the snapshot was replaced: the old log must not be applied again
+        std::filesystem::copy_file(staleLog, geoson::VectorJournal::logPath(file),
+                                   std::filesystem::copy_options::overwrite_existing);
+        geoson::VectorJournal j(file, manual);
+        CHECK(j.replayed() == 0);
+        checkEdited(j.vector());
+        std::filesystem::remove(staleLog);
+    }
+
+    SUBCASE("A failed compaction keeps appending to the old log") {
+        auto blocker = std::filesystem::path(file.string() + ".tmp");
+        std::filesystem::create_directory(blocker); // the snapshot's temporary cannot be created
+        {
+            geoson::VectorJournal j(file, manual);
+            j.setGlobalProperty("revision", "7");
+            CHECK_THROWS_AS(j.compact(), std::runtime_error);
+            CHECK(j.compactions() == 0);
+            j.setFieldProperty("crop", "barley");
+            j.commit();
+        }
+        std::filesystem::remove(blocker);
+        geoson::VectorJournal j(file, manual);
+        CHECK(j.replayed() == 2);
+        CHECK(j.vector().getGlobalProperty("revision") == "7");
+        CHECK(j.vector().getFieldProperties().at("crop") == "barley");
+    }
+
+    SUBCASE("Snapshots keep what GeoJSON would not") {
+        auto initial = fixtures::makeVector(3);
+        initial.setCRS(geoson::CRS::WGS);
+        initial.addPoint(concord::Point{7, 7, 0}, "field"); // dropped by Vector::fromFile()
+        initial.addPoint(concord::Point{8, 8, 0}, "");      // "unknown" after Vector::fromFile()
+        geoson::VectorJournal::create(file, initial);
+        {
+            geoson::VectorJournal j(file, manual);
+            j.setElementProperty(4, "height", "2");
+            j.compact();
+        }
+        geoson::VectorJournal j(file, manual);
+        auto const &v = j.vector();
+        REQUIRE(v.elementCount() == 5);
+        CHECK(v.getCRS() == geoson::CRS::WGS);
+        CHECK(v.getElement(3).type == "field");
+        CHECK(v.getElement(4).type.empty());
+        CHECK(v.getElement(4).properties.at("height") == "2");
+    }
+
+    SUBCASE("Concurrent group commits and automatic compaction") {
+        geoson::JournalOptions opts;
+        opts.groupSize = 8;
+        opts.groupWindow = std::chrono::milliseconds(5);
+        opts.compactBytes = 32 * 1024;
+        {
+            geoson::VectorJournal j(file, opts);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t)
+                threads.emplace_back([&, t] {
+                    for (int i = 0; i < 250; ++i)
+                        j.addElement(concord::Point{double(t), double(i), 0.0}, "p",
+                                     {{"id", std::to_string(t) + "/" + std::to_string(i)}});
+                });
+            for (auto &th : threads)
+                th.join();
+            CHECK(j.compactions() > 0);
+        }
+        geoson::VectorJournal j(file, opts);
+        CHECK(j.vector().elementCount() == 1010);
+    }
+
+    for (auto const &f : {file, crashed}) {
+        std::filesystem::remove(f);
+        std::filesystem::remove(geoson::VectorJournal::logPath(f));
+    }
+}
+#endif
@@ -0,0 +1,91 @@
+#define GEOSON_ENABLE_STATS 1
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/memory.hpp"
+#include "geoson/vector.hpp"
+#include <filesystem>
+
+GEOSON_INSTALL_ALLOCATION_HOOKS();
+
+TEST_CASE("Memory - FeatureCollection footprint") {
+    auto empty = geoson::FeatureCollection{}.memoryUsage();
+    CHECK(empty.coordinates == 0);
+    CHECK(empty.geometry == 0);
+    CHECK(empty.total() >= sizeof(geoson::FeatureCollection));
+
+    auto fc = fixtures::makeCollection(100);
+    size_t vertices = 0; // held by Paths and Polygons; a Point is stored in the geometry itself
+    for (auto const &f : fc.features)
+        if (!std::holds_alternative<concord::Point>(f.geometry))
+            vertices += geoson::vertexCount(f.geometry);
+    auto small = fixtures::makeCollection(10).memoryUsage();
+    auto large = fc.memoryUsage();
+    CHECK(small.geometry == 10 * sizeof(geoson::Geometry));
+    CHECK(large.geometry == 100 * sizeof(geoson::Geometry));
+    CHECK(large.coordinates >= vertices * sizeof(concord::Point));
+    CHECK(large.propertyKeys >= 200 * sizeof(std::string));
+    // long values spill to the heap, short keys do not
+    CHECK(large.propertyValues > large.propertyKeys);
+    CHECK(large.properties > 0);
+    CHECK(large.indices == 0);
+    CHECK(large.total() > 5 * small.total());
+
+    geoson::MemoryUsage sum = small;
+    sum += large;
+    CHECK(sum.total() == small.total() + large.total());
+}
+
+TEST_CASE("Memory - Vector footprint") {
+    concord::Polygon boundary{{{0, 0, 0}, {10, 0, 0}, {10, 10, 0}, {0, 0, 0}}};
+    geoson::Vector v(boundary);
+    auto before = v.memoryUsage();
+    CHECK(before.coordinates == boundary.getPoints().capacity() * sizeof(concord::Point));
+
+    for (int i = 0; i < 50; ++i)
+        v.addElement(concord::Point{double(i), 0.0, 0.0}, "tree", {{"id", std::to_string(i)}});
+    auto after = v.memoryUsage();
+    CHECK(after.geometry == 50 * sizeof(geoson::Geometry));
+    CHECK(after.propertyKeys >= 50 * sizeof(std::string));
+    CHECK(after.total() > before.total());
+}
+
+TEST_CASE("Memory - allocation hooks") {
+    REQUIRE(geoson::alloc::hooksInstalled());
+
+    geoson::alloc::Scope scope;
+    auto *values = new std::vector<int>(1000);
+    auto d = scope.delta();
+    CHECK(d.allocations == 2);
+    CHECK(d.bytes >= sizeof(std::vector<int>) + 1000 * sizeof(int));
+    delete values;
+    CHECK(scope.delta().deallocations == 2);
+}
+
+TEST_CASE("Memory - per-phase allocation counts") {
+    REQUIRE(geoson::statsEnabled);
+    const std::filesystem::path file = "/tmp/memory_test.geojson";
+    auto fc = fixtures::makeCollection(100);
+
+    geoson::WriteStats ws;
+    geoson::WriteOptions wopts;
+    wopts.outputCrs = geoson::CRS::WGS;
+    wopts.stats = &ws;
+    geoson::write(fc, file, wopts);
+    CHECK(ws.geometryAlloc.count > 0);
+    CHECK(ws.propertiesAlloc.count > 0);
+    CHECK(ws.serializeAlloc.bytes >= std::filesystem::file_size(file) - 1);
+
+    geoson::ParseStats ps;
+    geoson::ReadOptions ropts;
+    ropts.stats = &ps;
+    auto back = geoson::read(file, ropts);
+    CHECK(back.features.size() == 100);
+    CHECK(ps.tokenizeAlloc.count > 0);
+    CHECK(ps.geometryAlloc.count > 0);
+    CHECK(ps.propertiesAlloc.count > 0);
+    CHECK(ps.buildAlloc.count > 0);
+
+    std::filesystem::remove(file);
+}
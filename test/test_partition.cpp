@@ -0,0 +1,129 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/partition.hpp"
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+namespace {
+    /// a dense block of small polygons next to a sparse scatter of points
+    geoson::FeatureCollection makeCollection() {
+        geoson::FeatureCollection fc;
+        fc.datum = concord::Datum{52.0, 5.0, 0.0};
+        int id = 0;
+        for (int i = 0; i < 40; ++i)
+            for (int j = 0; j < 40; ++j) {
+                double x = i * 5.0, y = j * 5.0;
+                fc.features.push_back(
+                    {concord::Polygon{{{x, y, 0.0}, {x + 2.0, y, 0.0}, {x + 2.0, y + 2.0, 0.0}, {x, y, 0.0}}},
+                     {{"id", std::to_string(id++)}}});
+            }
+        for (int i = 0; i < 400; ++i)
+            fc.features.push_back(
+                {concord::Point{1000.0 + (i % 20) * 200.0, (i / 20) * 200.0, 0.0}, {{"id", std::to_string(id++)}}});
+        return fc;
+    }
+
+    void checkShards(geoson::PartitionManifest const &m, geoson::FeatureCollection const &fc, size_t k) {
+        REQUIRE(m.shards.size() == k);
+        uint64_t total = 0;
+        for (auto const &f : fc.features)
+            total += geoson::vertexCount(f.geometry);
+
+        std::set<std::string> ids;
+        uint64_t vertices = 0;
+        for (auto const &s : m.shards) {
+            INFO(s.file.string());
+            // balanced by vertex count, not by feature count or area
+            CHECK(static_cast<double>(s.vertices) > 0.8 * static_cast<double>(total) / k);
+            CHECK(static_cast<double>(s.vertices) < 1.2 * static_cast<double>(total) / k);
+            auto shard = geoson::read(s.file);
+            CHECK(shard.features.size() == s.features);
+            for (auto const &f : shard.features) {
+                ids.insert(f.properties.at("id"));
+                auto box = geoson::boundingBox(f.geometry);
+                CHECK(box.min[0] >= s.enu.min[0] - 1e-6);
+                CHECK(box.max[0] <= s.enu.max[0] + 1e-6);
+            }
+            vertices += s.vertices;
+            CHECK(s.wgs.min[1] == doctest::Approx(52.0).epsilon(1e-3));
+        }
+        CHECK(ids.size() == fc.features.size());
+        CHECK(vertices == total);
+    }
+} // namespace
+
+TEST_CASE("Partition - spatially balanced shards") {
+    const std::filesystem::path dir = "/tmp/partition_test";
+    const std::filesystem::path src = "/tmp/partition_src.geojson";
+    std::filesystem::remove_all(dir);
+    auto fc = makeCollection();
+    geoson::ThreadPool pool(2);
+    geoson::PartitionOptions opts;
+    opts.executor = &pool;
+
+    SUBCASE("In-memory collection") {
+        auto m = geoson::partition(fc, 4, dir, opts);
+        checkShards(m, fc, 4);
+
+        // the sparse points are 400 of 6800 vertices: they share a shard or two
+        size_t withPoints = 0;
+        for (auto const &s : m.shards)
+            withPoints += s.enu.max[0] >= 1000.0;
+        CHECK(withPoints <= 2);
+
+        std::ifstream in(dir / "manifest.json");
+        auto manifest = nlohmann::json::parse(in);
+        REQUIRE(manifest.at("shards").size() == 4);
+        CHECK(manifest["shards"][0]["file"] == "shard-000.geojson");
+        CHECK(manifest["shards"][3]["vertices"] == m.shards[3].vertices);
+        CHECK(manifest["shards"][1]["bbox"].size() == 6);
+    }
+
+    SUBCASE("Streamed file matches the in-memory split") {
+        geoson::write(fc, src, geoson::CRS::WGS);
+        auto streamed = geoson::partition(src, 3, dir, opts);
+        checkShards(streamed, fc, 3);
+        CHECK(geoson::FeatureReader(streamed.shards[0].file).header().crs == geoson::CRS::WGS);
+
+        auto loaded = geoson::read(src);
+        auto inMemory = geoson::partition(loaded, 3, dir / "mem", opts);
+        for (size_t s = 0; s < 3; ++s) {
+            CHECK(streamed.shards[s].features == inMemory.shards[s].features);
+            CHECK(streamed.shards[s].vertices == inMemory.shards[s].vertices);
+        }
+        std::filesystem::remove(src);
+    }
+
+    SUBCASE("More shards than open files are written in passes") {
+        geoson::write(fc, src, geoson::CRS::WGS);
+        auto oneGo = geoson::partition(src, 5, dir / "one", opts);
+        opts.maxOpenFiles = 2;
+        auto passes = geoson::partition(src, 5, dir / "passes", opts);
+        checkShards(passes, fc, 5);
+        auto loaded = geoson::read(src);
+        auto inMemory = geoson::partition(loaded, 5, dir / "mem", opts);
+        checkShards(inMemory, fc, 5);
+        for (size_t s = 0; s < 5; ++s) {
+            CHECK(passes.shards[s].features == oneGo.shards[s].features);
+            CHECK(passes.shards[s].vertices == oneGo.shards[s].vertices);
+            CHECK(inMemory.shards[s].features == oneGo.shards[s].features);
+        }
+        std::filesystem::remove(src);
+    }
+
+    SUBCASE("More shards than places") {
+        geoson::FeatureCollection tiny;
+        tiny.datum = fc.datum;
+        tiny.features.push_back({concord::Point{1.0, 2.0, 0.0}, {{"id", "0"}}});
+        auto m = geoson::partition(tiny, 3, dir);
+        CHECK(m.shards[0].features + m.shards[1].features + m.shards[2].features == 1);
+        for (auto const &s : m.shards)
+            CHECK(std::filesystem::exists(s.file));
+        CHECK_THROWS(geoson::partition(tiny, 0, dir));
+    }
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,94 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/geometry.hpp"
+#include "geoson/pipeline.hpp"
+#include <filesystem>
+
+namespace {
+    geoson::FeatureCollection makeCollection(size_t n) {
+        geoson::FeatureCollection fc;
+        fc.datum = concord::Datum{52.0, 5.0, 0.0};
+        for (size_t i = 0; i < n; ++i) {
+            double x = static_cast<double>(i) * 10.0;
+            std::string kind = i % 3 ? "row" : "tree";
+            if (kind == "tree")
+                fc.features.push_back({concord::Point{x, 0.0, 0.0}, {{"id", std::to_string(i)}, {"kind", kind}}});
+            else // a nearly straight row: the middle vertex goes with a 0.5 m tolerance
+                fc.features.push_back({concord::Path{{{x, 0.0, 0.0}, {x + 5.0, 0.1, 0.0}, {x + 10.0, 0.0, 0.0}}},
+                                       {{"id", std::to_string(i)}, {"kind", kind}}});
+        }
+        return fc;
+    }
+} // namespace
+
+TEST_CASE("Pipeline - fused stages") {
+    const std::filesystem::path src = "/tmp/pipeline_src.geojson";
+    const std::filesystem::path dst = "/tmp/pipeline_dst.geojson";
+    geoson::write(makeCollection(1000), src);
+    geoson::ThreadPool pool(2);
+
+    SUBCASE("Filter and simplify into a file, in order") {
+        auto written = geoson::pipeline(src)
+                           .filter([](geoson::Feature const &f) { return f.properties.at("kind") == "row"; })
+                           .simplify(0.5)
+                           .on(&pool)
+                           .batching(64)
+                           .sink(dst);
+        CHECK(written == 666);
+
+        auto out = geoson::read(dst);
+        REQUIRE(out.features.size() == 666);
+        for (size_t i = 0; i < out.features.size(); ++i) {
+            size_t id = std::stoul(out.features[i].properties.at("id"));
+            CHECK(id == i + i / 2 + 1); // 1, 2, 4, 5, 7, ...
+            CHECK(geoson::vertices(out.features[i].geometry).size() == 2);
+        }
+    }
+
+    SUBCASE("Rebase matches read + rebase") {
+        concord::Datum moved{52.001, 5.002, 3.0};
+        CHECK(geoson::pipeline(src).rebase(moved).on(&pool).batching(100).sink(dst) == 1000);
+        auto expected = geoson::read(src);
+        geoson::rebase(expected, moved);
+        auto out = geoson::read(dst);
+        CHECK(out.datum.lat == doctest::Approx(moved.lat));
+        REQUIRE(out.features.size() == expected.features.size());
+        for (size_t i = 0; i < out.features.size(); ++i) {
+            auto a = geoson::vertices(out.features[i].geometry);
+            auto b = geoson::vertices(expected.features[i].geometry);
+            REQUIRE(a.size() == b.size());
+            for (size_t k = 0; k < a.size(); ++k) {
+                CHECK(a[k].x == doctest::Approx(b[k].x).epsilon(1e-9));
+                CHECK(a[k].y == doctest::Approx(b[k].y).epsilon(1e-9));
+            }
+        }
+    }
+
+    SUBCASE("Callback sink sees features in source order") {
+        std::vector<std::string> ids;
+        auto n = geoson::pipeline(src)
+                     .map([](geoson::Feature &f) { f.properties["seen"] = "yes"; })
+                     .filter([](geoson::Feature const &f) { return f.properties.count("seen") == 1; })
+                     .on(&pool)
+                     .batching(7, 3)
+                     .sink([&](geoson::Feature &f) { ids.push_back(f.properties.at("id")); });
+        CHECK(n == 1000);
+        REQUIRE(ids.size() == 1000);
+        for (size_t i = 0; i < ids.size(); ++i)
+            CHECK(ids[i] == std::to_string(i));
+    }
+
+    SUBCASE("A failing stage removes the partial output") {
+        auto failing = geoson::pipeline(src).map([](geoson::Feature &f) {
+            if (f.properties.at("id") == "900")
+                throw std::runtime_error("bad feature");
+        });
+        CHECK_THROWS_WITH(failing.on(&pool).batching(32).sink(dst), "bad feature");
+        CHECK_FALSE(std::filesystem::exists(dst));
+    }
+
+    std::filesystem::remove(src);
+    std::filesystem::remove(dst);
+}
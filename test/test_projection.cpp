@@ -0,0 +1,103 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/projection.hpp"
+#include "geoson/transcode.hpp"
+#include <cmath>
+#include <filesystem>
+#include <numbers>
+
+namespace {
+    const concord::Datum kDatum{51.98, 5.66, 12.0};
+
+    double distance(std::array<double, 3> const &a, concord::ENU const &b) {
+        return std::hypot(a[0] - b.x, a[1] - b.y, a[2] - b.z);
+    }
+} // namespace
+
+TEST_CASE("Projection - local tangent plane against exact conversion") {
+    geoson::LocalTangentPlane plane(kDatum, 1e9); // never fall back, to measure the series itself
+
+    for (double d : {10.0, 500.0, 2000.0, 8000.0}) {
+        double worst = 0.0;
+        for (int k = 0; k < 16; ++k) {
+            double a = k * std::numbers::pi / 8.0;
+            double x = d * std::cos(a), y = d * std::sin(a), z = (k % 3) * 40.0 - 20.0;
+            auto wgs = concord::ENU{concord::Point{x, y, z}, kDatum}.toWGS();
+
+            auto enu = plane.toENU(wgs.lat, wgs.lon, wgs.alt);
+            worst = std::max(worst, std::hypot(enu[0] - x, enu[1] - y, enu[2] - z));
+
+            auto back = plane.toWGS(x, y, z);
+            worst = std::max(worst, distance({x, y, z}, concord::WGS{back[0], back[1], back[2]}.toENU(kDatum)));
+        }
+        INFO("distance " << d << " error " << worst);
+        CHECK(worst <= plane.errorBound(d));
+    }
+    CHECK(plane.errorBound(2000.0) < 1e-3);
+}
+
+TEST_CASE("Projection - fallback beyond the radius") {
+    geoson::LocalTangentPlane plane(kDatum);
+    CHECK(plane.radius() == geoson::LocalTangentPlane::kDefaultRadius);
+
+    // far from the datum the series would be off by metres; the plane converts exactly instead
+    auto wgs = concord::ENU{concord::Point{150000.0, -80000.0, 3.0}, kDatum}.toWGS();
+    auto enu = plane.toENU(wgs.lat, wgs.lon, wgs.alt);
+    CHECK(enu[0] == doctest::Approx(150000.0).epsilon(1e-9));
+    CHECK(enu[1] == doctest::Approx(-80000.0).epsilon(1e-9));
+    auto back = plane.toWGS(150000.0, -80000.0, 3.0);
+    CHECK(back[0] == doctest::Approx(wgs.lat).epsilon(1e-12));
+    CHECK(back[1] == doctest::Approx(wgs.lon).epsilon(1e-12));
+    CHECK(plane.maxError(1e6) == plane.errorBound(plane.radius()));
+}
+
+TEST_CASE("Projection - read, write and transcode in local tangent mode") {
+    const std::filesystem::path wgsFile = "/tmp/projection_wgs.geojson";
+    const std::filesystem::path enuFile = "/tmp/projection_enu.geojson";
+
+    geoson::FeatureCollection fc{kDatum, concord::Euler{0, 0, 0}, {}, {}};
+    for (int i = 0; i < 20; ++i) {
+        double x = 100.0 * i - 1000.0, y = 50.0 * i;
+        fc.features.push_back({concord::Path{{{x, y, 1.0}, {x + 10.0, y + 5.0, 2.0}, {x + 20.0, y, 3.0}}}, {}});
+    }
+
+    double bound = geoson::conversionErrorBound(fc, geoson::ConversionMode::LocalTangent);
+    CHECK(geoson::conversionErrorBound(fc, geoson::ConversionMode::Exact) == 0.0);
+    CHECK(bound > 0.0);
+    CHECK(bound < 1e-3);
+
+    geoson::WriteOptions wopts;
+    wopts.outputCrs = geoson::CRS::WGS;
+    wopts.conversion = geoson::ConversionMode::LocalTangent;
+    geoson::write(fc, wgsFile, wopts);
+
+    geoson::ReadOptions exact, fast;
+    fast.conversion = geoson::ConversionMode::LocalTangent;
+    auto a = geoson::read(wgsFile, exact);
+    auto b = geoson::read(wgsFile, fast);
+    REQUIRE(a.features.size() == fc.features.size());
+    REQUIRE(b.features.size() == fc.features.size());
+    for (size_t i = 0; i < fc.features.size(); ++i) {
+        auto const &orig = std::get<concord::Path>(fc.features[i].geometry).getPoints();
+        auto const &pa = std::get<concord::Path>(a.features[i].geometry).getPoints();
+        auto const &pb = std::get<concord::Path>(b.features[i].geometry).getPoints();
+        for (size_t k = 0; k < orig.size(); ++k) {
+            // written with the series, read back exactly: one conversion's error
+            CHECK(std::hypot(pa[k].x - orig[k].x, pa[k].y - orig[k].y, pa[k].z - orig[k].z) <= bound);
+            CHECK(std::hypot(pb[k].x - orig[k].x, pb[k].y - orig[k].y, pb[k].z - orig[k].z) <= 2 * bound);
+        }
+    }
+
+    geoson::TranscodeOptions topts;
+    topts.conversion = geoson::ConversionMode::LocalTangent;
+    CHECK(geoson::transcode(wgsFile, enuFile, geoson::CRS::ENU, topts) == fc.features.size());
+    auto c = geoson::read(enuFile);
+    auto const &pc = std::get<concord::Path>(c.features[7].geometry).getPoints();
+    auto const &po = std::get<concord::Path>(fc.features[7].geometry).getPoints();
+    CHECK(std::hypot(pc[1].x - po[1].x, pc[1].y - po[1].y) <= 2 * bound);
+
+    std::filesystem::remove(wgsFile);
+    std::filesystem::remove(enuFile);
+}
@@ -0,0 +1,86 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/readall.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    const std::filesystem::path kDir = "/tmp/readall_test";
+
+    geoson::FeatureCollection makeField(concord::Datum const &datum, int n) {
+        auto fc = fixtures::makeCollection(n, n);
+        fc.datum = datum;
+        fc.global_properties["field"] = std::to_string(n);
+        return fc;
+    }
+
+    concord::WGS onGround(geoson::FeatureCollection const &fc, size_t i) {
+        return concord::ENU{geoson::vertices(fc.features[i].geometry)[0], fc.datum}.toWGS();
+    }
+} // namespace
+
+TEST_CASE("ReadAll - directory of collections") {
+    std::filesystem::remove_all(kDir);
+    std::filesystem::create_directories(kDir);
+    const concord::Datum a{52.00, 5.00, 0.0}, b{52.01, 5.02, 3.0}, c{51.99, 4.98, -1.0};
+    auto fa = makeField(a, 3), fb = makeField(b, 4), fc = makeField(c, 5);
+    geoson::write(fa, kDir / "a.geojson", geoson::CRS::WGS);
+    geoson::write(fb, kDir / "b.geojson", geoson::CRS::WGS);
+    geoson::write(fc, kDir / "c.json", geoson::CRS::ENU);
+    std::ofstream(kDir / "notes.txt") << "not geojson";
+
+    geoson::ThreadPool pool(3);
+    geoson::ReadAllOptions opts;
+    opts.executor = &pool;
+
+    SUBCASE("Separate collections keep their datums") {
+        auto all = geoson::readAll(kDir, opts);
+        REQUIRE(all.size() == 3);
+        CHECK(all[0].features.size() == 3);
+        CHECK(all[1].features.size() == 4);
+        CHECK(all[2].features.size() == 5);
+        CHECK(all[1].datum.lat == doctest::Approx(b.lat));
+        CHECK(all[2].global_properties.at("field") == "5");
+    }
+
+    SUBCASE("Rebased to one datum") {
+        opts.datum = a;
+        auto all = geoson::readAll(kDir, opts);
+        REQUIRE(all.size() == 3);
+        for (auto const &col : all)
+            CHECK(col.datum.lat == a.lat);
+        auto before = onGround(fb, 2), after = onGround(all[1], 2);
+        CHECK(after.lat == doctest::Approx(before.lat).epsilon(1e-9));
+        CHECK(after.lon == doctest::Approx(before.lon).epsilon(1e-9));
+        CHECK(after.alt == doctest::Approx(before.alt).epsilon(1e-6));
+    }
+
+    SUBCASE("Merged collection") {
+        opts.sourceProperty = "source";
+        auto merged = geoson::readAllMerged(kDir, opts);
+        REQUIRE(merged.features.size() == 12);
+        CHECK(merged.datum.lat == a.lat);
+        CHECK(merged.global_properties.at("field") == "3");
+        CHECK(merged.features[0].properties.at("source") == "a");
+        CHECK(merged.features[11].properties.at("source") == "c");
+        auto before = onGround(fc, 4), after = onGround(merged, 11);
+        CHECK(after.lat == doctest::Approx(before.lat).epsilon(1e-9));
+        CHECK(after.lon == doctest::Approx(before.lon).epsilon(1e-9));
+    }
+
+    SUBCASE("Errors name the file") {
+        std::ofstream(kDir / "broken.geojson") << "{ not json";
+        try {
+            geoson::readAll(kDir, opts);
+            FAIL("expected an error");
+        } catch (std::runtime_error const &e) {
+            CHECK(std::string(e.what()).find("broken.geojson") != std::string::npos);
+        }
+    }
+
+    std::vector<std::filesystem::path> none;
+    CHECK(geoson::readAllMerged(none).features.empty());
+    std::filesystem::remove_all(kDir);
+}
@@ -0,0 +1,136 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/shared.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_CASE("Shared - publish and view a Vector") {
+    const std::string name = "geoson_test_" + std::to_string(::getpid());
+    CHECK_THROWS(geoson::VectorView::open(name));
+
+    geoson::VectorPublisher publisher(name);
+    CHECK_THROWS(geoson::VectorView::open(name)); // nothing published yet
+    auto source = fixtures::makeVector(100);
+    CHECK(publisher.publish(source) == 1);
+
+    auto view = geoson::VectorView::open(name);
+    CHECK(view.generation() == 1);
+    CHECK_FALSE(view.stale());
+
+    SUBCASE("Zero-copy queries") {
+        REQUIRE(view.elementCount() == 100);
+        auto tree = view.element(3);
+        CHECK(tree.kind() == 0);
+        CHECK(tree.type() == "tree");
+        CHECK(tree.property("id") == "t3");
+        CHECK(tree.property("type") == "tree");
+        CHECK_FALSE(tree.property("missing"));
+        REQUIRE(tree.points().size() == 1);
+        CHECK(tree.points()[0].x == 3.0);
+        CHECK(tree.points()[0].z == 0.5);
+        CHECK(view.element(4).points().size() == 3);
+        CHECK(view.elementsOfType("row").size() == 33);
+        CHECK_THROWS_AS(view.element(100), std::out_of_range);
+
+        CHECK(view.datum().alt == 2.0);
+        CHECK(view.heading().yaw == 0.5);
+        CHECK(view.fieldBoundary().size() == 4);
+        CHECK(view.fieldProperty("crop") == "wheat");
+        CHECK(view.globalProperty("revision") == "1");
+    }
+
+    SUBCASE("Round trip through toVector") {
+        auto copy = view.toVector();
+        REQUIRE(copy.elementCount() == source.elementCount());
+        for (size_t i = 0; i < copy.elementCount(); ++i) {
+            CHECK(copy.getElement(i).properties == source.getElement(i).properties);
+            CHECK(copy.getElement(i).type == source.getElement(i).type);
+            CHECK(copy.getElement(i).geometry.index() == source.getElement(i).geometry.index());
+        }
+        CHECK(copy.getGlobalProperties() == source.getGlobalProperties());
+    }
+
+    SUBCASE("New versions are swapped in; open views keep theirs") {
+        CHECK(publisher.publish(fixtures::makeVector(10)) == 2);
+        CHECK(view.stale());
+        CHECK(view.elementCount() == 100); // still mapped
+        CHECK(publisher.publish(fixtures::makeVector(20)) == 3);
+        CHECK(view.element(99).property("id") == "t99");
+
+        auto latest = geoson::VectorView::open(name);
+        CHECK(latest.generation() == 3);
+        CHECK(latest.elementCount() == 20);
+        CHECK_FALSE(latest.stale());
+    }
+
+    SUBCASE("Another process maps it") {
+        pid_t child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            bool ok = false;
+            try {
+                auto v = geoson::VectorView::open(name);
+                ok = v.elementCount() == 100 && v.element(7).property("id") == "r7";
+            } catch (...) {
+            }
+            ::_exit(ok ? 0 : 1);
+        }
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+    }
+}
+
+TEST_CASE("Shared - a restarted publisher") {
+    const std::string name = "geoson_restart_" + std::to_string(::getpid());
+
+    SUBCASE("Views of a destroyed publisher go stale") {
+        std::optional<geoson::VectorView> view;
+        {
+            geoson::VectorPublisher publisher(name);
+            publisher.publish(fixtures::makeVector(100));
+            view = geoson::VectorView::open(name);
+            CHECK_FALSE(view->stale());
+        }
+        CHECK(view->stale());
+        CHECK(view->elementCount() == 100); // still mapped
+
+        geoson::VectorPublisher restarted(name);
+        restarted.publish(fixtures::makeVector(10));
+        CHECK(view->stale());
+        auto latest = geoson::VectorView::open(name);
+        CHECK(latest.elementCount() == 10);
+        CHECK_FALSE(latest.stale());
+    }
+
+    SUBCASE("A publisher that died is taken over") {
+        pid_t child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            geoson::VectorPublisher publisher(name);
+            publisher.publish(fixtures::makeVector(100));
+            publisher.publish(fixtures::makeVector(50));
+            ::_exit(0); // no destructor: the segments stay behind, as after a crash
+        }
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        REQUIRE(WIFEXITED(status));
+
+        auto view = geoson::VectorView::open(name);
+        CHECK(view.generation() == 2);
+        CHECK(view.elementCount() == 50);
+
+        geoson::VectorPublisher restarted(name);
+        CHECK(restarted.generation() == 2);
+        CHECK_FALSE(view.stale());
+        CHECK(restarted.publish(fixtures::makeVector(10)) == 3);
+        CHECK(view.stale());
+        CHECK(geoson::VectorView::open(name).elementCount() == 10);
+    }
+}
+#endif
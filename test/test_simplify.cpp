@@ -0,0 +1,160 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace {
+    // zig-zag of amplitude `wiggle` along the x axis
+    std::vector<concord::Point> zigzag(size_t n, double wiggle) {
+        std::vector<concord::Point> pts;
+        for (size_t i = 0; i < n; ++i)
+            pts.emplace_back(static_cast<double>(i), (i % 2 ? wiggle : -wiggle), 0.0);
+        return pts;
+    }
+
+    double maxDeviation(std::vector<concord::Point> const &original, std::vector<concord::Point> const &simplified) {
+        double worst = 0.0;
+        for (auto const &p : original) {
+            double best = 1e300;
+            for (size_t i = 0; i + 1 < simplified.size(); ++i)
+                best = std::min(best, geoson::op::segmentDistance(p, simplified[i], simplified[i + 1]));
+            worst = std::max(worst, best);
+        }
+        return worst;
+    }
+} // namespace
+
+TEST_CASE("Simplify - Douglas-Peucker") {
+    SUBCASE("Collinear points collapse to the endpoints") {
+        std::vector<concord::Point> pts = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {2.0, 0.0, 0.0}, {3.0, 0.0, 0.0}};
+        auto out = geoson::douglasPeucker(pts, 0.01);
+        REQUIRE(out.size() == 2);
+        CHECK(out[1].x == doctest::Approx(3.0));
+    }
+
+    SUBCASE("Features above the tolerance are kept") {
+        std::vector<concord::Point> pts = {{0.0, 0.0, 0.0}, {5.0, 2.0, 0.0}, {10.0, 0.0, 0.0}};
+        CHECK(geoson::douglasPeucker(pts, 1.0).size() == 3);
+        CHECK(geoson::douglasPeucker(pts, 3.0).size() == 2);
+    }
+
+    SUBCASE("Zero tolerance is a no-op") {
+        auto pts = zigzag(50, 0.1);
+        CHECK(geoson::douglasPeucker(pts, 0.0).size() == 50);
+    }
+
+    SUBCASE("Geometry helper") {
+        auto path = geoson::simplify(concord::Path{zigzag(100, 0.01)}, 0.5);
+        CHECK(std::holds_alternative<concord::Line>(path));
+
+        std::vector<concord::Point> tri = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.5, 0.001, 0.0}, {0.0, 0.0, 0.0}};
+        auto poly = geoson::simplify(concord::Polygon{tri}, 1.0);
+        REQUIRE(std::holds_alternative<concord::Polygon>(poly));
+        CHECK(std::get<concord::Polygon>(poly).getPoints().size() == 4);
+    }
+}
+
+TEST_CASE("Simplify - streaming simplifier") {
+    auto pts = zigzag(5000, 0.2);
+    for (auto &p : pts)
+        p.y += std::sin(static_cast<double>(p.x) / 200.0) * 50.0;
+
+    std::vector<concord::Point> out;
+    geoson::StreamingSimplifier s(out, 0.5);
+    for (auto const &p : pts)
+        s.push(p);
+    s.finish();
+
+    CHECK(out.size() < pts.size() / 10);
+    CHECK(out.front().x == doctest::Approx(pts.front().x));
+    CHECK(out.back().x == doctest::Approx(pts.back().x));
+    CHECK(maxDeviation(pts, out) <= 0.5 + 1e-9);
+}
+
+TEST_CASE("Simplify - ReadOptions at parse time") {
+    const std::filesystem::path test_file = "/tmp/simplify_trajectory.geojson";
+    nlohmann::json coords = nlohmann::json::array();
+    for (int i = 0; i < 2000; ++i)
+        coords.push_back({i * 0.5, (i % 2 ? 0.05 : -0.05), 0.0});
+    nlohmann::json ring = nlohmann::json::array({{0.0, 0.0}, {10.0, 0.0}, {10.0, 10.0}, {0.0, 10.0}, {0.0, 0.0}});
+
+    nlohmann::json fc = {
+        {"type", "FeatureCollection"},
+        {"properties", {{"crs", "ENU"}, {"datum", {52.0, 5.0, 0.0}}, {"heading", 0.0}}},
+        {"features",
+         {{{"type", "Feature"}, {"geometry", {{"type", "LineString"}, {"coordinates", coords}}}, {"properties", {}}},
+          {{"type", "Feature"},
+           {"geometry", {{"type", "Polygon"}, {"coordinates", {ring}}}},
+           {"properties", {}}}}}};
+    std::ofstream(test_file) << fc.dump();
+
+    SUBCASE("Defaults keep every vertex") {
+        auto full = geoson::read(test_file);
+        REQUIRE(full.features.size() == 2);
+        CHECK(std::get<concord::Path>(full.features[0].geometry).getPoints().size() == 2000);
+    }
+
+    SUBCASE("Tolerance removes sub-tolerance noise") {
+        geoson::ReadOptions opts;
+        opts.simplifyTolerance = 0.1;
+        auto preview = geoson::read(test_file, opts);
+        REQUIRE(preview.features.size() == 2);
+        // only window boundaries survive on a straight, noisy trajectory
+        auto const &pts = std::get<concord::Path>(preview.features[0].geometry).getPoints();
+        CHECK(pts.size() <= 2000 / (geoson::StreamingSimplifier::kWindow - 1) + 2);
+        CHECK(pts.back().x == doctest::Approx(999.5));
+        CHECK(std::get<concord::Polygon>(preview.features[1].geometry).getPoints().size() == 5);
+    }
+
+    SUBCASE("Vertex budget strides the input") {
+        geoson::ReadOptions opts;
+        opts.maxVerticesPerGeometry = 100;
+        auto preview = geoson::read(test_file, opts);
+        auto const &pts = std::get<concord::Path>(preview.features[0].geometry).getPoints();
+        CHECK(pts.size() == 100);
+        CHECK(pts.front().x == doctest::Approx(0.0));
+        CHECK(pts.back().x == doctest::Approx(999.5));
+    }
+
+    SUBCASE("Vertex budget never drops a ring below four vertices") {
+        geoson::ReadOptions opts;
+        opts.maxVerticesPerGeometry = 1;
+        auto preview = geoson::read(test_file, opts);
+        CHECK(std::get<concord::Polygon>(preview.features[1].geometry).getPoints().size() == 4);
+        CHECK(std::holds_alternative<concord::Line>(preview.features[0].geometry));
+    }
+
+    SUBCASE("Decimating reads stream the file, header last or in parallel") {
+        nlohmann::json track = nlohmann::json::array();
+        for (int i = 0; i < 50; ++i)
+            track.push_back({i * 1.0, (i % 2 ? 0.05 : -0.05), 0.0});
+        nlohmann::json features = nlohmann::json::array();
+        for (int i = 0; i < 1000; ++i)
+            features.push_back({{"type", "Feature"},
+                                {"geometry", {{"type", "LineString"}, {"coordinates", track}}},
+                                {"properties", {{"id", std::to_string(i)}}}});
+        // features before the header, as some exporters write them
+        std::ofstream(test_file) << R"({"type":"FeatureCollection","features":)" << features.dump()
+                                 << R"(,"properties":)" << fc["properties"].dump() << "}";
+
+        geoson::ReadOptions opts;
+        opts.maxVerticesPerGeometry = 10;
+        auto serial = geoson::read(test_file, opts);
+        REQUIRE(serial.features.size() == 1000);
+        CHECK(serial.datum.lat == 52.0);
+        CHECK(std::get<concord::Path>(serial.features[0].geometry).getPoints().size() == 10);
+
+        geoson::ThreadPool pool(3);
+        opts.executor = &pool;
+        auto parallel = geoson::read(test_file, opts);
+        REQUIRE(parallel.features.size() == 1000);
+        for (size_t i = 0; i < 1000; ++i)
+            CHECK(parallel.features[i].properties.at("id") == std::to_string(i));
+    }
+
+    std::filesystem::remove(test_file);
+}
@@ -0,0 +1,72 @@
+#define GEOSON_ENABLE_STATS 1
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/geoson.hpp"
+#include <filesystem>
+
+TEST_CASE("Stats - per-phase read and write instrumentation") {
+    REQUIRE(geoson::statsEnabled);
+    const std::filesystem::path file = "/tmp/stats_test.geojson";
+    auto fc = fixtures::makeCollection(100);
+    uint64_t vertices = 0, properties = 0;
+    for (auto const &f : fc.features) {
+        vertices += geoson::vertexCount(f.geometry);
+        properties += f.properties.size();
+    }
+
+    SUBCASE("WriteStats") {
+        geoson::WriteStats stats;
+        geoson::WriteOptions opts;
+        opts.outputCrs = geoson::CRS::WGS;
+        opts.stats = &stats;
+        geoson::write(fc, file, opts);
+
+        CHECK(stats.features == 100);
+        CHECK(stats.vertices == vertices);
+        CHECK(stats.properties == properties);
+        CHECK(stats.bytes == std::filesystem::file_size(file));
+        CHECK(stats.conversionNs > 0);
+        CHECK(stats.serializeNs > 0);
+        CHECK(stats.totalNs() >= stats.conversionNs + stats.serializeNs);
+
+        // ENU output converts nothing
+        geoson::WriteStats enu;
+        opts.outputCrs = geoson::CRS::ENU;
+        opts.stats = &enu;
+        geoson::write(fc, file, opts);
+        CHECK(enu.conversionNs == 0);
+        CHECK(enu.vertices == stats.vertices);
+    }
+
+    SUBCASE("ParseStats") {
+        geoson::write(fc, file, geoson::CRS::WGS);
+        geoson::ParseStats stats;
+        geoson::ReadOptions opts;
+        opts.stats = &stats;
+        auto back = geoson::read(file, opts);
+
+        CHECK(stats.bytes == std::filesystem::file_size(file));
+        CHECK(stats.features == back.features.size());
+        CHECK(stats.vertices == vertices);
+        CHECK(stats.properties == properties);
+        CHECK(stats.tokenizeNs > 0);
+        CHECK(stats.conversionNs > 0);
+        CHECK(stats.geometryNs < stats.totalNs());
+
+        // counters accumulate across reads
+        geoson::read(file, opts);
+        CHECK(stats.features == 2 * back.features.size());
+    }
+
+    SUBCASE("No stats requested, nothing recorded") {
+        geoson::write(fc, file);
+        CHECK(geoson::op::activeParseStats == nullptr);
+        CHECK(geoson::op::activeWriteStats == nullptr);
+        auto back = geoson::read(file);
+        CHECK(back.features.size() == 100);
+    }
+
+    std::filesystem::remove(file);
+}
@@ -0,0 +1,162 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/store.hpp"
+#include <filesystem>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+    void checkElement(geoson::Element const &a, geoson::Element const &b) {
+        CHECK(a.type == b.type);
+        CHECK(a.properties == b.properties);
+        CHECK(a.geometry.index() == b.geometry.index());
+        auto va = geoson::vertices(a.geometry), vb = geoson::vertices(b.geometry);
+        REQUIRE(va.size() == vb.size());
+        for (size_t i = 0; i < va.size(); ++i) {
+            CHECK(va[i].x == vb[i].x);
+            CHECK(va[i].y == vb[i].y);
+        }
+    }
+} // namespace
+
+TEST_CASE("Store - persistent vector") {
+    const std::filesystem::path file = "/tmp/store_test.gvs";
+    const std::filesystem::path crashed = "/tmp/store_test_crashed.gvs";
+    auto source = fixtures::makeVector(3000); // more elements than the initial slot table holds
+
+    SUBCASE("Create, mutate and reopen") {
+        {
+            auto store = geoson::VectorStore::create(file, source);
+            CHECK(store.size() == 3000);
+            checkElement(store.get(7), source.getElement(7));
+
+            store.update(7, geoson::Element(concord::Point{9, 9, 0}, {{"id", "moved"}}, "tree"));
+            store.remove(8);
+            CHECK_FALSE(store.contains(8));
+            CHECK_THROWS_AS(store.get(8), std::out_of_range);
+            auto id = store.add(geoson::Element(concord::Point{1, 2, 3}, {{"id", "new"}}, "post"));
+            CHECK(id == 8); // removed ids are reused
+            CHECK(store.size() == 3000);
+
+            auto header = store.header();
+            header.setGlobalProperty("revision", "2");
+            store.setHeader(header);
+        }
+
+        auto store = geoson::VectorStore::open(file);
+        CHECK_FALSE(store.recovered());
+        CHECK(store.size() == 3000);
+        CHECK(store.get(7).properties.at("id") == "moved");
+        CHECK(store.get(8).type == "post");
+        checkElement(store.get(2999), source.getElement(2999));
+
+        auto loaded = store.load();
+        CHECK(loaded.elementCount() == 3000);
+        CHECK(loaded.getDatum().alt == 2.0);
+        CHECK(loaded.getHeading().yaw == 0.5);
+        CHECK(loaded.getFieldProperties().at("crop") == "wheat");
+        CHECK(loaded.getGlobalProperty("revision") == "2");
+        CHECK(loaded.getFieldBoundary().getPoints().size() == 4);
+    }
+
+    SUBCASE("Freed blocks are reused") {
+        auto store = geoson::VectorStore::create(file, source);
+        auto used = store.bytesUsed();
+        for (uint64_t id = 0; id < 100; ++id)
+            store.update(id, source.getElement(id));
+        store.flush(); // the replaced blocks become reusable once no durable slot refers to them
+        auto updated = store.bytesUsed();
+        CHECK(updated <= used + 64 * 1024);
+        for (uint64_t id = 0; id < 100; ++id)
+            store.remove(id);
+        store.flush();
+        for (uint64_t id = 0; id < 100; ++id)
+            store.add(source.getElement(id)); // same size: each takes a block freed above
+        CHECK(store.bytesUsed() == updated);
+        CHECK(store.size() == 3000);
+    }
+
+    SUBCASE("Recovery after a crash") {
+        {
+            geoson::StoreOptions opts;
+            opts.sync = geoson::SyncPolicy::EveryWrite;
+            auto store = geoson::VectorStore::create(file, source, opts);
+            store.remove(3);
+            store.update(4, geoson::Element(concord::Point{5, 5, 0}, {{"id", "edited"}}, "tree"));
+            // a copy taken while the store is open looks like a file whose writer died
+            std::filesystem::copy_file(file, crashed, std::filesystem::copy_options::overwrite_existing);
+        }
+
+        SUBCASE("Completed mutations survive") {
+            auto store = geoson::VectorStore::open(crashed);
+            CHECK(store.recovered());
+            CHECK(store.size() == 2999);
+            CHECK_FALSE(store.contains(3));
+            CHECK(store.get(4).properties.at("id") == "edited");
+            CHECK(store.add(source.getElement(3)) == 3);
+        }
+
+        SUBCASE("A torn element is dropped") {
+            // corrupt the payload of element 10's block: find it by its unique id property
+            std::string bytes;
+            {
+                std::ifstream in(crashed, std::ios::binary);
+                bytes.assign(std::istreambuf_iterator<char>(in), {});
+            }
+            auto at = bytes.find("\x03\0\0\0" "r10", 0, 7); // length-prefixed "r10"
+            REQUIRE(at != std::string::npos);
+            bytes[at + 4] = 'X';
+            {
+                std::ofstream out(crashed, std::ios::binary | std::ios::trunc);
+                out << bytes;
+            }
+            auto store = geoson::VectorStore::open(crashed);
+            CHECK(store.recovered());
+            CHECK(store.size() == 2998);
+            CHECK_FALSE(store.contains(10));
+        }
+    }
+
+    SUBCASE("Manual: a crash loses only what came after the last flush") {
+        auto readFile = [](std::filesystem::path const &f) {
+            std::ifstream in(f, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(in), {});
+        };
+        auto store = geoson::VectorStore::create(file, source); // flushed
+        std::string flushed = readFile(file);
+        auto at = flushed.find("\x02\0\0\0" "id" "\x02\0\0\0" "t6", 0, 12); // element 6's block
+        REQUIRE(at != std::string::npos);
+
+        auto edited = source.getElement(6);
+        edited.properties["id"] = "u6"; // same size, so a freed block of 6 would be taken next
+        store.update(6, edited);
+        edited.properties["id"] = "n6";
+        store.add(edited);
+        std::string now = readFile(file);
+
+        // the process dies having written back the page of 6's old block, but not the slot table or header
+        auto page = at & ~size_t(4095);
+        flushed.replace(page, 4096, now, page, 4096);
+        {
+            std::ofstream out(crashed, std::ios::binary | std::ios::trunc);
+            out << flushed;
+        }
+        auto reopened = geoson::VectorStore::open(crashed);
+        CHECK(reopened.recovered());
+        CHECK(reopened.size() == 3000);
+        REQUIRE(reopened.contains(6));
+        CHECK(reopened.get(6).properties.at("id") == "t6");
+    }
+
+    SUBCASE("Only one writer at a time") {
+        auto store = geoson::VectorStore::create(file, source);
+        CHECK_THROWS(geoson::VectorStore::open(file));
+        CHECK_THROWS(geoson::VectorStore::open("/tmp/store_missing.gvs"));
+    }
+
+    std::filesystem::remove(file);
+    std::filesystem::remove(crashed);
+}
+#endif
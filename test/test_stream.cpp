@@ -0,0 +1,121 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/stream.hpp"
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace {
+    geoson::FeatureCollection makeCollection(size_t n) {
+        geoson::FeatureCollection fc;
+        fc.datum = concord::Datum{52.0, 5.0, 0.0};
+        fc.heading = concord::Euler{0.0, 0.0, 1.5};
+        fc.global_properties["owner"] = "wur";
+        for (size_t i = 0; i < n; ++i) {
+            double x = static_cast<double>(i);
+            if (i % 3 == 0)
+                fc.features.push_back({concord::Point{x, 2.0 * x, 0.0}, {{"id", std::to_string(i)}}});
+            else if (i % 3 == 1)
+                fc.features.push_back({concord::Path{{{x, 0.0, 0.0}, {x, 1.0, 0.0}, {x, 2.0, 0.0}}}, {{"id", "p"}}});
+            else
+                fc.features.push_back(
+                    {concord::Polygon{{{x, 0.0, 0.0}, {x + 1.0, 0.0, 0.0}, {x, 1.0, 0.0}, {x, 0.0, 0.0}}}, {}});
+        }
+        return fc;
+    }
+} // namespace
+
+TEST_CASE("FeatureReader - streams what ReadFeatureCollection reads") {
+    const std::filesystem::path test_file = "/tmp/stream_test.geojson";
+    auto fc = makeCollection(100);
+
+    SUBCASE("Header after features (geoson's own key order)") {
+        geoson::write(fc, test_file, geoson::CRS::WGS);
+
+        geoson::FeatureReader reader(test_file);
+        CHECK(reader.header().crs == geoson::CRS::WGS);
+        CHECK(reader.header().heading.yaw == doctest::Approx(1.5));
+        CHECK(reader.header().global_properties.at("owner") == "wur");
+
+        auto full = geoson::read(test_file);
+        std::vector<geoson::Feature> batch;
+        size_t i = 0;
+        while (reader.next(batch)) {
+            REQUIRE(batch.size() == 1);
+            REQUIRE(i < full.features.size());
+            CHECK(batch[0].geometry.index() == full.features[i].geometry.index());
+            CHECK(batch[0].properties == full.features[i].properties);
+            ++i;
+        }
+        CHECK(i == full.features.size());
+    }
+
+    SUBCASE("Header before features, multi geometries and null geometry") {
+        std::ofstream(test_file) << R"({
+            "type": "FeatureCollection",
+            "properties": {"crs": "ENU", "datum": [52.0, 5.0, 0.0], "heading": 0.0},
+            "features": [
+                {"type": "Feature", "geometry": {"type": "MultiPoint", "coordinates": [[1, 2], [3, 4]]},
+                 "properties": {"name": "a \"quoted\" ] value"}},
+                {"type": "Feature", "geometry": null, "properties": {}},
+                {"type": "Feature", "geometry": {"type": "Point", "coordinates": [5, 6]}}
+            ]
+        })";
+
+        size_t features = 0;
+        geoson::forEachFeature(test_file, [&](std::vector<geoson::Feature> &batch) { features += batch.size(); });
+        CHECK(features == 3);
+
+        geoson::FeatureReader reader(test_file);
+        nlohmann::json feat;
+        REQUIRE(reader.nextJson(feat));
+        CHECK(feat["properties"]["name"] == "a \"quoted\" ] value");
+    }
+
+    SUBCASE("Empty collection") {
+        geoson::FeatureCollection empty = makeCollection(0);
+        geoson::write(empty, test_file);
+        geoson::FeatureReader reader(test_file);
+        std::vector<geoson::Feature> batch;
+        CHECK_FALSE(reader.next(batch));
+        CHECK(reader.shards(4).size() <= 1);
+    }
+
+    SUBCASE("Errors match the in-memory reader") {
+        std::ofstream(test_file) << R"({"type": "Feature", "geometry": null, "properties": {}})";
+        CHECK_THROWS_WITH(geoson::FeatureReader{test_file}, "missing top-level 'properties'");
+
+        std::ofstream(test_file) << R"({"type": "FeatureCollection", "features": []})";
+        CHECK_THROWS_WITH(geoson::FeatureReader{test_file}, "missing top-level 'properties'");
+
+        CHECK_THROWS_WITH(geoson::FeatureReader{"/nonexistent/file.geojson"}, doctest::Contains("cannot open"));
+    }
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("FeatureReader - byte-range shards") {
+    const std::filesystem::path test_file = "/tmp/stream_shards.geojson";
+    geoson::write(makeCollection(1000), test_file);
+
+    geoson::FeatureReader reader(test_file);
+    auto cuts = reader.shards(4);
+    REQUIRE(cuts.size() == 5);
+
+    size_t total = 0;
+    for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+        CHECK(cuts[i] < cuts[i + 1]);
+        geoson::FeatureReader shard(test_file, reader.header(), cuts[i], cuts[i + 1]);
+        nlohmann::json feat;
+        size_t n = 0;
+        while (shard.nextJson(feat))
+            ++n;
+        CHECK(n > 100); // roughly balanced
+        total += n;
+    }
+    CHECK(total == 1000);
+
+    std::filesystem::remove(test_file);
+}
@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/summary.hpp"
+#include <filesystem>
+#include <fstream>
+
+TEST_CASE("Summary - HyperLogLog") {
+    geoson::HyperLogLog a, b;
+    for (int i = 0; i < 50000; ++i)
+        a.add(std::to_string(i));
+    for (int i = 25000; i < 100000; ++i)
+        b.add(std::to_string(i));
+
+    CHECK(std::abs(a.estimate() - 50000.0) / 50000.0 < 0.05);
+    a.merge(b);
+    CHECK(std::abs(a.estimate() - 100000.0) / 100000.0 < 0.05);
+
+    geoson::HyperLogLog small;
+    for (int i = 0; i < 10; ++i)
+        small.add("same");
+    small.add("other");
+    CHECK(small.estimate() == doctest::Approx(2.0).epsilon(0.01));
+}
+
+TEST_CASE("Summary - summarize") {
+    const std::filesystem::path test_file = "/tmp/summary_test.geojson";
+
+    geoson::FeatureCollection fc;
+    fc.datum = concord::Datum{52.0, 5.0, 0.0};
+    for (int i = 0; i < 3000; ++i) {
+        double x = i * 0.5;
+        std::unordered_map<std::string, std::string> props{{"id", std::to_string(i)}, {"kind", i % 2 ? "a" : "b"}};
+        if (i % 3 == 0)
+            fc.features.push_back({concord::Point{x, -x, 1.0}, props});
+        else
+            fc.features.push_back({concord::Path{{{x, 0.0, 0.0}, {x, 10.0, 0.0}, {x + 1.0, 10.0, 0.0}}}, props});
+    }
+    geoson::write(fc, test_file, geoson::CRS::WGS);
+
+    geoson::SummaryOptions opts;
+    opts.exactDistinctLimit = 100;
+
+    auto check = [&](geoson::Summary const &s) {
+        CHECK(s.features == 3000);
+        CHECK(s.geometryTypes.at("Point") == 1000);
+        CHECK(s.geometryTypes.at("LineString") == 2000);
+        CHECK(s.vertices == 1000 + 2000 * 3);
+        CHECK(s.enu.min[0] == doctest::Approx(0.0).epsilon(1e-6));
+        CHECK(s.enu.max[0] == doctest::Approx(1500.5).epsilon(1e-6));
+        CHECK(s.enu.min[1] == doctest::Approx(-1498.5).epsilon(1e-6));
+        CHECK(s.wgs.min[0] == doctest::Approx(5.0).epsilon(1e-6));
+        CHECK(s.wgs.max[1] > 52.0);
+        CHECK(s.bytes == std::filesystem::file_size(test_file));
+
+        auto const &kind = s.properties.at("kind");
+        CHECK(kind.count == 3000);
+        CHECK(kind.exact);
+        CHECK(kind.distinct == doctest::Approx(2.0));
+
+        auto const &id = s.properties.at("id");
+        CHECK(id.count == 3000);
+        CHECK_FALSE(id.exact);
+        CHECK(std::abs(id.distinct - 3000.0) / 3000.0 < 0.05);
+    };
+
+    SUBCASE("Sequential") { check(geoson::summarize(test_file, opts)); }
+
+    SUBCASE("Parallel shards give the same answer") {
+        opts.threads = 4;
+        check(geoson::summarize(test_file, opts));
+    }
+
+    std::filesystem::remove(test_file);
+}
@@ -0,0 +1,128 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/trace.hpp"
+#include "geoson/vector.hpp"
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <thread>
+
+namespace {
+    std::multiset<std::string> spanNames() {
+        std::multiset<std::string> names;
+        auto trace = geoson::trace::toJson();
+        for (auto const &e : trace["traceEvents"])
+            if (e["ph"] == "X")
+                names.insert(e["name"].get<std::string>());
+        return names;
+    }
+} // namespace
+
+TEST_CASE("Trace - scoped spans") {
+    geoson::trace::clear();
+
+    SUBCASE("Disabled tracing records nothing") {
+        geoson::trace::enable(false);
+        { GEOSON_TRACE_SCOPE("ignored"); }
+        CHECK(spanNames().empty());
+    }
+
+    SUBCASE("Read, write and Vector queries are traced") {
+        const std::filesystem::path file = "/tmp/trace_test.geojson";
+        geoson::Vector v(concord::Polygon{{{0, 0, 0}, {10, 0, 0}, {10, 10, 0}, {0, 10, 0}, {0, 0, 0}}},
+                         concord::Datum{52.0, 5.0, 0.0});
+        v.addPoint(concord::Point{1, 2, 0}, "tree");
+
+        geoson::trace::enable();
+        v.toFile(file);
+        auto back = geoson::Vector::fromFile(file);
+        back.getPoints();
+        back.filterByProperty("type", "tree");
+        geoson::trace::enable(false);
+
+        auto names = spanNames();
+        for (auto const *n : {"write", "write/build", "write/serialize", "write/io", "read", "read/tokenize",
+                              "read/features", "Vector::toFile", "Vector::fromFile", "Vector::getPoints",
+                              "Vector::filterByProperty"}) {
+            INFO(n);
+            CHECK(names.count(n) == 1);
+        }
+
+        // nesting: a child span lies within its parent
+        auto events = geoson::trace::toJson()["traceEvents"];
+        nlohmann::json read, tokenize;
+        for (auto const &e : events) {
+            if (e["name"] == "read")
+                read = e;
+            if (e["name"] == "read/tokenize")
+                tokenize = e;
+        }
+        CHECK(tokenize["ts"].get<double>() >= read["ts"].get<double>());
+        CHECK(tokenize["ts"].get<double>() + tokenize["dur"].get<double>() <=
+              read["ts"].get<double>() + read["dur"].get<double>() + 1e-3);
+        CHECK(read["cat"] == "geoson");
+
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("Per-thread buffers, thread names and export") {
+        geoson::trace::enable();
+        std::thread worker([] {
+            geoson::trace::setThreadName("worker");
+            GEOSON_TRACE_SCOPE("work", "test");
+        });
+        worker.join();
+        { GEOSON_TRACE_SCOPE("main", "test"); }
+        geoson::trace::enable(false);
+
+        auto j = geoson::trace::toJson();
+        int64_t workTid = -1, mainTid = -2, namedTid = -3;
+        for (auto const &e : j["traceEvents"]) {
+            if (e["name"] == "work")
+                workTid = e["tid"];
+            if (e["name"] == "main")
+                mainTid = e["tid"];
+            if (e["ph"] == "M" && e["args"]["name"] == "worker")
+                namedTid = e["tid"];
+        }
+        CHECK(workTid != mainTid);
+        CHECK(workTid == namedTid);
+
+        const std::filesystem::path out = "/tmp/trace_test.json";
+        geoson::trace::write(out);
+        std::ifstream is(out);
+        CHECK(nlohmann::json::parse(is).contains("traceEvents"));
+        std::filesystem::remove(out);
+    }
+
+    SUBCASE("The ring keeps the most recent events") {
+        geoson::trace::enable();
+        static const char *names[] = {"old", "new"};
+        for (size_t i = 0; i < geoson::trace::op::ThreadBuffer::kCapacity + 10; ++i) {
+            GEOSON_TRACE_SCOPE(names[i >= 10 ? 1 : 0]);
+        }
+        geoson::trace::enable(false);
+        auto names_ = spanNames();
+        CHECK(names_.count("old") == 0);
+        CHECK(names_.count("new") >= geoson::trace::op::ThreadBuffer::kCapacity - 1);
+    }
+
+    SUBCASE("Events recorded before clear() stay dropped") {
+        geoson::trace::enable();
+        { GEOSON_TRACE_SCOPE("before"); }
+        std::thread worker([] { GEOSON_TRACE_SCOPE("worker-before"); });
+        worker.join();
+        geoson::trace::clear();
+        { GEOSON_TRACE_SCOPE("after"); }
+        geoson::trace::enable(false);
+        auto names_ = spanNames();
+        CHECK(names_.count("before") == 0);
+        CHECK(names_.count("worker-before") == 0);
+        CHECK(names_.count("after") == 1);
+    }
+
+    geoson::trace::clear();
+}
@@ -0,0 +1,137 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "geoson/geoson.hpp"
+#include "geoson/geometry.hpp"
+#include "geoson/transcode.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    geoson::FeatureCollection makeCollection(size_t n) {
+        geoson::FeatureCollection fc;
+        fc.datum = concord::Datum{52.0, 5.0, 10.0};
+        fc.heading = concord::Euler{0.0, 0.0, 0.25};
+        fc.global_properties["campaign"] = "spring";
+        for (size_t i = 0; i < n; ++i) {
+            double x = static_cast<double>(i) * 3.0;
+            std::unordered_map<std::string, std::string> props{{"id", std::to_string(i)}};
+            if (i % 2)
+                fc.features.push_back({concord::Point{x, -x, 1.0}, props});
+            else
+                fc.features.push_back(
+                    {concord::Polygon{{{x, 0.0, 0.0}, {x + 2.0, 0.0, 0.0}, {x, 2.0, 0.0}, {x, 0.0, 0.0}}}, props});
+        }
+        return fc;
+    }
+
+    void checkSame(geoson::FeatureCollection const &a, geoson::FeatureCollection const &b, double tol) {
+        REQUIRE(a.features.size() == b.features.size());
+        CHECK(a.global_properties == b.global_properties);
+        CHECK(a.heading.yaw == doctest::Approx(b.heading.yaw));
+        for (size_t i = 0; i < a.features.size(); ++i) {
+            CHECK(a.features[i].properties == b.features[i].properties);
+            auto va = geoson::vertices(a.features[i].geometry);
+            auto vb = geoson::vertices(b.features[i].geometry);
+            REQUIRE(va.size() == vb.size());
+            for (size_t k = 0; k < va.size(); ++k) {
+                CHECK(std::abs(va[k].x - vb[k].x) < tol);
+                CHECK(std::abs(va[k].y - vb[k].y) < tol);
+                CHECK(std::abs(va[k].z - vb[k].z) < tol);
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("Transcode - streaming CRS conversion") {
+    const std::filesystem::path src = "/tmp/transcode_src.geojson";
+    const std::filesystem::path dst = "/tmp/transcode_dst.geojson";
+    const std::filesystem::path back = "/tmp/transcode_back.geojson";
+    auto fc = makeCollection(1000);
+
+    SUBCASE("WGS to ENU matches read + write") {
+        geoson::write(fc, src, geoson::CRS::WGS);
+        geoson::TranscodeOptions opts;
+        opts.batchSize = 64; // several batches in flight
+        CHECK(geoson::transcode(src, dst, geoson::CRS::ENU, opts) == 1000);
+
+        geoson::FeatureReader reader(dst);
+        CHECK(reader.header().crs == geoson::CRS::ENU);
+        checkSame(geoson::read(dst), fc, 1e-6);
+    }
+
+    SUBCASE("ENU to WGS and back round-trips") {
+        geoson::write(fc, src, geoson::CRS::ENU);
+        geoson::transcode(src, dst, geoson::CRS::WGS);
+        geoson::transcode(dst, back, geoson::CRS::ENU);
+        checkSame(geoson::read(back), fc, 1e-6);
+    }
+
+    SUBCASE("Re-anchoring around another datum") {
+        geoson::write(fc, src, geoson::CRS::ENU);
+        geoson::TranscodeOptions opts;
+        opts.datum = concord::Datum{52.001, 5.0, 10.0}; // ~111 m further north
+        geoson::transcode(src, dst, geoson::CRS::ENU, opts);
+
+        auto moved = geoson::read(dst);
+        CHECK(moved.datum.lat == doctest::Approx(52.001));
+        // the same physical points, expressed around the new origin
+        geoson::FeatureCollection expected = fc;
+        expected.datum = moved.datum;
+        for (auto &f : expected.features) {
+            std::vector<concord::Point> pts;
+            for (auto const &p : geoson::vertices(f.geometry)) {
+                auto wgs = concord::ENU{p, fc.datum}.toWGS();
+                auto enu = wgs.toENU(moved.datum);
+                pts.emplace_back(enu.x, enu.y, enu.z);
+            }
+            f.geometry = pts.size() == 1 ? geoson::Geometry{pts[0]} : geoson::Geometry{concord::Polygon{pts}};
+        }
+        checkSame(moved, expected, 1e-6);
+        auto const &p = std::get<concord::Point>(moved.features[1].geometry);
+        CHECK(p.y == doctest::Approx(-3.0 - 111.25).epsilon(0.01));
+    }
+
+    SUBCASE("Compact-profile input is expanded") {
+        geoson::WriteOptions wopts;
+        wopts.quantum = 0.001;
+        geoson::write(fc, src, wopts);
+        geoson::transcode(src, dst, geoson::CRS::ENU);
+        std::ifstream is(dst);
+        auto j = nlohmann::json::parse(is);
+        CHECK_FALSE(j["properties"].contains("transform"));
+        checkSame(geoson::read(dst), fc, 1e-3);
+    }
+
+    SUBCASE("Errors propagate and leave no partial output") {
+        std::ofstream(src) << R"({"type": "FeatureCollection",
+            "properties": {"crs": "ENU", "datum": [52.0, 5.0, 0.0], "heading": 0.0},
+            "features": [
+                {"type": "Feature", "geometry": {"type": "Point", "coordinates": [1, 2]}, "properties": {}},
+                {"type": "Feature", "geometry": {"type": "Point", "coordinates": ["x", 2]}, "properties": {}}
+            ]})";
+        CHECK_THROWS(geoson::transcode(src, dst, geoson::CRS::WGS));
+        CHECK_FALSE(std::filesystem::exists(dst));
+
+        CHECK_THROWS_WITH(geoson::transcode("/nonexistent/in.geojson", dst, geoson::CRS::WGS),
+                          doctest::Contains("cannot open"));
+    }
+
+    for (auto const &p : {src, dst, back})
+        std::filesystem::remove(p);
+}
+
+TEST_CASE("Transcode - FeatureWriter") {
+    const std::filesystem::path file = "/tmp/feature_writer.geojson";
+    auto fc = makeCollection(10);
+    geoson::CollectionHeader header{geoson::CRS::WGS, fc.datum, fc.heading, fc.global_properties, std::nullopt};
+    {
+        geoson::FeatureWriter w(file, header, geoson::CRS::WGS);
+        for (auto const &f : fc.features)
+            w.write(f);
+        CHECK(w.count() == 10);
+    } // destructor terminates the collection
+
+    checkSame(geoson::read(file), fc, 1e-6);
+    std::filesystem::remove(file);
+}
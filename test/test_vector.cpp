@@ -234,4 +234,298 @@ TEST_CASE("Vector - Iterators") {
         ++it;
         CHECK(it == vector.end());
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Vector - Change Observers") {
+    geoson::Vector vector(concord::Polygon{{{0, 0, 0}, {10, 0, 0}, {10, 10, 0}, {0, 0, 0}}});
+    for (int i = 0; i < 4; ++i)
+        vector.addPoint({double(i), double(i), 0.0}, "tree", {{"id", "t" + std::to_string(i)}});
+
+    std::vector<std::vector<geoson::ElementChange>> calls;
+    auto handle = vector.subscribe([&](const geoson::Vector &, std::span<const geoson::ElementChange> changes) {
+        calls.emplace_back(changes.begin(), changes.end());
+    });
+
+    SUBCASE("Stable ids") {
+        uint64_t id2 = vector.elementId(2);
+        vector.removeElement(0);
+        CHECK(vector.elementId(1) == id2);
+        CHECK(vector.indexOf(id2) == 1);
+        CHECK_FALSE(vector.indexOf(vector.elementId(0) - 1));
+        CHECK_THROWS_AS(vector.elementId(3), std::out_of_range);
+    }
+
+    SUBCASE("Each mutation is reported") {
+        uint64_t id1 = vector.elementId(1);
+        vector.addPoint({5, 5, 0}, "post");
+        vector.setElementGeometry(1, concord::Point{9, 8, 0});
+        vector.setElementProperty(1, "height", "3");
+        vector.setElementProperty(1, "height", "3"); // no change
+        vector.removeElement(1);
+        REQUIRE(calls.size() == 4);
+        CHECK(calls[0][0].kind == geoson::ChangeKind::Added);
+        CHECK(calls[0][0].id == vector.elementId(3));
+        CHECK(calls[1][0].kind == geoson::ChangeKind::GeometryChanged);
+        CHECK(calls[1][0].oldBox.min[0] == 1.0);
+        CHECK(calls[2][0].kind == geoson::ChangeKind::PropertiesChanged);
+        CHECK(calls[2][0].keys == std::vector<std::string>{"height"});
+        CHECK(calls[3][0].kind == geoson::ChangeKind::Removed);
+        CHECK(calls[3][0].id == id1);
+        CHECK(calls[3][0].oldBox.min[0] == 9.0);
+    }
+
+    SUBCASE("Replace and edit report what differs") {
+        vector.replaceElement(0, geoson::Element(concord::Point{0, 0, 0}, {{"id", "t0"}, {"type", "stump"}}, "stump"));
+        REQUIRE(calls.size() == 1);
+        REQUIRE(calls[0].size() == 1);
+        CHECK(calls[0][0].kind == geoson::ChangeKind::PropertiesChanged);
+        CHECK(calls[0][0].keys == std::vector<std::string>{"type"});
+
+        vector.editElement(2, [](geoson::Element &e) {
+            e.geometry = concord::Point{7, 7, 0};
+            e.properties.erase("id");
+        });
+        REQUIRE(calls.size() == 2);
+        REQUIRE(calls[1].size() == 2);
+        CHECK(calls[1][0].kind == geoson::ChangeKind::GeometryChanged);
+        CHECK(calls[1][0].oldBox.max[1] == 2.0);
+        CHECK(calls[1][1].keys == std::vector<std::string>{"id"});
+    }
+
+    SUBCASE("appendElement keeps the element as it is") {
+        vector.appendElement(geoson::Element(concord::Point{5, 5, 0}, {{"id", "p0"}}, "post"));
+        REQUIRE(vector.elementCount() == 5);
+        CHECK(vector.getElement(4).type == "post");
+        CHECK_FALSE(vector.getElement(4).properties.count("type"));
+        REQUIRE(calls.size() == 1);
+        CHECK(calls[0][0].kind == geoson::ChangeKind::Added);
+        CHECK(calls[0][0].id == vector.elementId(4));
+    }
+
+    SUBCASE("A batch is coalesced into one notification") {
+        uint64_t id0 = vector.elementId(0), id3 = vector.elementId(3);
+        {
+            auto batch = vector.batch();
+            vector.setElementGeometry(0, concord::Point{4, 4, 0});
+            vector.setElementGeometry(0, concord::Point{6, 6, 0});
+            vector.setElementProperty(0, "b", "1");
+            vector.setElementProperty(0, "a", "1");
+            vector.addPoint({1, 1, 0}, "temp");
+            vector.setElementProperty(4, "x", "y");
+            vector.removeElement(4); // added and removed: never reported
+            vector.setElementGeometry(3, concord::Point{8, 8, 0});
+            vector.removeElement(3);
+            {
+                auto inner = vector.batch();
+                vector.addPoint({2, 2, 0}, "post");
+            }
+            CHECK(calls.empty());
+        }
+        REQUIRE(calls.size() == 1);
+        auto const &c = calls[0];
+        REQUIRE(c.size() == 4);
+        CHECK(c[0].kind == geoson::ChangeKind::GeometryChanged);
+        CHECK(c[0].id == id0);
+        CHECK(c[0].oldBox.min[0] == 0.0); // bounds before the batch
+        CHECK(c[1].kind == geoson::ChangeKind::PropertiesChanged);
+        CHECK(c[1].keys == std::vector<std::string>{"a", "b"});
+        CHECK(c[2].kind == geoson::ChangeKind::Removed);
+        CHECK(c[2].id == id3);
+        CHECK(c[2].oldBox.min[0] == 3.0);
+        CHECK(c[3].kind == geoson::ChangeKind::Added);
+        CHECK(vector.indexOf(c[3].id) == 3);
+    }
+
+    SUBCASE("Assignment replaces every element under fresh ids") {
+        std::vector<uint64_t> old;
+        for (size_t i = 0; i < vector.elementCount(); ++i)
+            old.push_back(vector.elementId(i));
+        geoson::Vector other(concord::Polygon{{{0, 0, 0}, {5, 0, 0}, {5, 5, 0}, {0, 0, 0}}});
+        other.addPoint({1, 1, 0}, "post");
+        other.addPoint({2, 2, 0}, "post");
+
+        vector = other;
+        REQUIRE(calls.size() == 1);
+        REQUIRE(calls[0].size() == 6);
+        for (size_t i = 0; i < 4; ++i) {
+            CHECK(calls[0][i].kind == geoson::ChangeKind::Removed);
+            CHECK(calls[0][i].id == old[i]);
+        }
+        CHECK(calls[0][4].kind == geoson::ChangeKind::Added);
+        CHECK(calls[0][4].id == vector.elementId(0));
+        CHECK(vector.elementCount() == 2);
+        CHECK(vector.elementId(0) > old.back()); // never reused
+        CHECK(other.elementCount() == 2);
+
+        vector = geoson::Vector(concord::Polygon{{{0, 0, 0}, {5, 0, 0}, {5, 5, 0}, {0, 0, 0}}});
+        REQUIRE(calls.size() == 2);
+        CHECK(calls[1].size() == 2);
+        vector.addPoint({3, 3, 0});
+        CHECK(vector.elementId(0) > calls[0][5].id);
+    }
+
+    SUBCASE("Unsubscribed and copied vectors are silent") {
+        geoson::Vector copy = vector;
+        copy.addPoint({1, 1, 0});
+        CHECK(copy.elementId(4) == vector.elementId(3) + 1);
+        vector.unsubscribe(handle);
+        vector.clearElements();
+        CHECK(calls.empty());
+    }
+}
+
+TEST_CASE("Vector - Undo and Redo") {
+    geoson::Vector vector(concord::Polygon{{{0, 0, 0}, {10, 0, 0}, {10, 10, 0}, {0, 0, 0}}});
+    for (int i = 0; i < 1000; ++i)
+        vector.addPoint({double(i), 0.0, 0.0}, "tree", {{"id", "t" + std::to_string(i)}});
+    auto snapshot = [&] {
+        std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> s;
+        for (size_t i = 0; i < vector.elementCount(); ++i)
+            s.emplace_back(vector.elementId(i), vector.getElement(i).properties);
+        return s;
+    };
+    auto original = snapshot();
+
+    SUBCASE("Edits are undone and redone together") {
+        vector.beginEdit("prune");
+        vector.setElementProperty(5, "height", "2");
+        vector.removeElement(7);
+        vector.addPoint({1, 1, 0}, "stump");
+        vector.setElementGeometry(0, concord::Point{9, 9, 0});
+        vector.replaceElement(1, geoson::Element(concord::Point{3, 3, 0}, {{"id", "moved"}}, "tree"));
+        vector.setGlobalProperty("revision", "2");
+        vector.clearElements();
+        vector.addPoint({2, 2, 0}, "post");
+        vector.commit();
+        auto edited = snapshot();
+        REQUIRE(edited.size() == 1);
+
+        CHECK(vector.undoLabel() == "prune");
+        CHECK(vector.undo());
+        CHECK(snapshot() == original);
+        CHECK(std::get<concord::Point>(vector.getElement(0).geometry).x == 0.0);
+        CHECK(vector.getGlobalProperty("revision").empty());
+        CHECK_FALSE(vector.canUndo());
+        CHECK_FALSE(vector.undo());
+
+        CHECK(vector.redoLabel() == "prune");
+        CHECK(vector.redo());
+        CHECK(snapshot() == edited);
+        CHECK(vector.getGlobalProperty("revision") == "2");
+        CHECK(vector.undo());
+        CHECK(snapshot() == original);
+    }
+
+    SUBCASE("History grows with the edits, not the map") {
+        for (int i = 0; i < 10; ++i) {
+            vector.beginEdit();
+            vector.setElementProperty(i, "height", std::to_string(i));
+            vector.commit();
+        }
+        CHECK(vector.historyBytes() > 0);
+        CHECK(vector.historyBytes() < 10 * 512);
+        CHECK(vector.historyBytes() * 50 < vector.memoryUsage().total());
+
+        vector.setHistoryLimit(vector.historyBytes() / 2);
+        CHECK(vector.canUndo());
+        int steps = 0;
+        while (vector.undo())
+            ++steps;
+        CHECK(steps < 10);
+        CHECK(vector.getElement(9).properties.count("height") == 0);
+        CHECK(vector.getElement(0).properties.at("height") == "0"); // forgotten, so not undone
+    }
+
+    SUBCASE("Rollback, new edits and untracked edits") {
+        vector.beginEdit();
+        vector.removeElement(0);
+        vector.setFieldProperty("crop", "rye");
+        CHECK_THROWS_AS(vector.beginEdit(), std::logic_error);
+        CHECK_THROWS_AS(vector.undo(), std::logic_error);
+        vector.rollback();
+        CHECK(snapshot() == original);
+        CHECK(vector.getFieldProperties().count("crop") == 0);
+        CHECK_FALSE(vector.canUndo());
+        CHECK_THROWS_AS(vector.commit(), std::logic_error);
+
+        vector.beginEdit();
+        vector.removeElement(0);
+        vector.commit();
+        vector.undo();
+        vector.beginEdit();
+        vector.removeElement(1);
+        vector.commit();
+        CHECK_FALSE(vector.canRedo()); // a new edit drops the undone ones
+
+        vector.removeElement(2); // not in an edit: cannot be undone, and invalidates the history
+        CHECK_FALSE(vector.canUndo());
+    }
+
+    SUBCASE("Header edits are undone too") {
+        vector.beginEdit("reframe");
+        vector.setDatum(concord::Datum{52.0, 5.7, 10.0});
+        vector.setHeading(concord::Euler{0, 0, 0.5});
+        vector.setCRS(geoson::CRS::WGS);
+        vector.commit();
+        CHECK(vector.undo());
+        CHECK(vector.getCRS() == geoson::CRS::ENU);
+        CHECK(vector.getHeading().yaw == 0.0);
+        CHECK(vector.redo());
+        CHECK(vector.getCRS() == geoson::CRS::WGS);
+        CHECK(vector.getDatum().lat == 52.0);
+
+        vector.setCRS(geoson::CRS::ENU); // not in an edit: invalidates the history
+        CHECK_FALSE(vector.canUndo());
+    }
+
+    SUBCASE("Assignment drops the history") {
+        vector.beginEdit();
+        vector.removeElement(5);
+        vector.commit();
+        vector.beginEdit();
+        vector.setElementProperty(0, "height", "1");
+        vector.commit();
+        vector.undo();
+        size_t calls = 0;
+        vector.subscribe([&](const geoson::Vector &, std::span<const geoson::ElementChange>) { ++calls; });
+        vector.beginEdit();
+        vector.removeElement(0);
+        REQUIRE(vector.canUndo());
+        REQUIRE(vector.canRedo());
+
+        geoson::Vector other(concord::Polygon{{{0, 0, 0}, {5, 0, 0}, {5, 5, 0}, {0, 0, 0}}});
+        for (int i = 0; i < 10; ++i)
+            other.addPoint({double(i), 1.0, 0.0}, "post");
+        vector = other;
+        CHECK_FALSE(vector.canUndo());
+        CHECK_FALSE(vector.canRedo());
+        CHECK_FALSE(vector.editing());
+        CHECK(vector.historyBytes() == 0);
+        CHECK_FALSE(vector.undo());
+        CHECK(vector.elementCount() == 10);
+        CHECK(calls == 1); // the open edit's batch is closed with it
+    }
+
+    SUBCASE("Observers see one notification per edit, undo and redo") {
+        std::vector<std::vector<geoson::ElementChange>> calls;
+        vector.subscribe([&](const geoson::Vector &, std::span<const geoson::ElementChange> changes) {
+            calls.emplace_back(changes.begin(), changes.end());
+        });
+        uint64_t id3 = vector.elementId(3);
+        vector.beginEdit();
+        vector.setElementGeometry(3, concord::Point{5, 5, 0});
+        vector.removeElement(3);
+        vector.commit();
+        REQUIRE(calls.size() == 1);
+        REQUIRE(calls[0].size() == 1);
+        CHECK(calls[0][0].kind == geoson::ChangeKind::Removed);
+        CHECK(calls[0][0].oldBox.min[0] == 3.0);
+
+        vector.undo();
+        REQUIRE(calls.size() == 2);
+        REQUIRE(calls[1].size() == 1);
+        CHECK(calls[1][0].kind == geoson::ChangeKind::Added);
+        CHECK(calls[1][0].id == id3);
+        CHECK(vector.indexOf(id3) == 3);
+        CHECK(std::get<concord::Point>(vector.getElement(3).geometry).x == 3.0);
+    }
+}
@@ -0,0 +1,129 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "fixtures.hpp"
+#include "geoson/watch.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+TEST_CASE("Watch - applyUpdate") {
+    auto current = fixtures::makeVector(6);
+    auto updated = fixtures::makeVector(6);
+
+    SUBCASE("Identical vectors give an empty diff") { CHECK(geoson::applyUpdate(current, updated).empty()); }
+
+    SUBCASE("Changes, removals and additions") {
+        updated.setElementGeometry(1, concord::Point{11.0, 2.0, 0.0}); // r1 moved
+        updated.removeElement(3);                                       // t3 gone
+        updated.addPoint(concord::Point{70.0, 70.0, 0.0}, "post", {{"id", "p0"}});
+        updated.setGlobalProperty("revision", "2");
+
+        auto diff = geoson::applyUpdate(current, updated);
+        CHECK(diff.removed == std::vector<size_t>{3});
+        CHECK(diff.changed == std::vector<size_t>{1});
+        CHECK(diff.added == std::vector<size_t>{5});
+        CHECK(diff.headerChanged);
+
+        REQUIRE(current.elementCount() == 6);
+        CHECK(std::get<concord::Point>(current.getElement(1).geometry).x == 11.0);
+        CHECK(current.getElement(3).properties.at("id") == "r4");
+        CHECK(current.getElement(5).type == "post");
+        CHECK(current.getGlobalProperty("revision") == "2");
+        CHECK(geoson::applyUpdate(current, updated).empty());
+    }
+
+    SUBCASE("Elements without an id are matched by content") {
+        updated.setElementGeometry(5, concord::Point{51.0, 50.0, 0.0}); // a zone
+        auto diff = geoson::applyUpdate(current, updated);
+        CHECK(diff.removed == std::vector<size_t>{5});
+        CHECK(diff.changed.empty());
+        CHECK(diff.added == std::vector<size_t>{5});
+    }
+}
+
+#if defined(__linux__)
+TEST_CASE("Watch - VectorWatcher reloads on change") {
+    const std::filesystem::path dir = "/tmp/watch_test";
+    std::filesystem::create_directories(dir);
+    const auto file = dir / "field.geojson";
+    auto initial = fixtures::makeVector(6);
+    initial.toFile(file);
+
+    auto loaded = geoson::Vector::fromFile(file);
+    geoson::WatchOptions opts;
+    opts.debounce = std::chrono::milliseconds(50);
+    geoson::VectorWatcher watcher(file, loaded, opts);
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::optional<geoson::VectorDiff> seen;
+    watcher.subscribe([&](geoson::Vector const &, geoson::VectorDiff const &diff) {
+        std::lock_guard lock(m);
+        seen = diff;
+        cv.notify_all();
+    });
+
+    auto edited = fixtures::makeVector(6);
+    edited.setElementProperty(3, "height", "4.5");
+    auto tmp = dir / "field.geojson.tmp";
+    edited.toFile(tmp);
+    std::filesystem::rename(tmp, file); // save by rename, as many editors do
+
+    std::unique_lock lock(m);
+    REQUIRE(cv.wait_for(lock, std::chrono::seconds(10), [&] { return seen.has_value(); }));
+    CHECK(seen->changed == std::vector<size_t>{3});
+    CHECK(seen->removed.empty());
+    CHECK(seen->added.empty());
+    lock.unlock();
+
+    auto guard = watcher.lock();
+    CHECK(loaded.getElement(3).properties.at("height") == "4.5");
+    guard.unlock();
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Watch - a busy sibling file does not postpone the reload") {
+    const std::filesystem::path dir = "/tmp/watch_busy_test";
+    std::filesystem::create_directories(dir);
+    const auto file = dir / "field.geojson";
+    fixtures::makeVector(6).toFile(file);
+
+    auto loaded = geoson::Vector::fromFile(file);
+    geoson::WatchOptions opts;
+    opts.debounce = std::chrono::milliseconds(100);
+    geoson::VectorWatcher watcher(file, loaded, opts);
+
+    std::atomic<bool> stop{false};
+    std::thread logger([&] { // far more often than the debounce, for longer than the wait below
+        for (int i = 0; !stop; ++i) {
+            std::ofstream(dir / "log.txt", std::ios::app) << i << '\n';
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    std::mutex m;
+    std::condition_variable cv;
+    bool reloaded = false;
+    watcher.subscribe([&](geoson::Vector const &, geoson::VectorDiff const &) {
+        std::lock_guard lock(m);
+        reloaded = true;
+        cv.notify_all();
+    });
+
+    auto edited = fixtures::makeVector(6);
+    edited.setElementProperty(0, "height", "2");
+    edited.toFile(file);
+
+    std::unique_lock lock(m);
+    CHECK(cv.wait_for(lock, std::chrono::seconds(5), [&] { return reloaded; }));
+    lock.unlock();
+    stop = true;
+    logger.join();
+
+    std::filesystem::remove_all(dir);
+}
+#endif
@@ -247,3 +247,82 @@ TEST_CASE("Writer - WriteFeatureCollection") {
         CHECK_THROWS_AS(geoson::WriteFeatureCollection(fc, "/invalid/path/file.geojson"), std::runtime_error);
     }
 }
+
+TEST_CASE("Writer - quantized delta compact profile") {
+    concord::Datum datum{52.0, 5.0, 0.0};
+    concord::Euler heading{0.0, 0.0, 0.0};
+
+    std::vector<concord::Point> trail;
+    for (int i = 0; i < 50; ++i)
+        trail.emplace_back(100.0 + i * 1.2345, 200.0 - i * 0.987, 1.0 + 0.01 * i);
+    std::vector<concord::Point> ring = {{0.0, 0.0, 0.0}, {40.3, 0.0, 0.0}, {40.3, 25.7, 0.0}, {0.0, 0.0, 0.0}};
+
+    std::vector<geoson::Feature> features;
+    features.emplace_back(geoson::Feature{concord::Point{12.3456, -7.891, 3.21}, {{"name", "pt"}}});
+    features.emplace_back(geoson::Feature{concord::Path{trail}, {}});
+    features.emplace_back(geoson::Feature{concord::Polygon{ring}, {}});
+    geoson::FeatureCollection fc{datum, heading, std::move(features)};
+    fc.global_properties["owner"] = "wur";
+
+    const std::filesystem::path test_file = "/tmp/test_quantized.geojson";
+
+    auto checkRoundTrip = [&](geoson::FeatureCollection const &back, double tol) {
+        REQUIRE(back.features.size() == 3);
+        auto const &p = std::get<concord::Point>(back.features[0].geometry);
+        CHECK(std::abs(p.x - 12.3456) <= tol);
+        CHECK(std::abs(p.y + 7.891) <= tol);
+        auto const &pts = std::get<concord::Path>(back.features[1].geometry).getPoints();
+        REQUIRE(pts.size() == trail.size());
+        for (size_t i = 0; i < pts.size(); ++i) {
+            CHECK(std::abs(pts[i].x - trail[i].x) <= tol);
+            CHECK(std::abs(pts[i].y - trail[i].y) <= tol);
+            CHECK(std::abs(pts[i].z - trail[i].z) <= tol);
+        }
+        CHECK(std::get<concord::Polygon>(back.features[2].geometry).getPoints().size() == 4);
+        CHECK(back.global_properties.size() == 1);
+        CHECK(back.global_properties.at("owner") == "wur");
+    };
+
+    SUBCASE("ENU round trip within half a quantum") {
+        geoson::WriteOptions opts;
+        opts.quantum = 0.001;
+        opts.pretty = false;
+        geoson::write(fc, test_file, opts);
+
+        std::ifstream ifs(test_file);
+        nlohmann::json json;
+        ifs >> json;
+        CHECK(json["properties"]["transform"]["scale"][0].get<double>() == doctest::Approx(0.001));
+        auto const &coords = json["features"][1]["geometry"]["coordinates"];
+        CHECK(coords[0][0].is_number_integer());
+        CHECK(coords[1][0].get<int64_t>() == 1235); // delta of 1.2345 m at 1 mm
+
+        checkRoundTrip(geoson::read(test_file), 0.0005 + 1e-9);
+    }
+
+    SUBCASE("WGS round trip") {
+        geoson::WriteOptions opts;
+        opts.outputCrs = geoson::CRS::WGS;
+        opts.quantum = 1e-8;  // ~1 mm in latitude
+        opts.quantumZ = 0.001;
+        geoson::write(fc, test_file, opts);
+
+        checkRoundTrip(geoson::read(test_file), 0.002);
+    }
+
+    SUBCASE("Compact profile is smaller than plain output") {
+        geoson::WriteOptions plain;
+        plain.outputCrs = geoson::CRS::WGS;
+        plain.pretty = false;
+        geoson::write(fc, test_file, plain);
+        auto plainSize = std::filesystem::file_size(test_file);
+
+        geoson::WriteOptions compact = plain;
+        compact.quantum = 1e-7;
+        compact.quantumZ = 0.01;
+        geoson::write(fc, test_file, compact);
+        CHECK(std::filesystem::file_size(test_file) * 2 < plainSize);
+    }
+
+    std::filesystem::remove(test_file);
+}
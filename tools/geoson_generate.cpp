@@ -0,0 +1,93 @@
+#include "geoson/generate.hpp"
+#include <iostream>
+#include <sstream>
+
+// geoson_generate: write a reproducible synthetic FeatureCollection
+//
+//   geoson_generate --out=big.geojson --features=5000000 --seed=7 --mix=1,0,3,2 --vertices=8:256
+//                   --properties=6 --property-bytes=24 --crs=WGS --datum=51.98,5.66,12 --extent=20000
+
+namespace {
+    void usage() {
+        std::cerr << "usage: geoson_generate --out=FILE [--features=N] [--seed=N]\n"
+                     "                       [--mix=POINTS,LINES,PATHS,POLYGONS] [--vertices=MIN:MAX]\n"
+                     "                       [--properties=N] [--property-bytes=N] [--crs=ENU|WGS]\n"
+                     "                       [--datum=LAT,LON,ALT] [--extent=METRES] [--quiet]\n";
+    }
+
+    std::vector<double> numbers(std::string const &s, char sep, size_t count, std::string const &flag) {
+        std::vector<double> out;
+        std::stringstream ss(s);
+        std::string item;
+        while (std::getline(ss, item, sep))
+            out.push_back(std::stod(item));
+        if (out.size() != count)
+            throw std::invalid_argument(flag + " expects " + std::to_string(count) + " values");
+        return out;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        geoson::GeneratorOptions opts;
+        std::filesystem::path out;
+        bool quiet = false;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto eq = arg.find('=');
+            std::string flag = arg.substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+            if (flag == "--out")
+                out = value;
+            else if (flag == "--features")
+                opts.features = std::stoull(value);
+            else if (flag == "--seed")
+                opts.seed = std::stoull(value);
+            else if (flag == "--mix") {
+                auto w = numbers(value, ',', 4, flag);
+                opts.mix = {w[0], w[1], w[2], w[3]};
+            } else if (flag == "--vertices") {
+                auto v = numbers(value, ':', 2, flag);
+                opts.minVertices = static_cast<size_t>(v[0]);
+                opts.maxVertices = static_cast<size_t>(v[1]);
+            } else if (flag == "--properties")
+                opts.properties = std::stoull(value);
+            else if (flag == "--property-bytes")
+                opts.propertyBytes = std::stoull(value);
+            else if (flag == "--crs")
+                opts.crs = geoson::parseCRS(value);
+            else if (flag == "--datum") {
+                auto d = numbers(value, ',', 3, flag);
+                opts.datum = concord::Datum{d[0], d[1], d[2]};
+            } else if (flag == "--extent")
+                opts.extent = std::stod(value);
+            else if (flag == "--quiet")
+                quiet = true;
+            else if (flag == "--help" || flag == "-h") {
+                usage();
+                return 0;
+            } else {
+                std::cerr << "unknown argument: " << arg << "\n";
+                usage();
+                return 2;
+            }
+        }
+        if (out.empty()) {
+            usage();
+            return 2;
+        }
+
+        auto bytes = geoson::generate(out, opts, [&](uint64_t written) {
+            if (!quiet)
+                std::cerr << "\r" << written << " / " << opts.features << " features" << std::flush;
+        });
+        if (!quiet)
+            std::cerr << "\n" << out.string() << ": " << bytes << " bytes\n";
+    } catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}